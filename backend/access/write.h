@@ -109,6 +109,15 @@ class RowWriter {
 
   // Write applies the mutation m to the database.
   virtual absl::Status Write(const Mutation& m) = 0;
+
+  // WritePartial applies one part of a statement's mutation to the database.
+  // Statements that are written in several parts must call FinishStatement
+  // once all of their parts have been written, which verifies the constraints
+  // that only need to hold for the statement as a whole.
+  virtual absl::Status WritePartial(const Mutation& m) { return Write(m); }
+
+  // FinishStatement completes a statement written through WritePartial.
+  virtual absl::Status FinishStatement() { return absl::OkStatus(); }
 };
 
 }  // namespace backend
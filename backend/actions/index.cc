@@ -16,6 +16,7 @@
 
 #include "backend/actions/index.h"
 
+#include <algorithm>
 #include <iterator>
 
 #include "zetasql/base/statusor.h"
@@ -59,6 +60,26 @@ IndexEffector::IndexEffector(const Index* index) : index_(index) {
   for (const Column* column : index->index_data_table()->columns()) {
     base_columns_.emplace_back(column->source_column());
   }
+
+  auto is_base_key_column = [index](const Column* column) {
+    for (const KeyColumn* key_column : index->indexed_table()->primary_key()) {
+      if (key_column->column() == column) {
+        return true;
+      }
+    }
+    return false;
+  };
+  for (const KeyColumn* key_column : index->key_columns()) {
+    const Column* column = key_column->column()->source_column();
+    if (!is_base_key_column(column)) {
+      updatable_columns_.push_back(column);
+    }
+  }
+  for (const Column* column : index->stored_columns()) {
+    if (!is_base_key_column(column->source_column())) {
+      updatable_columns_.push_back(column->source_column());
+    }
+  }
 }
 
 absl::Status IndexEffector::Effect(const ActionContext* ctx,
@@ -79,6 +100,18 @@ absl::Status IndexEffector::Effect(const ActionContext* ctx,
 
 absl::Status IndexEffector::Effect(const ActionContext* ctx,
                                    const UpdateOp& op) const {
+  // Updates which do not write any indexed or stored column leave the index
+  // entry as is. The primary key columns written by every update are not
+  // considered, since updates never change them.
+  if (std::none_of(op.columns.begin(), op.columns.end(),
+                   [this](const Column* column) {
+                     return std::find(updatable_columns_.begin(),
+                                      updatable_columns_.end(),
+                                      column) != updatable_columns_.end();
+                   })) {
+    return absl::OkStatus();
+  }
+
   // Read the current base row values from the indexed table.
   ZETASQL_ASSIGN_OR_RETURN(Row base_row,
                    ReadBaseTableRow(ctx, op.table, op.key, base_columns_));
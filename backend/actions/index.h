@@ -56,6 +56,11 @@ class IndexEffector : public Effector {
 
   // List of indexed table columns relevant to the index.
   std::vector<const Column*> base_columns_;
+
+  // Indexed table columns whose updates change the index entry: the source
+  // columns of the index key and stored columns, other than the primary key
+  // columns of the indexed table, which updates never change.
+  std::vector<const Column*> updatable_columns_;
 };
 
 }  // namespace backend
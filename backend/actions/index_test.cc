@@ -18,6 +18,7 @@
 
 #include <memory>
 #include <queue>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -50,7 +51,8 @@ class IndexTest : public test::ActionsTest {
                             CREATE TABLE TestTable (
                               int64_col INT64 NOT NULL,
                               string_col STRING(MAX),
-                              another_string_col STRING(MAX)
+                              another_string_col STRING(MAX),
+                              unindexed_col INT64
                             ) PRIMARY KEY (int64_col)
                           )",
                         R"(
@@ -61,7 +63,9 @@ class IndexTest : public test::ActionsTest {
                     &type_factory_)
                     .value()),
         table_(schema_->FindTable("TestTable")),
-        base_columns_(table_->columns()),
+        base_columns_({table_->FindColumn("int64_col"),
+                       table_->FindColumn("string_col"),
+                       table_->FindColumn("another_string_col")}),
         index_(schema_->FindIndex("TestIndex")),
         index_columns_(index_->index_data_table()->columns()),
         effector_(absl::make_unique<IndexEffector>(index_)) {}
@@ -73,7 +77,7 @@ class IndexTest : public test::ActionsTest {
 
   // Test variables.
   const Table* table_;
-  absl::Span<const Column* const> base_columns_;
+  std::vector<const Column*> base_columns_;
   const Index* index_;
   absl::Span<const Column* const> index_columns_;
   std::unique_ptr<Effector> effector_;
@@ -196,6 +200,25 @@ TEST_F(IndexTest, UpdateCascadesToIndexEntry) {
                            {String("new-value"), Int64(1), String("value2")}}));
 }
 
+TEST_F(IndexTest, UpdateOfUnindexedColumnDoesNotCascadeToIndexEntry) {
+  // Add row in base table & index.
+  ZETASQL_EXPECT_OK(store()->Insert(table_, Key({Int64(1)}), base_columns_,
+                            {Int64(1), String("value"), String("value2")}));
+  ZETASQL_EXPECT_OK(store()->Insert(index_->index_data_table(),
+                            Key({String("value"), Int64(1)}), index_columns_,
+                            {Int64(1), String("value"), String("value2")}));
+
+  // Update base table entry, writing the key columns as mutations do.
+  ZETASQL_EXPECT_OK(effector_->Effect(
+      ctx(), Update(table_, Key({Int64(1)}),
+                    {table_->FindColumn("int64_col"),
+                     table_->FindColumn("unindexed_col")},
+                    {Int64(1), Int64(2)})));
+
+  // Verify the index entry is left as is.
+  ASSERT_EQ(effects_buffer()->ops_queue()->size(), 0);
+}
+
 }  // namespace
 }  // namespace backend
 }  // namespace emulator
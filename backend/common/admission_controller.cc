@@ -0,0 +1,115 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/common/admission_controller.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "common/errors.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+bool AdmissionController::HasCapacity() const {
+  return options_.max_in_flight <= 0 ||
+         stats_.in_flight < options_.max_in_flight;
+}
+
+absl::Status AdmissionController::Acquire() {
+  absl::MutexLock lock(&mu_);
+
+  // Admit immediately if there is spare capacity and nobody is waiting ahead
+  // of this request.
+  if (stats_.queued == 0 && HasCapacity()) {
+    ++stats_.in_flight;
+    ++stats_.admitted;
+    return absl::OkStatus();
+  }
+
+  if (stats_.queued >= options_.max_queued) {
+    ++stats_.rejected;
+    return error::TooManyConcurrentRequests(resource_);
+  }
+
+  ++stats_.queued;
+  stats_.peak_queued = std::max(stats_.peak_queued, stats_.queued);
+  absl::Time enqueue_time = absl::Now();
+  bool admitted = mu_.AwaitWithTimeout(
+      absl::Condition(this, &AdmissionController::HasCapacity),
+      options_.max_queue_time);
+  --stats_.queued;
+
+  if (!admitted) {
+    ++stats_.rejected;
+    return error::RequestQueueTimeout(resource_);
+  }
+  ++stats_.in_flight;
+  ++stats_.admitted;
+  stats_.total_queue_time += absl::Now() - enqueue_time;
+  return absl::OkStatus();
+}
+
+void AdmissionController::Release() {
+  absl::MutexLock lock(&mu_);
+  --stats_.in_flight;
+}
+
+AdmissionStats AdmissionController::stats() const {
+  absl::MutexLock lock(&mu_);
+  return stats_;
+}
+
+AdmissionTicket::~AdmissionTicket() { ReleaseAll(); }
+
+AdmissionTicket::AdmissionTicket(AdmissionTicket&& other)
+    : controllers_(std::move(other.controllers_)) {
+  other.controllers_.clear();
+}
+
+AdmissionTicket& AdmissionTicket::operator=(AdmissionTicket&& other) {
+  if (this != &other) {
+    ReleaseAll();
+    controllers_ = std::move(other.controllers_);
+    other.controllers_.clear();
+  }
+  return *this;
+}
+
+absl::Status AdmissionTicket::Acquire(AdmissionController* controller) {
+  ZETASQL_RETURN_IF_ERROR(controller->Acquire());
+  controllers_.push_back(controller);
+  return absl::OkStatus();
+}
+
+void AdmissionTicket::ReleaseAll() {
+  for (auto itr = controllers_.rbegin(); itr != controllers_.rend(); ++itr) {
+    (*itr)->Release();
+  }
+  controllers_.clear();
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,137 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_COMMON_ADMISSION_CONTROLLER_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_COMMON_ADMISSION_CONTROLLER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// Counters describing the load seen by an AdmissionController.
+struct AdmissionStats {
+  // Number of requests currently executing.
+  int64_t in_flight = 0;
+
+  // Number of requests currently waiting to execute.
+  int64_t queued = 0;
+
+  // Highest number of requests waiting to execute at any point in time.
+  int64_t peak_queued = 0;
+
+  // Total number of requests admitted.
+  int64_t admitted = 0;
+
+  // Total number of requests rejected because the queue was full or because
+  // they waited too long.
+  int64_t rejected = 0;
+
+  // Total time spent by admitted requests waiting in the queue.
+  absl::Duration total_queue_time = absl::ZeroDuration();
+};
+
+// AdmissionController bounds the number of requests concurrently executing
+// against a resource (e.g. a database or a session).
+//
+// Up to `max_in_flight` requests execute concurrently. Further requests wait in
+// a queue of up to `max_queued` requests for at most `max_queue_time`. Requests
+// arriving to a full queue are rejected immediately with RESOURCE_EXHAUSTED,
+// and requests which waited for too long are rejected with UNAVAILABLE, so that
+// the emulator sheds load instead of piling up blocked RPCs.
+//
+// This class is thread-safe.
+class AdmissionController {
+ public:
+  struct Options {
+    // Maximum number of concurrently executing requests. Zero means unlimited.
+    int64_t max_in_flight = 0;
+
+    // Maximum number of requests waiting to execute.
+    int64_t max_queued = 0;
+
+    // Maximum time a request waits to execute.
+    absl::Duration max_queue_time = absl::InfiniteDuration();
+  };
+
+  AdmissionController(absl::string_view resource, const Options& options)
+      : resource_(resource), options_(options) {}
+
+  // Blocks until the request can execute. Returns an error if the request is
+  // rejected, in which case Release() must not be called.
+  absl::Status Acquire() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Marks a previously admitted request as done.
+  void Release() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the description of the resource protected by this controller.
+  const std::string& name() const { return resource_; }
+
+  // Returns the current counters of this controller.
+  AdmissionStats stats() const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // Returns true if another request can start executing.
+  bool HasCapacity() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Description of the resource protected by this controller.
+  const std::string resource_;
+
+  // Limits enforced by this controller.
+  const Options options_;
+
+  mutable absl::Mutex mu_;
+  AdmissionStats stats_ ABSL_GUARDED_BY(mu_);
+};
+
+// AdmissionTicket releases the admission controllers held by a request when it
+// goes out of scope.
+class AdmissionTicket {
+ public:
+  AdmissionTicket() = default;
+  ~AdmissionTicket();
+
+  AdmissionTicket(AdmissionTicket&& other);
+  AdmissionTicket& operator=(AdmissionTicket&& other);
+  AdmissionTicket(const AdmissionTicket&) = delete;
+  AdmissionTicket& operator=(const AdmissionTicket&) = delete;
+
+  // Acquires `controller` and, if admitted, holds it until this ticket is
+  // destroyed. Controllers are released in the reverse order of acquisition.
+  absl::Status Acquire(AdmissionController* controller);
+
+ private:
+  void ReleaseAll();
+
+  std::vector<AdmissionController*> controllers_;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_COMMON_ADMISSION_CONTROLLER_H_
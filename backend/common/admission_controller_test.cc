@@ -0,0 +1,109 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/common/admission_controller.h"
+
+#include <thread>  // NOLINT
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "tests/common/proto_matchers.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using zetasql_base::testing::StatusIs;
+
+TEST(AdmissionControllerTest, UnlimitedControllerAdmitsEverything) {
+  AdmissionController controller("database", {});
+  for (int i = 0; i < 10; ++i) {
+    ZETASQL_EXPECT_OK(controller.Acquire());
+  }
+  EXPECT_EQ(controller.stats().in_flight, 10);
+  EXPECT_EQ(controller.stats().admitted, 10);
+}
+
+TEST(AdmissionControllerTest, RejectsWhenQueueIsFull) {
+  AdmissionController controller("database",
+                                 {.max_in_flight = 1, .max_queued = 0});
+  ZETASQL_EXPECT_OK(controller.Acquire());
+  EXPECT_THAT(controller.Acquire(),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+  EXPECT_EQ(controller.stats().rejected, 1);
+
+  controller.Release();
+  ZETASQL_EXPECT_OK(controller.Acquire());
+}
+
+TEST(AdmissionControllerTest, RejectsAfterQueueTimeout) {
+  AdmissionController controller(
+      "database", {.max_in_flight = 1,
+                   .max_queued = 1,
+                   .max_queue_time = absl::Milliseconds(10)});
+  ZETASQL_EXPECT_OK(controller.Acquire());
+  EXPECT_THAT(controller.Acquire(), StatusIs(absl::StatusCode::kUnavailable));
+  EXPECT_EQ(controller.stats().queued, 0);
+  EXPECT_EQ(controller.stats().peak_queued, 1);
+}
+
+TEST(AdmissionControllerTest, QueuedRequestIsAdmittedOnRelease) {
+  AdmissionController controller("database",
+                                 {.max_in_flight = 1, .max_queued = 1});
+  ZETASQL_EXPECT_OK(controller.Acquire());
+
+  absl::Notification admitted;
+  std::thread waiter([&] {
+    ZETASQL_EXPECT_OK(controller.Acquire());
+    admitted.Notify();
+  });
+  EXPECT_FALSE(admitted.WaitForNotificationWithTimeout(absl::Milliseconds(10)));
+
+  controller.Release();
+  admitted.WaitForNotification();
+  waiter.join();
+  EXPECT_EQ(controller.stats().in_flight, 1);
+  EXPECT_EQ(controller.stats().admitted, 2);
+}
+
+TEST(AdmissionTicketTest, ReleasesControllersOnDestruction) {
+  AdmissionController database("database", {.max_in_flight = 1});
+  AdmissionController session("session", {.max_in_flight = 1});
+  {
+    AdmissionTicket ticket;
+    ZETASQL_EXPECT_OK(ticket.Acquire(&session));
+    ZETASQL_EXPECT_OK(ticket.Acquire(&database));
+    EXPECT_EQ(database.stats().in_flight, 1);
+    EXPECT_EQ(session.stats().in_flight, 1);
+
+    AdmissionTicket moved = std::move(ticket);
+    EXPECT_EQ(database.stats().in_flight, 1);
+  }
+  EXPECT_EQ(database.stats().in_flight, 0);
+  EXPECT_EQ(session.stats().in_flight, 0);
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
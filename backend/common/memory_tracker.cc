@@ -0,0 +1,137 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/common/memory_tracker.h"
+
+#include <algorithm>
+
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "common/errors.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+int64_t EstimateSizeInBytes(const zetasql::Value& value) {
+  if (!value.is_valid()) {
+    return 0;
+  }
+  if (value.is_null()) {
+    return 1;
+  }
+  switch (value.type_kind()) {
+    case zetasql::TYPE_BOOL:
+      return 1;
+    case zetasql::TYPE_DATE:
+      return 4;
+    case zetasql::TYPE_INT64:
+    case zetasql::TYPE_DOUBLE:
+      return 8;
+    case zetasql::TYPE_TIMESTAMP:
+      return 12;
+    case zetasql::TYPE_NUMERIC:
+      return 16;
+    case zetasql::TYPE_STRING:
+      return value.string_value().size();
+    case zetasql::TYPE_BYTES:
+      return value.bytes_value().size();
+    case zetasql::TYPE_ARRAY: {
+      int64_t size = 0;
+      for (const zetasql::Value& element : value.elements()) {
+        size += EstimateSizeInBytes(element);
+      }
+      return size;
+    }
+    case zetasql::TYPE_STRUCT: {
+      int64_t size = 0;
+      for (const zetasql::Value& field : value.fields()) {
+        size += EstimateSizeInBytes(field);
+      }
+      return size;
+    }
+    default:
+      return 8;
+  }
+}
+
+int64_t EstimateSizeInBytes(const Key& key,
+                            const std::vector<zetasql::Value>& values) {
+  int64_t size = key.LogicalSizeInBytes();
+  for (const zetasql::Value& value : values) {
+    size += EstimateSizeInBytes(value);
+  }
+  return size;
+}
+
+MemoryTracker::MemoryTracker(absl::string_view name, int64_t limit_bytes,
+                             MemoryTracker* parent)
+    : name_(name), limit_bytes_(limit_bytes), parent_(parent) {}
+
+MemoryTracker::~MemoryTracker() {
+  if (parent_ != nullptr) {
+    parent_->Release(bytes_used());
+  }
+}
+
+absl::Status MemoryTracker::TryAllocate(int64_t bytes) {
+  absl::MutexLock lock(&mu_);
+  if (limit_bytes_ > 0 && bytes_used_ + bytes > limit_bytes_) {
+    return error::MemoryLimitExceeded(name_, limit_bytes_);
+  }
+  if (parent_ != nullptr) {
+    ZETASQL_RETURN_IF_ERROR(parent_->TryAllocate(bytes));
+  }
+  bytes_used_ += bytes;
+  peak_bytes_used_ = std::max(peak_bytes_used_, bytes_used_);
+  return absl::OkStatus();
+}
+
+void MemoryTracker::Allocate(int64_t bytes) {
+  absl::MutexLock lock(&mu_);
+  if (parent_ != nullptr) {
+    parent_->Allocate(bytes);
+  }
+  bytes_used_ += bytes;
+  peak_bytes_used_ = std::max(peak_bytes_used_, bytes_used_);
+}
+
+void MemoryTracker::Release(int64_t bytes) {
+  absl::MutexLock lock(&mu_);
+  if (parent_ != nullptr) {
+    parent_->Release(bytes);
+  }
+  bytes_used_ -= bytes;
+}
+
+int64_t MemoryTracker::bytes_used() const {
+  absl::MutexLock lock(&mu_);
+  return bytes_used_;
+}
+
+int64_t MemoryTracker::peak_bytes_used() const {
+  absl::MutexLock lock(&mu_);
+  return peak_bytes_used_;
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,102 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_COMMON_MEMORY_TRACKER_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_COMMON_MEMORY_TRACKER_H_
+
+#include <cstdint>
+#include <string>
+
+#include "zetasql/public/value.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "backend/datamodel/key.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// Returns an estimate of the number of bytes used to hold `value`.
+int64_t EstimateSizeInBytes(const zetasql::Value& value);
+
+// Returns an estimate of the number of bytes used to hold a row with the given
+// key and column values.
+int64_t EstimateSizeInBytes(const Key& key,
+                            const std::vector<zetasql::Value>& values);
+
+// MemoryTracker accounts the bytes held by an emulator resource (a database, a
+// transaction, a query) and optionally enforces a limit on them.
+//
+// Trackers form a hierarchy: bytes accounted by a tracker are also accounted by
+// its parent, so that e.g. the bytes buffered by a transaction count towards
+// the limit of the database it belongs to. Any bytes still accounted by a
+// tracker are released from its parent when it is destroyed.
+//
+// This class is thread-safe.
+class MemoryTracker {
+ public:
+  // Creates a tracker for the resource described by `name`. A `limit_bytes` of
+  // zero means that the tracker does not enforce a limit.
+  MemoryTracker(absl::string_view name, int64_t limit_bytes,
+                MemoryTracker* parent = nullptr);
+  ~MemoryTracker();
+
+  MemoryTracker(const MemoryTracker&) = delete;
+  MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+  // Accounts `bytes` if doing so keeps this tracker and all its ancestors
+  // within their limits. Returns RESOURCE_EXHAUSTED otherwise, in which case
+  // nothing is accounted.
+  absl::Status TryAllocate(int64_t bytes) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Accounts `bytes` regardless of limits. Used for allocations which cannot
+  // be failed, e.g. flushing an already committed transaction to storage.
+  void Allocate(int64_t bytes) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Releases `bytes` previously accounted by this tracker.
+  void Release(int64_t bytes) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of bytes currently accounted.
+  int64_t bytes_used() const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the highest number of bytes accounted at any point in time.
+  int64_t peak_bytes_used() const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the limit enforced by this tracker, zero if unlimited.
+  int64_t limit_bytes() const { return limit_bytes_; }
+
+  // Returns the name of the resource tracked by this tracker.
+  const std::string& name() const { return name_; }
+
+ private:
+  const std::string name_;
+  const int64_t limit_bytes_;
+  MemoryTracker* parent_;
+
+  mutable absl::Mutex mu_;
+  int64_t bytes_used_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t peak_bytes_used_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_COMMON_MEMORY_TRACKER_H_
@@ -0,0 +1,92 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/common/memory_tracker.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "tests/common/proto_matchers.h"
+#include "absl/status/status.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using zetasql::values::Int64;
+using zetasql::values::Int64Array;
+using zetasql::values::NullString;
+using zetasql::values::String;
+using zetasql_base::testing::StatusIs;
+
+TEST(EstimateSizeInBytesTest, EstimatesScalarValues) {
+  EXPECT_EQ(EstimateSizeInBytes(Int64(1)), 8);
+  EXPECT_EQ(EstimateSizeInBytes(String("abcd")), 4);
+  EXPECT_EQ(EstimateSizeInBytes(NullString()), 1);
+  EXPECT_EQ(EstimateSizeInBytes(zetasql::Value()), 0);
+}
+
+TEST(EstimateSizeInBytesTest, EstimatesArraysAndRows) {
+  EXPECT_EQ(EstimateSizeInBytes(Int64Array({1, 2})), 16);
+  EXPECT_EQ(EstimateSizeInBytes(Key({Int64(1)}), {String("abcd"), Int64(2)}),
+            20);
+}
+
+TEST(MemoryTrackerTest, TracksUsageAndPeak) {
+  MemoryTracker tracker("database", /*limit_bytes=*/0);
+
+  ZETASQL_EXPECT_OK(tracker.TryAllocate(100));
+  tracker.Allocate(50);
+  EXPECT_EQ(tracker.bytes_used(), 150);
+
+  tracker.Release(120);
+  EXPECT_EQ(tracker.bytes_used(), 30);
+  EXPECT_EQ(tracker.peak_bytes_used(), 150);
+}
+
+TEST(MemoryTrackerTest, EnforcesLimit) {
+  MemoryTracker tracker("database", /*limit_bytes=*/100);
+
+  ZETASQL_EXPECT_OK(tracker.TryAllocate(60));
+  EXPECT_THAT(tracker.TryAllocate(60),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+  EXPECT_EQ(tracker.bytes_used(), 60);
+  ZETASQL_EXPECT_OK(tracker.TryAllocate(40));
+}
+
+TEST(MemoryTrackerTest, ChildAllocationsCountTowardsParentLimit) {
+  MemoryTracker database("database", /*limit_bytes=*/100);
+  {
+    MemoryTracker transaction("transaction", /*limit_bytes=*/0, &database);
+    ZETASQL_EXPECT_OK(transaction.TryAllocate(80));
+    EXPECT_EQ(database.bytes_used(), 80);
+
+    EXPECT_THAT(transaction.TryAllocate(40),
+                StatusIs(absl::StatusCode::kResourceExhausted));
+    EXPECT_EQ(transaction.bytes_used(), 80);
+  }
+
+  // Destroying the child releases its bytes from the parent.
+  EXPECT_EQ(database.bytes_used(), 0);
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
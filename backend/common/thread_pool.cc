@@ -0,0 +1,135 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/common/thread_pool.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+ThreadPool::~ThreadPool() {
+  std::vector<std::thread> threads;
+  {
+    absl::MutexLock lock(&mu_);
+    stopping_ = true;
+    threads = std::move(threads_);
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+void ThreadPool::Schedule(std::function<void()> task) {
+  if (num_threads_ == 0) {
+    task();
+    return;
+  }
+  absl::MutexLock lock(&mu_);
+  if (threads_.empty()) {
+    threads_.reserve(num_threads_);
+    for (int i = 0; i < num_threads_; ++i) {
+      threads_.emplace_back([this]() { WorkLoop(); });
+    }
+  }
+  tasks_.push_back(std::move(task));
+}
+
+void ThreadPool::WorkLoop() {
+  auto has_work = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return stopping_ || !tasks_.empty();
+  };
+  while (true) {
+    std::function<void()> task;
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(&has_work));
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+namespace {
+
+// Calls of a ParallelFor, claimed in order by the threads running it. Shared
+// with the worker tasks, which may only start once all calls were claimed and
+// the ParallelFor returned, in which case they return without using `fn`.
+struct ParallelForCalls {
+  ParallelForCalls(int64_t n, const std::function<void(int64_t)>* fn)
+      : n(n), fn(fn) {}
+
+  // Makes calls until all are claimed.
+  void Run() {
+    while (true) {
+      int64_t i;
+      {
+        absl::MutexLock lock(&mu);
+        if (next == n) {
+          return;
+        }
+        i = next++;
+      }
+      (*fn)(i);
+      absl::MutexLock lock(&mu);
+      ++num_done;
+    }
+  }
+
+  const int64_t n;
+  const std::function<void(int64_t)>* fn;
+
+  absl::Mutex mu;
+  int64_t next ABSL_GUARDED_BY(mu) = 0;
+  int64_t num_done ABSL_GUARDED_BY(mu) = 0;
+};
+
+}  // namespace
+
+void ThreadPool::ParallelFor(int64_t n,
+                             const std::function<void(int64_t)>& fn) {
+  auto calls = std::make_shared<ParallelForCalls>(n, &fn);
+  const int64_t num_helpers = std::min<int64_t>(num_threads_, n - 1);
+  for (int64_t i = 0; i < num_helpers; ++i) {
+    Schedule([calls]() { calls->Run(); });
+  }
+  calls->Run();
+
+  absl::MutexLock lock(&calls->mu);
+  auto all_done = [&calls]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(calls->mu) {
+    return calls->num_done == calls->n;
+  };
+  calls->mu.Await(absl::Condition(&all_done));
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,80 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_COMMON_THREAD_POOL_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_COMMON_THREAD_POOL_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// ThreadPool runs tasks on a fixed number of worker threads, which are started
+// when the first task is scheduled so that idle pools hold no threads.
+//
+// Tasks still queued when the pool is destroyed are run before its threads are
+// joined.
+//
+// This class is thread-safe.
+class ThreadPool {
+ public:
+  explicit ThreadPool(int num_threads) : num_threads_(num_threads) {}
+  ~ThreadPool() ABSL_LOCKS_EXCLUDED(mu_);
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Returns the number of worker threads of the pool.
+  int num_threads() const { return num_threads_; }
+
+  // Queues `task` to run on a worker thread. Runs it on the calling thread if
+  // the pool has no threads.
+  void Schedule(std::function<void()> task) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Calls `fn` for each of [0, `n`), and returns once all calls returned. The
+  // calls are made in order by the calling thread and by up to `n` - 1 worker
+  // threads as they become available, so that the caller never waits for the
+  // pool to finish the tasks of others before making progress.
+  void ParallelFor(int64_t n, const std::function<void(int64_t)>& fn)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // Runs queued tasks until the pool is destroyed.
+  void WorkLoop() ABSL_LOCKS_EXCLUDED(mu_);
+
+  const int num_threads_;
+
+  absl::Mutex mu_;
+  std::deque<std::function<void()>> tasks_ ABSL_GUARDED_BY(mu_);
+  std::vector<std::thread> threads_ ABSL_GUARDED_BY(mu_);
+  bool stopping_ ABSL_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_COMMON_THREAD_POOL_H_
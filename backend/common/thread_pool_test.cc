@@ -0,0 +1,111 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/common/thread_pool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/synchronization/notification.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+TEST(ThreadPoolTest, RunsScheduledTasks) {
+  absl::Notification done;
+  {
+    ThreadPool pool(/*num_threads=*/2);
+    pool.Schedule([&done]() { done.Notify(); });
+    done.WaitForNotification();
+  }
+  EXPECT_TRUE(done.HasBeenNotified());
+}
+
+TEST(ThreadPoolTest, RunsQueuedTasksBeforeDestruction) {
+  std::atomic<int> num_run = 0;
+  {
+    ThreadPool pool(/*num_threads=*/1);
+    for (int i = 0; i < 100; ++i) {
+      pool.Schedule([&num_run]() { ++num_run; });
+    }
+  }
+  EXPECT_EQ(num_run, 100);
+}
+
+TEST(ThreadPoolTest, PoolWithoutThreadsRunsTasksOnCallingThread) {
+  ThreadPool pool(/*num_threads=*/0);
+  std::thread::id task_thread_id;
+  pool.Schedule([&task_thread_id]() {
+    task_thread_id = std::this_thread::get_id();
+  });
+  EXPECT_EQ(task_thread_id, std::this_thread::get_id());
+}
+
+TEST(ThreadPoolTest, ParallelForMakesEachCallOnce) {
+  ThreadPool pool(/*num_threads=*/4);
+  std::vector<std::atomic<int>> num_calls(1000);
+  pool.ParallelFor(num_calls.size(),
+                   [&num_calls](int64_t i) { ++num_calls[i]; });
+  for (const std::atomic<int>& n : num_calls) {
+    EXPECT_EQ(n, 1);
+  }
+}
+
+TEST(ThreadPoolTest, ParallelForWithoutCalls) {
+  ThreadPool pool(/*num_threads=*/4);
+  pool.ParallelFor(0, [](int64_t i) { FAIL() << "Unexpected call " << i; });
+}
+
+TEST(ThreadPoolTest, ParallelForProgressesWhileThePoolIsBusy) {
+  ThreadPool pool(/*num_threads=*/1);
+  absl::Notification release_worker;
+  pool.Schedule([&release_worker]() { release_worker.WaitForNotification(); });
+
+  // The only worker thread is blocked, so the calls are all made by the
+  // calling thread.
+  int num_calls = 0;
+  pool.ParallelFor(10, [&num_calls](int64_t) { ++num_calls; });
+  EXPECT_EQ(num_calls, 10);
+  release_worker.Notify();
+}
+
+TEST(ThreadPoolTest, ConcurrentParallelForsShareThePool) {
+  ThreadPool pool(/*num_threads=*/2);
+  std::atomic<int64_t> sum = 0;
+  std::vector<std::thread> callers;
+  for (int i = 0; i < 8; ++i) {
+    callers.emplace_back([&pool, &sum]() {
+      pool.ParallelFor(100, [&sum](int64_t i) { sum += i; });
+    });
+  }
+  for (std::thread& caller : callers) {
+    caller.join();
+  }
+  EXPECT_EQ(sum, 8 * 4950);
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -16,8 +16,11 @@
 
 #include "backend/database/database.h"
 
+#include <algorithm>
+#include <iterator>
 #include <memory>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "zetasql/base/statusor.h"
 #include "absl/strings/match.h"
@@ -28,9 +31,14 @@
 #include "absl/types/variant.h"
 #include "backend/actions/manager.h"
 #include "backend/common/ids.h"
+#include "backend/common/rows.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
 #include "backend/locking/manager.h"
 #include "backend/locking/request.h"
 #include "backend/query/query_engine.h"
+#include "backend/schema/catalog/column.h"
+#include "backend/schema/catalog/index.h"
 #include "backend/schema/catalog/versioned_catalog.h"
 #include "backend/schema/printer/print_ddl.h"
 #include "backend/schema/updater/schema_updater.h"
@@ -38,7 +46,9 @@
 #include "backend/storage/in_memory_storage.h"
 #include "backend/transaction/actions.h"
 #include "backend/transaction/options.h"
+#include "common/config.h"
 #include "absl/status/status.h"
+#include "zetasql/base/ret_check.h"
 #include "zetasql/base/status_macros.h"
 
 namespace google {
@@ -48,17 +58,32 @@ namespace backend {
 
 // TransactionIDGenerator is initialized to 1 because 0 is used as a sentinel
 // value for an invalid transaction.
-Database::Database() : transaction_id_generator_(1) {}
+Database::Database()
+    : memory_tracker_("database", config::max_database_memory_bytes()),
+      admission_controller_(
+          "database",
+          {.max_in_flight = config::max_concurrent_requests_per_database(),
+           .max_queued = config::max_queued_requests(),
+           .max_queue_time = config::max_request_queue_time()}),
+      change_log_(config::change_log_capacity()),
+      transaction_id_generator_(1) {}
 
 zetasql_base::StatusOr<std::unique_ptr<Database>> Database::Create(
     Clock* clock, const std::vector<std::string>& create_statements) {
   auto database = absl::WrapUnique(new Database());
   database->clock_ = clock;
-  database->storage_ = absl::make_unique<InMemoryStorage>();
+  database->storage_ = absl::make_unique<InMemoryStorage>(
+      &database->memory_tracker_, config::read_parallelism(),
+      config::enable_prefix_filters(), config::interleave_storage_tables(),
+      config::max_rows_per_storage_split());
   database->lock_manager_ = absl::make_unique<LockManager>(clock);
   database->type_factory_ = absl::make_unique<zetasql::TypeFactory>();
   database->query_engine_ =
-      absl::make_unique<QueryEngine>(database->type_factory_.get());
+      absl::make_unique<QueryEngine>(database->type_factory_.get(),
+                                     &database->memory_tracker_,
+                                     config::query_result_cache_bytes(),
+                                     database->storage_.get(),
+                                     &database->admission_controller_);
   database->action_manager_ = absl::make_unique<ActionManager>();
 
   if (create_statements.empty()) {
@@ -72,6 +97,8 @@ zetasql_base::StatusOr<std::unique_ptr<Database>> Database::Create(
     database->versioned_catalog_ =
         absl::make_unique<VersionedCatalog>(std::move(schema));
   }
+  ZETASQL_RETURN_IF_ERROR(database->InterleaveStorageTables(
+      database->versioned_catalog_->GetLatestSchema()));
 
   database->action_manager_->AddActionsForSchema(
       database->versioned_catalog_->GetLatestSchema());
@@ -92,7 +119,7 @@ Database::CreateReadWriteTransaction(const ReadWriteOptions& options,
   return absl::make_unique<ReadWriteTransaction>(
       options, retry_state, transaction_id_generator_.NextId(), clock_,
       storage_.get(), lock_manager_.get(), versioned_catalog_.get(),
-      action_manager_.get());
+      action_manager_.get(), &memory_tracker_, &change_log_);
 }
 
 SchemaChangeContext Database::GetSchemaChangeContext() {
@@ -139,16 +166,129 @@ absl::Status Database::UpdateSchema(absl::Span<const std::string> statements,
   if (result.updated_schema != nullptr) {
     ZETASQL_RETURN_IF_ERROR(versioned_catalog_->AddSchema(
         update_timestamp, std::move(result.updated_schema)));
+    ZETASQL_RETURN_IF_ERROR(DropStorageTables(existing_schema,
+                                      versioned_catalog_->GetLatestSchema()));
+    ZETASQL_RETURN_IF_ERROR(
+        InterleaveStorageTables(versioned_catalog_->GetLatestSchema()));
     action_manager_->AddActionsForSchema(versioned_catalog_->GetLatestSchema());
   }
   return absl::OkStatus();
 }
 
+absl::Status Database::InterleaveStorageTables(const Schema* schema) {
+  // Tables are listed after their parents, so that the interleaving of a
+  // parent is known to storage before the one of its children.
+  for (const Table* table : schema->tables()) {
+    if (table->parent() != nullptr) {
+      ZETASQL_RETURN_IF_ERROR(storage_->InterleaveTable(
+          table->id(), table->parent()->id(),
+          table->parent()->primary_key().size()));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status Database::DropStorageTables(const Schema* old_schema,
+                                         const Schema* new_schema) {
+  absl::flat_hash_set<TableID> table_ids;
+  for (const Table* table : new_schema->tables()) {
+    table_ids.insert(table->id());
+    for (const Index* index : table->indexes()) {
+      table_ids.insert(index->index_data_table()->id());
+    }
+  }
+
+  // Tables are listed after their parents, so visiting them in reverse order
+  // drops interleaved tables and indexes before the tables they are in.
+  absl::Span<const Table* const> old_tables = old_schema->tables();
+  for (auto itr = old_tables.rbegin(); itr != old_tables.rend(); ++itr) {
+    for (const Index* index : (*itr)->indexes()) {
+      const TableID& index_table_id = index->index_data_table()->id();
+      if (!table_ids.contains(index_table_id)) {
+        ZETASQL_RETURN_IF_ERROR(storage_->DropTable(index_table_id));
+      }
+    }
+    if (!table_ids.contains((*itr)->id())) {
+      ZETASQL_RETURN_IF_ERROR(storage_->DropTable((*itr)->id()));
+    }
+  }
+  return absl::OkStatus();
+}
+
 std::vector<std::string> Database::GetSchema() {
   const Schema* schema = versioned_catalog_->GetLatestSchema();
   return PrintDDLStatements(schema);
 }
 
+const Schema* Database::GetLatestSchema() const {
+  return versioned_catalog_->GetLatestSchema();
+}
+
+absl::Status Database::ExportTables(
+    const std::function<absl::Status(const Table*, StorageIterator*)>& fn) {
+  // Pick a strong read timestamp and wait for any in-progress commit to finish
+  // before reading from storage.
+  absl::Time read_timestamp = clock_->Now();
+  std::unique_ptr<LockHandle> lock_handle = lock_manager_->CreateHandle(
+      transaction_id_generator_.NextId(), TransactionPriority(1));
+  lock_handle->WaitForSafeRead(read_timestamp);
+
+  auto export_table = [&](const Table* table) -> absl::Status {
+    std::unique_ptr<StorageIterator> itr;
+    ZETASQL_RETURN_IF_ERROR(storage_->Read(read_timestamp, table->id(),
+                                   KeyRange::All(),
+                                   GetColumnIDs(table->columns()), &itr));
+    return fn(table, itr.get());
+  };
+
+  const Schema* schema = versioned_catalog_->GetSchema(read_timestamp);
+  for (const Table* table : schema->tables()) {
+    ZETASQL_RETURN_IF_ERROR(export_table(table));
+    for (const Index* index : table->indexes()) {
+      ZETASQL_RETURN_IF_ERROR(export_table(index->index_data_table()));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status Database::ImportTables(
+    std::vector<std::pair<const Table*, std::vector<ValueList>>> tables) {
+  // Take an exclusive lock on the database, the same way a schema change does,
+  // to load all the tables at a single commit timestamp.
+  ScopedSchemaChangeLock lock{transaction_id_generator_.NextId(),
+                              lock_manager_.get()};
+  ZETASQL_RETURN_IF_ERROR(lock.Wait());
+  ZETASQL_ASSIGN_OR_RETURN(absl::Time commit_timestamp,
+                   lock.ReserveCommitTimestamp());
+
+  for (auto& [table, rows] : tables) {
+    // Find the position of each key column in the rows.
+    std::vector<int> key_indices;
+    for (const KeyColumn* key_column : table->primary_key()) {
+      auto itr = std::find(table->columns().begin(), table->columns().end(),
+                           key_column->column());
+      ZETASQL_RET_CHECK(itr != table->columns().end());
+      key_indices.push_back(std::distance(table->columns().begin(), itr));
+    }
+
+    std::vector<std::pair<Key, ValueList>> keyed_rows;
+    keyed_rows.reserve(rows.size());
+    for (ValueList& row : rows) {
+      ZETASQL_RET_CHECK_EQ(row.size(), table->columns().size());
+      Key key;
+      for (int i = 0; i < key_indices.size(); ++i) {
+        key.AddColumn(row[key_indices[i]],
+                      table->primary_key()[i]->is_descending());
+      }
+      keyed_rows.emplace_back(std::move(key), std::move(row));
+    }
+    ZETASQL_RETURN_IF_ERROR(storage_->BulkLoad(commit_timestamp, table->id(),
+                                       GetColumnIDs(table->columns()),
+                                       std::move(keyed_rows)));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
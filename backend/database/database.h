@@ -17,8 +17,10 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_DATABASE_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_DATABASE_DATABASE_H_
 
+#include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "zetasql/public/type.h"
@@ -28,11 +30,18 @@
 #include "absl/types/variant.h"
 #include "backend/actions/manager.h"
 #include "backend/common/ids.h"
+#include "backend/common/admission_controller.h"
+#include "backend/common/memory_tracker.h"
+#include "backend/datamodel/value.h"
 #include "backend/locking/manager.h"
 #include "backend/query/query_engine.h"
+#include "backend/schema/catalog/schema.h"
+#include "backend/schema/catalog/table.h"
 #include "backend/schema/catalog/versioned_catalog.h"
 #include "backend/schema/updater/schema_updater.h"
+#include "backend/storage/iterator.h"
 #include "backend/storage/storage.h"
+#include "backend/transaction/change_log.h"
 #include "backend/transaction/options.h"
 #include "backend/transaction/read_only_transaction.h"
 #include "backend/transaction/read_write_transaction.h"
@@ -103,9 +112,36 @@ class Database {
   // schema.
   std::vector<std::string> GetSchema();
 
+  // Returns the current version of the schema.
+  const Schema* GetLatestSchema() const;
+
+  // Calls `fn` for every table of the current schema, including the tables
+  // backing indexes, with an iterator over the rows of the table as of a strong
+  // read. The iterator yields the values of all of the table's columns, in
+  // order. Used to snapshot the database.
+  absl::Status ExportTables(
+      const std::function<absl::Status(const Table*, StorageIterator*)>& fn);
+
+  // Bulk loads rows into tables of the current schema, which must be empty.
+  // Each row holds the values of all of the table's columns, in order. All rows
+  // are loaded at a single commit timestamp. Used to restore snapshots.
+  absl::Status ImportTables(
+      std::vector<std::pair<const Table*, std::vector<ValueList>>> tables);
+
   // Used to execute queries against the database.
   QueryEngine* query_engine() { return query_engine_.get(); }
 
+  // Returns the tracker accounting the memory held by this database's storage,
+  // transaction buffers and query results.
+  const MemoryTracker& memory_tracker() const { return memory_tracker_; }
+
+  // Returns the controller bounding the requests concurrently executing on
+  // this database.
+  AdmissionController* admission_controller() { return &admission_controller_; }
+
+  // Returns the log of the row changes recently committed to this database.
+  ChangeLog* change_log() { return &change_log_; }
+
  private:
   Database();
   // Delete copy and assignment operators since database shouldn't be copyable.
@@ -114,6 +150,24 @@ class Database {
 
   SchemaChangeContext GetSchemaChangeContext();
 
+  // Declares the interleaving of the tables of the given schema to storage.
+  absl::Status InterleaveStorageTables(const Schema* schema);
+
+  // Drops from storage the tables and indexes of 'old_schema' which are not in
+  // 'new_schema', releasing the memory held by their data.
+  absl::Status DropStorageTables(const Schema* old_schema,
+                                 const Schema* new_schema);
+
+  // Accounts the memory held by this database. Declared first so that it
+  // outlives the subsystems which account against it.
+  MemoryTracker memory_tracker_;
+
+  // Bounds the number of requests concurrently executing on this database.
+  AdmissionController admission_controller_;
+
+  // Retains the most recent row changes committed to this database.
+  ChangeLog change_log_;
+
   // Clock to provide commit timestamps.
   Clock* clock_;
 
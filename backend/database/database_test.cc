@@ -16,6 +16,7 @@
 
 #include "backend/database/database.h"
 
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
@@ -28,6 +29,9 @@
 #include "backend/access/read.h"
 #include "backend/common/ids.h"
 #include "backend/datamodel/key_set.h"
+#include "backend/schema/catalog/index.h"
+#include "backend/schema/catalog/schema.h"
+#include "backend/storage/iterator.h"
 #include "backend/transaction/options.h"
 #include "common/clock.h"
 #include "common/errors.h"
@@ -204,6 +208,102 @@ TEST_F(DatabaseTest, SchemaChangeLocksSuccesfullyReleased) {
   ZETASQL_EXPECT_OK(txn->Commit());
 }
 
+TEST_F(DatabaseTest, DroppingTablesAndIndexesReleasesTheirMemory) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto db, Database::Create(&clock_, {R"(
+    CREATE TABLE T(
+      k1 INT64,
+      k2 INT64,
+    ) PRIMARY KEY(k1)
+  )",
+                                                           R"(
+    CREATE INDEX I on T(k2)
+  )"}));
+  const int64_t initial_bytes = db->memory_tracker().bytes_used();
+  {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<ReadWriteTransaction> txn,
+        db->CreateReadWriteTransaction(ReadWriteOptions(), RetryState()));
+    Mutation m;
+    m.AddWriteOp(MutationOpType::kInsert, "T", {"k1", "k2"},
+                 {{Int64(1), Int64(20)}, {Int64(2), Int64(10)}});
+    ZETASQL_ASSERT_OK(txn->Write(m));
+    ZETASQL_ASSERT_OK(txn->Commit());
+  }
+  const int64_t bytes_with_index = db->memory_tracker().bytes_used();
+  EXPECT_GT(bytes_with_index, initial_bytes);
+
+  absl::Status backfill_status;
+  int completed_statements;
+  absl::Time commit_ts;
+  ZETASQL_ASSERT_OK(db->UpdateSchema(std::vector<std::string>{"DROP INDEX I"},
+                             &completed_statements, &commit_ts,
+                             &backfill_status));
+  ZETASQL_ASSERT_OK(backfill_status);
+  EXPECT_LT(db->memory_tracker().bytes_used(), bytes_with_index);
+  EXPECT_GT(db->memory_tracker().bytes_used(), initial_bytes);
+
+  ZETASQL_ASSERT_OK(db->UpdateSchema(std::vector<std::string>{"DROP TABLE T"},
+                             &completed_statements, &commit_ts,
+                             &backfill_status));
+  ZETASQL_ASSERT_OK(backfill_status);
+  EXPECT_EQ(db->memory_tracker().bytes_used(), initial_bytes);
+}
+
+TEST_F(DatabaseTest, ExportedTablesCanBeImported) {
+  std::vector<std::string> statements = {R"(
+    CREATE TABLE T(
+      k1 INT64,
+      k2 INT64,
+    ) PRIMARY KEY(k1))",
+                                         R"(
+    CREATE INDEX I on T(k2))"};
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto source, Database::Create(&clock_, statements));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ReadWriteTransaction> txn,
+      source->CreateReadWriteTransaction(ReadWriteOptions(), RetryState()));
+  Mutation m;
+  m.AddWriteOp(MutationOpType::kInsert, "T", {"k1", "k2"},
+               {{Int64(1), Int64(20)}, {Int64(2), Int64(10)}});
+  ZETASQL_ASSERT_OK(txn->Write(m));
+  ZETASQL_ASSERT_OK(txn->Commit());
+
+  // Export the rows of the table and of the index data table.
+  std::map<std::string, std::vector<ValueList>> exported;
+  ZETASQL_ASSERT_OK(source->ExportTables(
+      [&](const Table* table, StorageIterator* itr) -> absl::Status {
+        std::vector<ValueList>& rows = exported[table->Name()];
+        while (itr->Next()) {
+          rows.emplace_back();
+          for (int i = 0; i < itr->NumColumns(); ++i) {
+            rows.back().push_back(itr->ColumnValue(i));
+          }
+        }
+        return itr->Status();
+      }));
+  ASSERT_EQ(exported.size(), 2);
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto target, Database::Create(&clock_, statements));
+  const Schema* schema = target->GetLatestSchema();
+  const Table* table = schema->FindTable("T");
+  const Table* index_table = schema->FindIndex("I")->index_data_table();
+  ZETASQL_ASSERT_OK(target->ImportTables(
+      {{table, exported[table->Name()]},
+       {index_table, exported[index_table->Name()]}}));
+
+  // Read the imported rows through the index.
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ReadOnlyTransaction> read_txn,
+                       target->CreateReadOnlyTransaction(ReadOnlyOptions()));
+  ReadArg read_arg = read_column("T", "k1");
+  read_arg.index = "I";
+  std::unique_ptr<RowCursor> cursor;
+  ZETASQL_ASSERT_OK(read_txn->Read(read_arg, &cursor));
+  ASSERT_TRUE(cursor->Next());
+  EXPECT_EQ(cursor->ColumnValue(0), Int64(2));
+  ASSERT_TRUE(cursor->Next());
+  EXPECT_EQ(cursor->ColumnValue(0), Int64(1));
+  EXPECT_FALSE(cursor->Next());
+}
+
 }  // namespace
 }  // namespace backend
 }  // namespace emulator
@@ -94,6 +94,12 @@ class Key {
   // Returns true if the key does not have any columns.
   bool IsEmpty() const { return columns_.empty(); }
 
+  // Returns true if this is the key returned by Key::Infinity().
+  bool IsInfinity() const { return is_infinity_; }
+
+  // Returns true if this is a prefix limit key (see ToPrefixLimit()).
+  bool IsPrefixLimit() const { return is_prefix_limit_; }
+
   // Returns the logical size of the key in bytes.
   int64_t LogicalSizeInBytes() const;
 
@@ -26,7 +26,9 @@
 #include "backend/query/function_catalog.h"
 #include "backend/query/information_schema_catalog.h"
 #include "backend/query/queryable_table.h"
+#include "backend/query/spanner_sys_catalog.h"
 #include "backend/schema/catalog/schema.h"
+#include "backend/storage/storage.h"
 #include "common/errors.h"
 #include "absl/status/status.h"
 
@@ -68,8 +70,16 @@ class NetCatalog : public zetasql::Catalog {
 };
 
 Catalog::Catalog(const Schema* schema, const FunctionCatalog* function_catalog,
-                 RowReader* reader)
-    : schema_(schema), function_catalog_(function_catalog) {
+                 RowReader* reader, const Storage* storage,
+                 const MemoryTracker* memory_tracker,
+                 const AdmissionController* admission_controller,
+                 const QueryResultCache* result_cache)
+    : schema_(schema),
+      function_catalog_(function_catalog),
+      storage_(storage),
+      memory_tracker_(memory_tracker),
+      admission_controller_(admission_controller),
+      result_cache_(result_cache) {
   for (const auto* table : schema->tables()) {
     tables_[table->Name()] = absl::make_unique<QueryableTable>(table, reader);
   }
@@ -80,6 +90,8 @@ absl::Status Catalog::GetCatalog(const std::string& name,
                                  const FindOptions& options) {
   if (absl::EqualsIgnoreCase(name, InformationSchemaCatalog::kName)) {
     *catalog = GetInformationSchemaCatalog();
+  } else if (absl::EqualsIgnoreCase(name, SpannerSysCatalog::kName)) {
+    *catalog = GetSpannerSysCatalog();
   } else if (absl::EqualsIgnoreCase(name, NetCatalog::kName)) {
     *catalog = GetNetFunctionsCatalog();
   }
@@ -109,6 +121,9 @@ absl::Status Catalog::GetFunction(const std::string& name,
 absl::Status Catalog::GetCatalogs(
     absl::flat_hash_set<const zetasql::Catalog*>* output) const {
   output->insert(GetInformationSchemaCatalog());
+  if (storage_ != nullptr) {
+    output->insert(GetSpannerSysCatalog());
+  }
   output->insert(GetNetFunctionsCatalog());
   return absl::OkStatus();
 }
@@ -140,6 +155,21 @@ zetasql::Catalog* Catalog::GetInformationSchemaCatalog() const {
   return information_schema_catalog_.get();
 }
 
+zetasql::Catalog* Catalog::GetSpannerSysCatalog() const {
+  if (storage_ == nullptr) {
+    return nullptr;
+  }
+  absl::MutexLock lock(&mu_);
+  if (!spanner_sys_catalog_) {
+    spanner_sys_catalog_ =
+        absl::make_unique<SpannerSysCatalog>(schema_, storage_,
+                                             memory_tracker_,
+                                             admission_controller_,
+                                             result_cache_);
+  }
+  return spanner_sys_catalog_.get();
+}
+
 zetasql::Catalog* Catalog::GetNetFunctionsCatalog() const {
   absl::MutexLock lock(&mu_);
   if (!net_catalog_) {
@@ -25,10 +25,14 @@
 #include "zetasql/public/simple_catalog.h"
 #include "absl/strings/str_cat.h"
 #include "backend/access/read.h"
+#include "backend/common/admission_controller.h"
 #include "backend/common/case.h"
+#include "backend/common/memory_tracker.h"
 #include "backend/query/function_catalog.h"
+#include "backend/query/query_result_cache.h"
 #include "backend/query/queryable_table.h"
 #include "backend/schema/catalog/schema.h"
+#include "backend/storage/storage.h"
 #include "absl/status/status.h"
 
 namespace google {
@@ -43,9 +47,15 @@ class NetCatalog;
 class Catalog : public zetasql::EnumerableCatalog {
  public:
   // 'reader' can be nullptr unless CreateEvaluatorTableIterator is called on
-  // tables in the catalog.
+  // tables in the catalog. The SPANNER_SYS catalog is only available if
+  // 'storage' is provided, and exposes the memory usage accounted by
+  // 'memory_tracker' and the counters of 'admission_controller' and
+  // 'result_cache' if those are provided too.
   Catalog(const Schema* schema, const FunctionCatalog* function_catalog,
-          RowReader* reader);
+          RowReader* reader, const Storage* storage = nullptr,
+          const MemoryTracker* memory_tracker = nullptr,
+          const AdmissionController* admission_controller = nullptr,
+          const QueryResultCache* result_cache = nullptr);
   Catalog(const Schema* schema, const FunctionCatalog* function_catalog)
       : Catalog(schema, function_catalog, /*reader=*/nullptr) {}
 
@@ -54,6 +64,13 @@ class Catalog : public zetasql::EnumerableCatalog {
     return "";
   }
 
+  // Returns true if the SPANNER_SYS catalog was resolved, in which case query
+  // results depend on the current statistics rather than only on a snapshot.
+  bool spanner_sys_accessed() const ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    return spanner_sys_catalog_ != nullptr;
+  }
+
  private:
   friend class NetCatalog;
 
@@ -80,6 +97,10 @@ class Catalog : public zetasql::EnumerableCatalog {
   zetasql::Catalog* GetInformationSchemaCatalog() const
       ABSL_LOCKS_EXCLUDED(mu_);
 
+  // Returns the SPANNER_SYS catalog (creating one if needed), or nullptr if
+  // there is no storage to provide its statistics.
+  zetasql::Catalog* GetSpannerSysCatalog() const ABSL_LOCKS_EXCLUDED(mu_);
+
   // Returns the NET catalog.
   zetasql::Catalog* GetNetFunctionsCatalog() const ABSL_LOCKS_EXCLUDED(mu_);
 
@@ -92,6 +113,20 @@ class Catalog : public zetasql::EnumerableCatalog {
   // Functions available in the default schema.
   const FunctionCatalog* function_catalog_;
 
+  // Storage providing the statistics in SPANNER_SYS, may be nullptr.
+  const Storage* storage_;
+
+  // Tracker providing the memory usage in SPANNER_SYS, may be nullptr.
+  const MemoryTracker* memory_tracker_;
+
+  // Controller providing the request admission counters in SPANNER_SYS, may
+  // be nullptr.
+  const AdmissionController* admission_controller_;
+
+  // Cache providing the query result cache counters in SPANNER_SYS, may be
+  // nullptr.
+  const QueryResultCache* result_cache_;
+
   // Mutex to protect state below.
   mutable absl::Mutex mu_;
 
@@ -99,6 +134,10 @@ class Catalog : public zetasql::EnumerableCatalog {
   mutable std::unique_ptr<zetasql::Catalog> information_schema_catalog_
       ABSL_GUARDED_BY(mu_);
 
+  // SPANNER_SYS catalog (created only if accessed).
+  mutable std::unique_ptr<zetasql::Catalog> spanner_sys_catalog_
+      ABSL_GUARDED_BY(mu_);
+
   // Sub-catalog for resolving NET function lookup.
   mutable std::unique_ptr<zetasql::Catalog> net_catalog_ ABSL_GUARDED_BY(mu_);
 };
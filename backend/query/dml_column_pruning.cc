@@ -0,0 +1,192 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/query/dml_column_pruning.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/value.h"
+#include "zetasql/resolved_ast/resolved_ast.h"
+#include "zetasql/resolved_ast/resolved_ast_visitor.h"
+#include "zetasql/resolved_ast/resolved_node_kind.pb.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "backend/query/queryable_table.h"
+#include "backend/schema/catalog/column.h"
+#include "zetasql/base/ret_check.h"
+#include "absl/status/status.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+// Collects the table scans and column references of a statement.
+class ColumnReferenceCollector : public zetasql::ResolvedASTVisitor {
+ public:
+  absl::Status VisitResolvedTableScan(
+      const zetasql::ResolvedTableScan* scan) override {
+    table_scans_.push_back(scan);
+    return DefaultVisit(scan);
+  }
+
+  absl::Status VisitResolvedColumnRef(
+      const zetasql::ResolvedColumnRef* column_ref) override {
+    referenced_column_ids_.insert(column_ref->column().column_id());
+    return DefaultVisit(column_ref);
+  }
+
+  const std::vector<const zetasql::ResolvedTableScan*>& table_scans() const {
+    return table_scans_;
+  }
+
+  bool IsReferenced(const zetasql::ResolvedColumn& column) const {
+    return referenced_column_ids_.contains(column.column_id());
+  }
+
+ private:
+  std::vector<const zetasql::ResolvedTableScan*> table_scans_;
+  absl::flat_hash_set<int> referenced_column_ids_;
+};
+
+// A RowCursor which exposes the columns of a cursor over a subset of them,
+// returning NULL for the columns which were not read.
+class PaddedRowCursor : public RowCursor {
+ public:
+  PaddedRowCursor(std::unique_ptr<RowCursor> cursor,
+                  std::vector<std::string> column_names,
+                  std::vector<const zetasql::Type*> column_types,
+                  std::vector<int> cursor_indexes)
+      : cursor_(std::move(cursor)),
+        column_names_(std::move(column_names)),
+        column_types_(std::move(column_types)),
+        cursor_indexes_(std::move(cursor_indexes)) {}
+
+  bool Next() override { return cursor_->Next(); }
+
+  absl::Status Status() const override { return cursor_->Status(); }
+
+  int NumColumns() const override { return column_names_.size(); }
+
+  const std::string ColumnName(int i) const override {
+    return column_names_[i];
+  }
+
+  const zetasql::Value ColumnValue(int i) const override {
+    if (cursor_indexes_[i] < 0) {
+      return zetasql::Value::Null(column_types_[i]);
+    }
+    return cursor_->ColumnValue(cursor_indexes_[i]);
+  }
+
+  const zetasql::Type* ColumnType(int i) const override {
+    return column_types_[i];
+  }
+
+ private:
+  std::unique_ptr<RowCursor> cursor_;
+  std::vector<std::string> column_names_;
+  std::vector<const zetasql::Type*> column_types_;
+
+  // Index of each column in `cursor_`, or -1 if it was not read.
+  std::vector<int> cursor_indexes_;
+};
+
+}  // namespace
+
+zetasql_base::StatusOr<DmlReadColumns> CollectDmlReadColumns(
+    const zetasql::ResolvedStatement* statement) {
+  const zetasql::ResolvedTableScan* target_scan = nullptr;
+  switch (statement->node_kind()) {
+    case zetasql::RESOLVED_UPDATE_STMT:
+      target_scan =
+          statement->GetAs<zetasql::ResolvedUpdateStmt>()->table_scan();
+      break;
+    case zetasql::RESOLVED_DELETE_STMT:
+      target_scan =
+          statement->GetAs<zetasql::ResolvedDeleteStmt>()->table_scan();
+      break;
+    default:
+      return DmlReadColumns{};
+  }
+
+  ColumnReferenceCollector collector;
+  ZETASQL_RETURN_IF_ERROR(statement->Accept(&collector));
+
+  // Reads cannot tell scans of the same table apart, so only prune the target
+  // table if no other scan (e.g. in a subquery) reads it.
+  for (const zetasql::ResolvedTableScan* scan : collector.table_scans()) {
+    if (scan != target_scan && scan->table() == target_scan->table()) {
+      return DmlReadColumns{};
+    }
+  }
+
+  const Table* table =
+      target_scan->table()->GetAs<QueryableTable>()->wrapped_table();
+  DmlReadColumns read_columns{.table = table};
+  for (const KeyColumn* key_column : table->primary_key()) {
+    read_columns.columns.insert(key_column->column()->Name());
+  }
+  for (const zetasql::ResolvedColumn& column : target_scan->column_list()) {
+    if (collector.IsReferenced(column)) {
+      read_columns.columns.insert(column.name());
+    }
+  }
+  return read_columns;
+}
+
+absl::Status PruningRowReader::Read(const ReadArg& read_arg,
+                                    std::unique_ptr<RowCursor>* cursor) {
+  if (read_columns_.table == nullptr || !read_arg.index.empty() ||
+      !absl::EqualsIgnoreCase(read_arg.table, read_columns_.table->Name())) {
+    return reader_->Read(read_arg, cursor);
+  }
+
+  ReadArg pruned_arg = read_arg;
+  pruned_arg.columns.clear();
+  std::vector<const zetasql::Type*> column_types;
+  std::vector<int> cursor_indexes;
+  for (const std::string& name : read_arg.columns) {
+    const Column* column = read_columns_.table->FindColumn(name);
+    ZETASQL_RET_CHECK_NE(column, nullptr);
+    column_types.push_back(column->GetType());
+    if (read_columns_.columns.contains(name)) {
+      cursor_indexes.push_back(pruned_arg.columns.size());
+      pruned_arg.columns.push_back(name);
+    } else {
+      cursor_indexes.push_back(-1);
+    }
+  }
+
+  std::unique_ptr<RowCursor> pruned_cursor;
+  ZETASQL_RETURN_IF_ERROR(reader_->Read(pruned_arg, &pruned_cursor));
+  *cursor = absl::make_unique<PaddedRowCursor>(
+      std::move(pruned_cursor), read_arg.columns, std::move(column_types),
+      std::move(cursor_indexes));
+  return absl::OkStatus();
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,85 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_DML_COLUMN_PRUNING_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_DML_COLUMN_PRUNING_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/resolved_ast/resolved_ast.h"
+#include "backend/access/read.h"
+#include "backend/common/case.h"
+#include "backend/schema/catalog/table.h"
+#include "absl/status/status.h"
+#include "zetasql/base/statusor.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// Columns of the target table which an UPDATE or DELETE statement reads.
+struct DmlReadColumns {
+  // The target table. Null if all columns of all tables must be read.
+  const Table* table = nullptr;
+
+  // Names of the columns of `table` which must be read: its primary key
+  // columns and the columns referenced by the statement's predicate and
+  // assignments.
+  CaseInsensitiveStringSet columns;
+};
+
+// Returns the columns of the target table which `statement` reads.
+//
+// DML statements are analyzed without pruning unused columns, since the
+// evaluator produces complete rows for the target table. Only UPDATE and
+// DELETE statements which scan their target table once are pruned; for any
+// other statement the returned table is null.
+zetasql_base::StatusOr<DmlReadColumns> CollectDmlReadColumns(
+    const zetasql::ResolvedStatement* statement);
+
+// PruningRowReader wraps a RowReader and skips reading the columns of a table
+// which a DML statement does not reference, returning NULLs for them instead.
+class PruningRowReader : public RowReader {
+ public:
+  explicit PruningRowReader(RowReader* reader) : reader_(reader) {}
+
+  // Restricts all subsequent reads of `read_columns.table` to
+  // `read_columns.columns`. Has no effect if the table is null.
+  void Prune(DmlReadColumns read_columns) {
+    read_columns_ = std::move(read_columns);
+  }
+
+  absl::Status Read(const ReadArg& read_arg,
+                    std::unique_ptr<RowCursor>* cursor) override;
+
+ private:
+  // The wrapped reader.
+  RowReader* reader_;
+
+  // Columns to read from the pruned table.
+  DmlReadColumns read_columns_;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_DML_COLUMN_PRUNING_H_
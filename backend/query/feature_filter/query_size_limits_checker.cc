@@ -58,18 +58,12 @@ const int QuerySizeLimitsChecker::kMaxNestedStructDepth = 15;
 
 absl::Status QuerySizeLimitsChecker::CheckQueryAgainstLimits(
     const ResolvedNode* ast_root) {
-  std::set<ResolvedNodeKind> interest_nodes;
-  interest_nodes.insert(ResolvedNodeKind::RESOLVED_JOIN_SCAN);
-  interest_nodes.insert(ResolvedNodeKind::RESOLVED_PROJECT_SCAN);
-  interest_nodes.insert(ResolvedNodeKind::RESOLVED_SUBQUERY_EXPR);
-  interest_nodes.insert(ResolvedNodeKind::RESOLVED_AGGREGATE_SCAN);
-  interest_nodes.insert(ResolvedNodeKind::RESOLVED_FUNCTION_CALL);
-  interest_nodes.insert(ResolvedNodeKind::RESOLVED_PARAMETER);
-  std::map<ResolvedNodeKind, NodeCounts> collected_node_counts;
-  ZETASQL_RETURN_IF_ERROR(GetNodeMetricsAndRunLocalChecks(ast_root, interest_nodes,
-                                                  &collected_node_counts));
-  ZETASQL_RETURN_IF_ERROR(RunGlobalChecks(collected_node_counts));
-  return absl::OkStatus();
+  ZETASQL_RETURN_IF_ERROR(GetNodeMetricsAndRunLocalChecks(ast_root));
+  return CheckAddedNodes();
+}
+
+absl::Status QuerySizeLimitsChecker::CheckAddedNodes() {
+  return RunGlobalChecks(collected_node_counts_);
 }
 
 absl::Status QuerySizeLimitsChecker::CheckNumPredicates(
@@ -79,7 +73,7 @@ absl::Status QuerySizeLimitsChecker::CheckNumPredicates(
   if (it == collected_node_counts.end()) {
     return absl::OkStatus();
   }
-  const auto node_counts = it->second;
+  const auto& node_counts = it->second;
   if (node_counts.total_occurrences > kMaxFunctionNodes) {
     return error::TooManyFunctions(kMaxFunctionNodes);
   }
@@ -93,8 +87,8 @@ absl::Status QuerySizeLimitsChecker::CheckPredicateBooleanExpressionDepth(
   if (it == collected_node_counts.end()) {
     return absl::OkStatus();
   }
-  const auto node_counts = it->second;
-  if (node_counts.nested_occurrences > kMaxNestedFunctionNodes) {
+  const auto& node_counts = it->second;
+  if (node_counts.occurrence_depths.size() > kMaxNestedFunctionNodes) {
     return error::TooManyNestedBooleanPredicates(kMaxNestedFunctionNodes);
   }
   return absl::OkStatus();
@@ -106,7 +100,7 @@ absl::Status QuerySizeLimitsChecker::CheckNumJoins(
   if (it == collected_node_counts.end()) {
     return absl::OkStatus();
   }
-  const auto node_counts = it->second;
+  const auto& node_counts = it->second;
   if (node_counts.total_occurrences > kMaxJoins) {
     return error::TooManyJoins(kMaxJoins);
   }
@@ -120,8 +114,8 @@ absl::Status QuerySizeLimitsChecker::CheckSubqueryExpressionDepth(
   if (it == collected_node_counts.end()) {
     return absl::OkStatus();
   }
-  const auto node_counts = it->second;
-  if (node_counts.nested_occurrences > kMaxNestedSubqueryExpressions) {
+  const auto& node_counts = it->second;
+  if (node_counts.occurrence_depths.size() > kMaxNestedSubqueryExpressions) {
     return error::TooManyNestedSubqueries(kMaxNestedSubqueryExpressions);
   }
   return absl::OkStatus();
@@ -133,8 +127,8 @@ absl::Status QuerySizeLimitsChecker::CheckSubselectDepth(
   if (it == collected_node_counts.end()) {
     return absl::OkStatus();
   }
-  const auto node_counts = it->second;
-  if (node_counts.nested_occurrences > kMaxNestedSubselects) {
+  const auto& node_counts = it->second;
+  if (node_counts.occurrence_depths.size() > kMaxNestedSubselects) {
     return error::TooManyNestedSubselects(kMaxNestedSubselects);
   }
   return absl::OkStatus();
@@ -147,8 +141,8 @@ absl::Status QuerySizeLimitsChecker::CheckGroupByDepth(
   if (it == collected_node_counts.end()) {
     return absl::OkStatus();
   }
-  const auto node_counts = it->second;
-  if (node_counts.nested_occurrences > kMaxNestedGroupBy) {
+  const auto& node_counts = it->second;
+  if (node_counts.occurrence_depths.size() > kMaxNestedGroupBy) {
     return error::TooManyNestedAggregates(kMaxNestedGroupBy);
   }
   return absl::OkStatus();
@@ -160,7 +154,7 @@ absl::Status QuerySizeLimitsChecker::CheckNumParameters(
   if (it == collected_node_counts.end()) {
     return absl::OkStatus();
   }
-  const auto node_counts = it->second;
+  const auto& node_counts = it->second;
   if (node_counts.total_occurrences > kMaxParameters) {
     return error::TooManyParameters(kMaxParameters);
   }
@@ -296,10 +290,28 @@ absl::Status QuerySizeLimitsChecker::RunNodeLocalChecks(
   return absl::OkStatus();
 }
 
+absl::Status QuerySizeLimitsChecker::AddNode(const ResolvedNode* node,
+                                             int depth) {
+  switch (node->node_kind()) {
+    case ResolvedNodeKind::RESOLVED_JOIN_SCAN:
+    case ResolvedNodeKind::RESOLVED_PROJECT_SCAN:
+    case ResolvedNodeKind::RESOLVED_SUBQUERY_EXPR:
+    case ResolvedNodeKind::RESOLVED_AGGREGATE_SCAN:
+    case ResolvedNodeKind::RESOLVED_FUNCTION_CALL:
+    case ResolvedNodeKind::RESOLVED_PARAMETER: {
+      NodeCounts& node_counts = collected_node_counts_[node->node_kind()];
+      node_counts.total_occurrences++;
+      node_counts.occurrence_depths.insert(depth);
+      break;
+    }
+    default:
+      break;
+  }
+  return RunNodeLocalChecks(node);
+}
+
 absl::Status QuerySizeLimitsChecker::GetNodeMetricsAndRunLocalChecks(
-    const ResolvedNode* ast_root,
-    const std::set<ResolvedNodeKind>& interest_nodes,
-    std::map<ResolvedNodeKind, NodeCounts>* collected_node_counts) {
+    const ResolvedNode* ast_root) {
   std::queue<const ResolvedNode*> node_queue;
   node_queue.push(ast_root);
   node_queue.push(nullptr);
@@ -314,24 +326,7 @@ absl::Status QuerySizeLimitsChecker::GetNodeMetricsAndRunLocalChecks(
       }
       continue;
     }
-    if (interest_nodes.find(node->node_kind()) != interest_nodes.end()) {
-      auto it = collected_node_counts->find(node->node_kind());
-      if (it != collected_node_counts->end()) {
-        NodeCounts& count_info = it->second;
-        count_info.total_occurrences++;
-        if (tree_depth > count_info.max_occurrence_depth) {
-          count_info.nested_occurrences++;
-        }
-        count_info.max_occurrence_depth = tree_depth;
-      } else {
-        NodeCounts node_counts;
-        node_counts.max_occurrence_depth = tree_depth;
-        node_counts.nested_occurrences = 1;
-        node_counts.total_occurrences = 1;
-        (*collected_node_counts)[node->node_kind()] = node_counts;
-      }
-    }
-    ZETASQL_RETURN_IF_ERROR(RunNodeLocalChecks(node));
+    ZETASQL_RETURN_IF_ERROR(AddNode(node, tree_depth));
     std::vector<const ResolvedNode*> child_nodes;
     node->GetChildNodes(&child_nodes);
     for (const ResolvedNode* child_node : child_nodes) {
@@ -30,6 +30,16 @@ namespace google::spanner::emulator::backend {
 class QuerySizeLimitsChecker {
  public:
   absl::Status CheckQueryAgainstLimits(const zetasql::ResolvedNode* ast_root);
+
+  // Accounts `node`, found `depth` levels below the root of the tree, and runs
+  // the checks that only depend on the node itself. Together with
+  // CheckAddedNodes, this allows checking a tree while another visitor walks
+  // it instead of walking it again.
+  absl::Status AddNode(const zetasql::ResolvedNode* node, int depth);
+
+  // Runs the checks that depend on all the nodes added with AddNode.
+  absl::Status CheckAddedNodes();
+
   virtual ~QuerySizeLimitsChecker() {}
   static const int kMaxJoins;
   static const int kMaxNestedSubqueryExpressions;
@@ -46,14 +56,13 @@ class QuerySizeLimitsChecker {
 
  private:
   struct NodeCounts {
-    int max_occurrence_depth;
-    int total_occurrences;
-    int nested_occurrences;
+    int total_occurrences = 0;
+    // Distinct depths of the tree the node kind occurs at. Its size is the
+    // number of nested occurrences of the node kind.
+    std::set<int> occurrence_depths;
   };
   absl::Status GetNodeMetricsAndRunLocalChecks(
-      const zetasql::ResolvedNode* ast_root,
-      const std::set<zetasql::ResolvedNodeKind>& interest_nodes,
-      std::map<zetasql::ResolvedNodeKind, NodeCounts>* collected_node_counts);
+      const zetasql::ResolvedNode* ast_root);
   absl::Status CheckNumPredicates(
       const std::map<zetasql::ResolvedNodeKind, NodeCounts>&
           collected_node_counts);
@@ -85,6 +94,9 @@ class QuerySizeLimitsChecker {
   absl::Status CheckNumSubQueriesInSelectList(
       const zetasql::ResolvedNode* node);
   absl::Status RunNodeLocalChecks(const zetasql::ResolvedNode* node);
+
+  // Counts of the node kinds limited by the global checks.
+  std::map<zetasql::ResolvedNodeKind, NodeCounts> collected_node_counts_;
 };
 
 }  // namespace google::spanner::emulator::backend
@@ -1,42 +0,0 @@
-//
-// Copyright 2020 Google LLC
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-//      http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-//
-
-#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_HINT_REWRITER_H_
-#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_HINT_REWRITER_H_
-
-#include "zetasql/resolved_ast/resolved_ast.h"
-#include "zetasql/resolved_ast/resolved_ast_deep_copy_visitor.h"
-#include "absl/status/status.h"
-
-namespace google {
-namespace spanner {
-namespace emulator {
-namespace backend {
-
-// Implements ResolvedASTDeepCopyVisitor to rewrite empty hint qualifiers to
-// "spanner".
-class HintRewriter : public zetasql::ResolvedASTDeepCopyVisitor {
- public:
-  absl::Status VisitResolvedOption(
-      const zetasql::ResolvedOption* node) override;
-};
-
-}  // namespace backend
-}  // namespace emulator
-}  // namespace spanner
-}  // namespace google
-
-#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_HINT_REWRITER_H_
@@ -75,7 +75,11 @@ absl::Status IndexHintValidator::VisitResolvedTableScan(
     const zetasql::ResolvedTableScan* table_scan) {
   // Visit child nodes first.
   ZETASQL_RETURN_IF_ERROR(zetasql::ResolvedASTVisitor::DefaultVisit(table_scan));
+  return CollectIndexHint(table_scan);
+}
 
+absl::Status IndexHintValidator::CollectIndexHint(
+    const zetasql::ResolvedTableScan* table_scan) {
   std::vector<const zetasql::ResolvedNode*> child_nodes;
   table_scan->GetChildNodes(&child_nodes);
 
@@ -101,7 +105,8 @@ absl::Status IndexHintValidator::VisitResolvedTableScan(
   return absl::OkStatus();
 }
 
-absl::Status IndexHintValidator::ValidateIndexesForTables() {
+absl::Status IndexHintValidator::ValidateIndexesForTables(
+    bool disable_null_filtered_index_check) {
   for (auto [table_scan, index_name] : index_hints_map_) {
     if (absl::EqualsIgnoreCase(index_name, "_base_table")) {
       continue;
@@ -120,7 +125,7 @@ absl::Status IndexHintValidator::ValidateIndexesForTables() {
       return error::QueryHintManagedIndexNotSupported(index_name);
     }
 
-    if (index->is_null_filtered() && !disable_null_filtered_index_check_) {
+    if (index->is_null_filtered() && !disable_null_filtered_index_check) {
       for (const auto* key_column : index->key_columns()) {
         const auto* source_column = key_column->column()->source_column();
         // If any of the index's columns are nullable, then it is not indexing
@@ -141,7 +146,7 @@ absl::Status IndexHintValidator::VisitResolvedQueryStmt(
   // Visit children first to collect all hints.
   ZETASQL_RETURN_IF_ERROR(zetasql::ResolvedASTVisitor::DefaultVisit(stmt));
   // Validate all index hints.
-  return ValidateIndexesForTables();
+  return ValidateIndexesForTables(disable_null_filtered_index_check_);
 }
 
 absl::Status IndexHintValidator::VisitResolvedInsertStmt(
@@ -150,7 +155,7 @@ absl::Status IndexHintValidator::VisitResolvedInsertStmt(
   ZETASQL_RETURN_IF_ERROR(zetasql::ResolvedASTVisitor::DefaultVisit(stmt));
   // The target table should not have any hints (not allowed by ZetaSQL).
   ZETASQL_RET_CHECK(!index_hints_map_.contains(stmt->table_scan()));
-  return ValidateIndexesForTables();
+  return ValidateIndexesForTables(disable_null_filtered_index_check_);
 }
 
 absl::Status IndexHintValidator::VisitResolvedUpdateStmt(
@@ -159,7 +164,7 @@ absl::Status IndexHintValidator::VisitResolvedUpdateStmt(
   ZETASQL_RETURN_IF_ERROR(zetasql::ResolvedASTVisitor::DefaultVisit(stmt));
   // The target table should not have any hints (not allowed by ZetaSQL).
   ZETASQL_RET_CHECK(!index_hints_map_.contains(stmt->table_scan()));
-  return ValidateIndexesForTables();
+  return ValidateIndexesForTables(disable_null_filtered_index_check_);
 }
 
 absl::Status IndexHintValidator::VisitResolvedDeleteStmt(
@@ -168,7 +173,7 @@ absl::Status IndexHintValidator::VisitResolvedDeleteStmt(
   ZETASQL_RETURN_IF_ERROR(zetasql::ResolvedASTVisitor::DefaultVisit(stmt));
   // The target table should not have any hints (not allowed by ZetaSQL).
   ZETASQL_RET_CHECK(!index_hints_map_.contains(stmt->table_scan()));
-  return ValidateIndexesForTables();
+  return ValidateIndexesForTables(disable_null_filtered_index_check_);
 }
 
 }  // namespace backend
@@ -37,6 +37,15 @@ class IndexHintValidator : public zetasql::ResolvedASTVisitor {
       : schema_(schema),
         disable_null_filtered_index_check_(disable_null_filtered_index_check) {}
 
+  // Collects the 'force_index' hint specified on `table_scan`, if any. Allows
+  // another visitor to collect the hints while walking the tree instead of
+  // walking it again with this one.
+  absl::Status CollectIndexHint(const zetasql::ResolvedTableScan* table_scan);
+
+  // Validates that all the collected index hints can be applied to serving the
+  // tables.
+  absl::Status ValidateIndexesForTables(bool disable_null_filtered_index_check);
+
  private:
   absl::Status VisitResolvedQueryStmt(
       const zetasql::ResolvedQueryStmt* stmt) final;
@@ -50,10 +59,6 @@ class IndexHintValidator : public zetasql::ResolvedASTVisitor {
   absl::Status VisitResolvedDeleteStmt(
       const zetasql::ResolvedDeleteStmt* stmt) final;
 
-  // Validates that all the index hints used in the query can be applied to
-  // serving the tables.
-  absl::Status ValidateIndexesForTables();
-
   // To collect the 'force_index' hints from all table scans.
   absl::Status VisitResolvedTableScan(
       const zetasql::ResolvedTableScan* scan) final;
@@ -36,8 +36,10 @@ class PartitionabilityValidator : public zetasql::ResolvedASTVisitor {
   explicit PartitionabilityValidator(const Schema* schema) : schema_(schema) {}
 
   absl::Status DefaultVisit(const zetasql::ResolvedNode* node) override {
+    // The query statement is validated by inspecting its subtree directly, so
+    // there is no need to visit its descendants as well.
     if (node->node_kind() == zetasql::RESOLVED_QUERY_STMT) {
-      ZETASQL_RETURN_IF_ERROR(ValidatePartitionability(node));
+      return ValidatePartitionability(node);
     }
     return zetasql::ResolvedASTVisitor::DefaultVisit(node);
   }
@@ -16,6 +16,8 @@
 
 #include "backend/query/query_engine.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
@@ -25,6 +27,7 @@
 #include "zetasql/public/catalog.h"
 #include "zetasql/public/evaluator.h"
 #include "zetasql/public/evaluator_table_iterator.h"
+#include "zetasql/public/function.h"
 #include "zetasql/public/language_options.h"
 #include "zetasql/public/options.pb.h"
 #include "zetasql/public/parse_helpers.h"
@@ -36,20 +39,24 @@
 #include "absl/status/status.h"
 #include "zetasql/base/statusor.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "backend/access/read.h"
 #include "backend/access/write.h"
 #include "backend/common/case.h"
+#include "backend/common/memory_tracker.h"
+#include "backend/datamodel/key.h"
 #include "backend/datamodel/value.h"
 #include "backend/query/analyzer_options.h"
 #include "backend/query/catalog.h"
-#include "backend/query/feature_filter/query_size_limits_checker.h"
-#include "backend/query/hint_rewriter.h"
-#include "backend/query/index_hint_validator.h"
+#include "backend/query/dml_column_pruning.h"
 #include "backend/query/partitionability_validator.h"
 #include "backend/query/partitioned_dml_validator.h"
 #include "backend/query/query_engine_options.h"
+#include "backend/query/query_result_cache.h"
 #include "backend/query/query_validator.h"
+#include "backend/query/top_n.h"
+#include "common/config.h"
 #include "common/constants.h"
 #include "common/errors.h"
 #include "common/limits.h"
@@ -73,47 +80,87 @@ bool IsDMLQuery(const std::string& query) {
 
 namespace {
 
-// A RowCursor backed by vectors (one per each row) of values.
+// A RowCursor backed by the materialized rows of a query result, which may be
+// shared with the query result cache.
 class VectorsRowCursor : public RowCursor {
  public:
-  VectorsRowCursor(
-      const std::vector<std::string> column_names,
-      const std::vector<const zetasql::Type*> column_types,
-      const std::vector<std::vector<zetasql::Value>> column_values)
-      : column_names_(column_names),
-        column_types_(column_types),
-        column_values_(column_values) {
-    assert(column_names_.size() == column_types_.size());
-    for (int i = 0; i < column_values.size(); ++i) {
-      assert(column_names_.size() == column_values[i].size());
+  explicit VectorsRowCursor(std::shared_ptr<const QueryResultRows> result)
+      : result_(std::move(result)) {
+    assert(result_->column_names.size() == result_->column_types.size());
+    for (const auto& row : result_->rows) {
+      assert(result_->column_names.size() == row.size());
     }
   }
 
-  bool Next() override { return ++row_index_ < column_values_.size(); }
+  bool Next() override { return ++row_index_ < result_->rows.size(); }
 
   absl::Status Status() const override { return absl::OkStatus(); }
 
-  int NumColumns() const override { return column_names_.size(); }
+  int NumColumns() const override { return result_->column_names.size(); }
 
   const std::string ColumnName(int i) const override {
-    return column_names_[i];
+    return result_->column_names[i];
   }
 
   const zetasql::Type* ColumnType(int i) const override {
-    return column_types_[i];
+    return result_->column_types[i];
   }
 
   const zetasql::Value ColumnValue(int i) const override {
-    return column_values_[row_index_][i];
+    return result_->rows[row_index_][i];
   }
 
  private:
   size_t row_index_ = -1;
-  std::vector<std::string> column_names_;
-  std::vector<const zetasql::Type*> column_types_;
-  std::vector<std::vector<zetasql::Value>> column_values_;
+  std::shared_ptr<const QueryResultRows> result_;
 };
 
+// Returns true if the result of the given resolved AST only depends on the data
+// it reads, i.e. it does not call functions such as CURRENT_TIMESTAMP() or
+// RAND() whose results change from one evaluation to the next.
+bool IsDeterministic(const zetasql::ResolvedNode* node) {
+  switch (node->node_kind()) {
+    case zetasql::RESOLVED_FUNCTION_CALL:
+    case zetasql::RESOLVED_AGGREGATE_FUNCTION_CALL:
+    case zetasql::RESOLVED_ANALYTIC_FUNCTION_CALL:
+      if (node->GetAs<zetasql::ResolvedFunctionCallBase>()
+              ->function()
+              ->function_options()
+              .volatility != zetasql::FunctionEnums::IMMUTABLE) {
+        return false;
+      }
+      break;
+    default:
+      break;
+  }
+  std::vector<const zetasql::ResolvedNode*> child_nodes;
+  node->GetChildNodes(&child_nodes);
+  for (const zetasql::ResolvedNode* child_node : child_nodes) {
+    if (!IsDeterministic(child_node)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the key identifying the results of 'query' reading the snapshot of
+// 'context' in the query result cache. The schema is identified by its
+// generation rather than its address, which could be reused by a later schema
+// once the schema it belonged to is destroyed.
+std::string ResultCacheKey(const Query& query, const QueryContext& context) {
+  std::string key = absl::StrCat(
+      query.sql.size(), ":", query.sql, "\n", context.schema->generation(),
+      "\n", absl::ToUnixNanos(*context.snapshot_timestamp));
+  for (const auto& [name, value] : query.declared_params) {
+    absl::StrAppend(&key, "\n", name, ":", value.type()->DebugString(), ":",
+                    value.DebugString());
+  }
+  for (const auto& [name, value] : query.undeclared_params) {
+    absl::StrAppend(&key, "\n", name, "=", value.ShortDebugString());
+  }
+  return key;
+}
+
 zetasql::EvaluatorOptions CommonEvaluatorOptions(
     zetasql::TypeFactory* type_factory) {
   zetasql::EvaluatorOptions options;
@@ -177,11 +224,87 @@ absl::Status MaybeTransformZetaSQLDMLError(absl::Status error) {
   return error;
 }
 
-// Builds a INSERT mutation and returns it along with a count of inserted rows.
-std::pair<Mutation, int64_t> BuildInsert(
+// Maximum number of rows a DML statement hands to its RowWriter at a time.
+constexpr int64_t kMaxRowsPerDmlWrite = 1000;
+
+// Writes the rows modified by a DML statement to a RowWriter in batches of at
+// most kMaxRowsPerDmlWrite rows, so that the rows held by the query engine stay
+// bounded regardless of how many rows the statement modifies.
+class DmlRowBatcher {
+ public:
+  DmlRowBatcher(RowWriter* writer, MutationOpType op_type,
+                const std::string& table_name,
+                std::vector<std::string> column_names = {})
+      : writer_(writer),
+        op_type_(op_type),
+        table_name_(table_name),
+        column_names_(std::move(column_names)) {}
+
+  // Adds a row to an INSERT or UPDATE statement.
+  absl::Status AddRow(ValueList row) {
+    rows_.push_back(std::move(row));
+    return MaybeFlush();
+  }
+
+  // Adds the key of a row to a DELETE statement.
+  absl::Status AddKey(Key key) {
+    key_set_.AddKey(std::move(key));
+    return MaybeFlush();
+  }
+
+  // Writes the remaining rows and completes the statement. Returns the number
+  // of rows modified by the statement.
+  zetasql_base::StatusOr<int64_t> Finish() {
+    if (num_pending_ > 0) {
+      ZETASQL_RETURN_IF_ERROR(Flush());
+    }
+    ZETASQL_RETURN_IF_ERROR(writer_->FinishStatement());
+    return num_rows_;
+  }
+
+ private:
+  absl::Status MaybeFlush() {
+    ++num_rows_;
+    if (++num_pending_ < kMaxRowsPerDmlWrite) {
+      return absl::OkStatus();
+    }
+    return Flush();
+  }
+
+  absl::Status Flush() {
+    Mutation mutation;
+    if (op_type_ == MutationOpType::kDelete) {
+      mutation.AddDeleteOp(table_name_, key_set_);
+      key_set_ = KeySet();
+    } else {
+      mutation.AddWriteOp(op_type_, table_name_, column_names_,
+                          std::move(rows_));
+      rows_.clear();
+    }
+    num_pending_ = 0;
+    return writer_->WritePartial(mutation);
+  }
+
+  RowWriter* writer_;
+  const MutationOpType op_type_;
+  const std::string table_name_;
+  const std::vector<std::string> column_names_;
+
+  // Rows (or keys, for deletes) not yet handed to the writer.
+  std::vector<ValueList> rows_;
+  KeySet key_set_;
+  int64_t num_pending_ = 0;
+
+  // Total number of rows modified by the statement.
+  int64_t num_rows_ = 0;
+};
+
+// Writes the rows produced by an INSERT statement to the writer and returns
+// the count of inserted rows.
+zetasql_base::StatusOr<int64_t> BuildInsert(
     std::unique_ptr<zetasql::EvaluatorTableModifyIterator> iterator,
-    MutationOpType op_type,
-    const CaseInsensitiveStringSet& pending_ts_columns) {
+    MutationOpType op_type, const CaseInsensitiveStringSet& pending_ts_columns,
+    RowWriter* writer) {
   const zetasql::Table* table = iterator->table();
   std::vector<std::string> column_names;
   column_names.reserve(table->NumColumns());
@@ -189,80 +312,88 @@ std::pair<Mutation, int64_t> BuildInsert(
     column_names.push_back(table->GetColumn(i)->Name());
   }
 
-  std::vector<ValueList> values;
+  DmlRowBatcher batcher(writer, op_type, table->Name(), column_names);
   while (iterator->NextRow()) {
-    values.emplace_back();
+    ValueList values;
+    values.reserve(table->NumColumns());
     for (int i = 0; i < table->NumColumns(); ++i) {
       if (pending_ts_columns.find(column_names[i]) !=
           pending_ts_columns.end()) {
-        values.back().push_back(
+        values.push_back(
             zetasql::Value::StringValue(kCommitTimestampIdentifier));
       } else {
-        values.back().push_back(iterator->GetColumnValue(i));
+        values.push_back(iterator->GetColumnValue(i));
       }
     }
+    ZETASQL_RETURN_IF_ERROR(batcher.AddRow(std::move(values)));
   }
-
-  Mutation mutation;
-  mutation.AddWriteOp(op_type, table->Name(), column_names, values);
-  return std::make_pair(mutation, values.size());
+  return batcher.Finish();
 }
 
-// Builds a UPDATE mutation and returns it along with a count of updated rows.
-std::pair<Mutation, int64_t> BuildUpdate(
+// Writes the rows produced by an UPDATE statement to the writer and returns
+// the count of updated rows. Only the primary key and assigned columns are
+// written, so that unchanged columns are neither rewritten nor trigger index
+// maintenance.
+zetasql_base::StatusOr<int64_t> BuildUpdate(
     std::unique_ptr<zetasql::EvaluatorTableModifyIterator> iterator,
-    MutationOpType op_type,
-    const CaseInsensitiveStringSet& pending_ts_columns) {
+    MutationOpType op_type, const CaseInsensitiveStringSet& assigned_columns,
+    const CaseInsensitiveStringSet& pending_ts_columns, RowWriter* writer) {
   const zetasql::Table* table = iterator->table();
+  std::vector<int> column_indexes;
   std::vector<std::string> column_names;
-  column_names.reserve(table->NumColumns());
+  const std::vector<int> primary_key =
+      table->PrimaryKey().value_or(std::vector<int>());
   for (int i = 0; i < table->NumColumns(); ++i) {
-    column_names.push_back(table->GetColumn(i)->Name());
+    const std::string& name = table->GetColumn(i)->Name();
+    if (assigned_columns.contains(name) ||
+        std::find(primary_key.begin(), primary_key.end(), i) !=
+            primary_key.end()) {
+      column_indexes.push_back(i);
+      column_names.push_back(name);
+    }
   }
 
-  std::vector<ValueList> values;
+  DmlRowBatcher batcher(writer, op_type, table->Name(), column_names);
   while (iterator->NextRow()) {
-    values.emplace_back();
-    for (int i = 0; i < table->NumColumns(); ++i) {
+    ValueList values;
+    values.reserve(column_indexes.size());
+    for (int i = 0; i < column_indexes.size(); ++i) {
       if (pending_ts_columns.find(column_names[i]) !=
           pending_ts_columns.end()) {
-        values.back().push_back(
+        values.push_back(
             zetasql::Value::StringValue(kCommitTimestampIdentifier));
       } else {
-        values.back().push_back(iterator->GetColumnValue(i));
+        values.push_back(iterator->GetColumnValue(column_indexes[i]));
       }
     }
+    ZETASQL_RETURN_IF_ERROR(batcher.AddRow(std::move(values)));
   }
-
-  Mutation mutation;
-  mutation.AddWriteOp(op_type, table->Name(), column_names, values);
-  return std::make_pair(mutation, values.size());
+  return batcher.Finish();
 }
 
-// Builds a DELETE mutation and returns it along with a count of deleted rows.
-std::pair<Mutation, int64_t> BuildDelete(
-    std::unique_ptr<zetasql::EvaluatorTableModifyIterator> iterator) {
+// Writes the keys of the rows deleted by a DELETE statement to the writer and
+// returns the count of deleted rows.
+zetasql_base::StatusOr<int64_t> BuildDelete(
+    std::unique_ptr<zetasql::EvaluatorTableModifyIterator> iterator,
+    RowWriter* writer) {
   const zetasql::Table* table = iterator->table();
 
-  KeySet key_set;
+  DmlRowBatcher batcher(writer, MutationOpType::kDelete, table->Name());
   if (!table->PrimaryKey().has_value() && iterator->NextRow()) {
     // There is no primary key in the case of a singleton table. Delete
     // mutation will contain an empty key set in such a case if there is a row
     // to be deleted.
-    key_set.AddKey(Key{});
+    ZETASQL_RETURN_IF_ERROR(batcher.AddKey(Key{}));
   } else {
     while (iterator->NextRow()) {
       ValueList key_values;
       for (int i = 0; i < table->PrimaryKey()->size(); ++i) {
         key_values.push_back(iterator->GetOriginalKeyValue(i));
       }
-      key_set.AddKey(Key{key_values});
+      ZETASQL_RETURN_IF_ERROR(batcher.AddKey(Key{key_values}));
     }
   }
-
-  Mutation mutation;
-  mutation.AddDeleteOp(table->Name(), key_set);
-  return std::make_pair(mutation, key_set.keys().size());
+  return batcher.Finish();
 }
 
 // Returns true if the ResolvedDMLValue is a call to PENDING_COMMIT_TIMESTAMP()
@@ -322,43 +453,50 @@ zetasql_base::StatusOr<CaseInsensitiveStringSet> PendingCommitTimestampColumnsIn
   return pending_ts_columns;
 }
 
-zetasql_base::StatusOr<std::pair<Mutation, int64_t>> EvaluateResolvedInsert(
+// Returns the names of the columns assigned by an UPDATE statement.
+zetasql_base::StatusOr<CaseInsensitiveStringSet> AssignedColumnsInUpdate(
+    const std::vector<std::unique_ptr<const zetasql::ResolvedUpdateItem>>&
+        update_item_list) {
+  CaseInsensitiveStringSet assigned_columns;
+  for (const auto& update_item : update_item_list) {
+    ZETASQL_RET_CHECK_EQ(update_item->target()->node_kind(),
+                 zetasql::RESOLVED_COLUMN_REF);
+    assigned_columns.insert(update_item->target()
+                                ->GetAs<zetasql::ResolvedColumnRef>()
+                                ->column()
+                                .name());
+  }
+  return assigned_columns;
+}
+
+zetasql_base::StatusOr<int64_t> EvaluateResolvedInsert(
     const zetasql::ResolvedInsertStmt* insert_statement,
-    const zetasql::ParameterValueMap& parameters,
-    zetasql::TypeFactory* type_factory) {
+    zetasql::PreparedModify* prepared_insert,
+    const zetasql::ParameterValueMap& parameters, RowWriter* writer) {
   ZETASQL_ASSIGN_OR_RETURN(auto pending_ts_columns,
                    PendingCommitTimestampColumnsInInsert(
                        insert_statement->insert_column_list(),
                        insert_statement->row_list()));
 
-  auto prepared_insert = absl::make_unique<zetasql::PreparedModify>(
-      insert_statement, CommonEvaluatorOptions(type_factory));
-  ZETASQL_ASSIGN_OR_RETURN(auto analyzer_options,
-                   MakeAnalyzerOptionsWithParameters(parameters));
-  ZETASQL_RETURN_IF_ERROR(prepared_insert->Prepare(analyzer_options));
-
   auto status_or = prepared_insert->Execute(parameters);
   if (!status_or.ok()) {
     return MaybeTransformZetaSQLDMLError(status_or.status());
   }
   auto iterator = std::move(status_or).ValueOrDie();
   return BuildInsert(std::move(iterator), MutationOpType::kInsert,
-                     pending_ts_columns);
+                     pending_ts_columns, writer);
 }
 
-zetasql_base::StatusOr<std::pair<Mutation, int64_t>> EvaluateResolvedUpdate(
+zetasql_base::StatusOr<int64_t> EvaluateResolvedUpdate(
     const zetasql::ResolvedUpdateStmt* update_statement,
-    const zetasql::ParameterValueMap& parameters,
-    zetasql::TypeFactory* type_factory) {
+    zetasql::PreparedModify* prepared_update,
+    const zetasql::ParameterValueMap& parameters, RowWriter* writer) {
   ZETASQL_ASSIGN_OR_RETURN(auto pending_ts_columns,
                    PendingCommitTimestampColumnsInUpdate(
                        update_statement->update_item_list()));
-
-  auto prepared_update = absl::make_unique<zetasql::PreparedModify>(
-      update_statement, CommonEvaluatorOptions(type_factory));
-  ZETASQL_ASSIGN_OR_RETURN(auto analyzer_options,
-                   MakeAnalyzerOptionsWithParameters(parameters));
-  ZETASQL_RETURN_IF_ERROR(prepared_update->Prepare(analyzer_options));
+  ZETASQL_ASSIGN_OR_RETURN(
+      auto assigned_columns,
+      AssignedColumnsInUpdate(update_statement->update_item_list()));
 
   auto status_or = prepared_update->Execute(parameters);
   if (!status_or.ok()) {
@@ -366,42 +504,49 @@ zetasql_base::StatusOr<std::pair<Mutation, int64_t>> EvaluateResolvedUpdate(
   }
   auto iterator = std::move(status_or).ValueOrDie();
   return BuildUpdate(std::move(iterator), MutationOpType::kUpdate,
-                     pending_ts_columns);
+                     assigned_columns, pending_ts_columns, writer);
+}
+
+zetasql_base::StatusOr<int64_t> EvaluateResolvedDelete(
+    zetasql::PreparedModify* prepared_delete,
+    const zetasql::ParameterValueMap& parameters, RowWriter* writer) {
+  ZETASQL_ASSIGN_OR_RETURN(auto iterator, prepared_delete->Execute(parameters));
+  return BuildDelete(std::move(iterator), writer);
 }
 
-zetasql_base::StatusOr<std::pair<Mutation, int64_t>> EvaluateResolvedDelete(
-    const zetasql::ResolvedDeleteStmt* delete_statement,
+// Prepares a DML statement represented by a resolved AST for evaluation. The
+// prepared statement can be evaluated against any parameters with the same
+// types as the given ones.
+zetasql_base::StatusOr<std::unique_ptr<zetasql::PreparedModify>> PrepareUpdate(
+    const zetasql::ResolvedStatement* resolved_statement,
     const zetasql::ParameterValueMap& parameters,
     zetasql::TypeFactory* type_factory) {
-  auto prepared_delete = absl::make_unique<zetasql::PreparedModify>(
-      delete_statement, CommonEvaluatorOptions(type_factory));
+  auto prepared_modify = absl::make_unique<zetasql::PreparedModify>(
+      resolved_statement, CommonEvaluatorOptions(type_factory));
   ZETASQL_ASSIGN_OR_RETURN(auto analyzer_options,
                    MakeAnalyzerOptionsWithParameters(parameters));
-  ZETASQL_RETURN_IF_ERROR(prepared_delete->Prepare(analyzer_options));
-
-  ZETASQL_ASSIGN_OR_RETURN(auto iterator, prepared_delete->Execute(parameters));
-  return BuildDelete(std::move(iterator));
+  ZETASQL_RETURN_IF_ERROR(prepared_modify->Prepare(analyzer_options));
+  return prepared_modify;
 }
 
-// Uses googlesql/public/evaluator to evaluate a DML statement represented by a
-// resolved AST and returns a pair of mutation and count of modified rows.
-zetasql_base::StatusOr<std::pair<Mutation, int64_t>> EvaluateUpdate(
+// Uses googlesql/public/evaluator to evaluate a prepared DML statement
+// represented by a resolved AST, writes the modified rows to the writer and
+// returns the count of modified rows.
+zetasql_base::StatusOr<int64_t> EvaluateUpdate(
     const zetasql::ResolvedStatement* resolved_statement,
-    const zetasql::ParameterValueMap& parameters,
-    zetasql::TypeFactory* type_factory) {
+    zetasql::PreparedModify* prepared_modify,
+    const zetasql::ParameterValueMap& parameters, RowWriter* writer) {
   switch (resolved_statement->node_kind()) {
     case zetasql::RESOLVED_INSERT_STMT:
       return EvaluateResolvedInsert(
           resolved_statement->GetAs<zetasql::ResolvedInsertStmt>(),
-          parameters, type_factory);
+          prepared_modify, parameters, writer);
     case zetasql::RESOLVED_UPDATE_STMT:
       return EvaluateResolvedUpdate(
           resolved_statement->GetAs<zetasql::ResolvedUpdateStmt>(),
-          parameters, type_factory);
+          prepared_modify, parameters, writer);
     case zetasql::RESOLVED_DELETE_STMT:
-      return EvaluateResolvedDelete(
-          resolved_statement->GetAs<zetasql::ResolvedDeleteStmt>(),
-          parameters, type_factory);
+      return EvaluateResolvedDelete(prepared_modify, parameters, writer);
     default:
       ZETASQL_RET_CHECK_FAIL() << "Unsupported support node kind "
                        << ResolvedNodeKind_Name(
@@ -411,17 +556,35 @@ zetasql_base::StatusOr<std::pair<Mutation, int64_t>> EvaluateUpdate(
 }
 
 // Uses googlesql/public/evaluator to evaluate a query statement represented by
-// a resolved AST and returns a row cursor.
-zetasql_base::StatusOr<std::unique_ptr<RowCursor>> EvaluateQuery(
+// a resolved AST and returns its materialized rows. If max_memory_bytes is
+// positive, the evaluator's intermediate state (e.g. for sorts and
+// aggregations) and the materialized result rows are each limited to that many
+// bytes, and the query fails with RESOURCE_EXHAUSTED if it needs more.
+zetasql_base::StatusOr<std::shared_ptr<const QueryResultRows>> EvaluateQuery(
     const zetasql::ResolvedStatement* resolved_statement,
     const zetasql::ParameterValueMap& params,
-    zetasql::TypeFactory* type_factory, int64_t* num_output_rows) {
+    zetasql::TypeFactory* type_factory, MemoryTracker* memory_tracker,
+    int64_t max_memory_bytes) {
   ZETASQL_RET_CHECK_EQ(resolved_statement->node_kind(), zetasql::RESOLVED_QUERY_STMT)
       << "input is not a query statement";
 
+  const auto* query_statement =
+      resolved_statement->GetAs<zetasql::ResolvedQueryStmt>();
+
+  // ORDER BY ... LIMIT queries keep only the rows they return while the rows
+  // to be ordered stream by, instead of sorting all of them.
+  ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<TopNPlan> top_n_plan,
+                   MakeTopNPlan(query_statement, params));
+
+  zetasql::EvaluatorOptions evaluator_options =
+      CommonEvaluatorOptions(type_factory);
+  if (max_memory_bytes > 0) {
+    evaluator_options.max_intermediate_byte_size = max_memory_bytes;
+  }
   auto prepared_query = absl::make_unique<zetasql::PreparedQuery>(
-      resolved_statement->GetAs<zetasql::ResolvedQueryStmt>(),
-      CommonEvaluatorOptions(type_factory));
+      top_n_plan != nullptr ? top_n_plan->input_statement.get()
+                            : query_statement,
+      evaluator_options);
   // Call PrepareQuery to set the AnalyzerOptions that we used to Analyze the
   // statement.
   ZETASQL_ASSIGN_OR_RETURN(auto analyzer_options,
@@ -430,23 +593,43 @@ zetasql_base::StatusOr<std::unique_ptr<RowCursor>> EvaluateQuery(
   // Finally execute the query.
   ZETASQL_ASSIGN_OR_RETURN(auto iterator, prepared_query->Execute(params));
 
-  std::vector<std::vector<zetasql::Value>> values;
+  // Account the materialized rows against the database for as long as the
+  // result is alive, so that runaway queries fail instead of exhausting memory.
+  auto result = std::make_shared<QueryResultRows>();
+  result->memory = absl::make_unique<MemoryTracker>(
+      "query results", max_memory_bytes, memory_tracker);
+  if (top_n_plan != nullptr) {
+    TopNCollector collector(top_n_plan.get(), result->memory.get());
+    while (iterator->NextRow()) {
+      std::vector<zetasql::Value> row;
+      row.reserve(iterator->NumColumns());
+      for (int i = 0; i < iterator->NumColumns(); ++i) {
+        row.push_back(iterator->GetValue(i));
+      }
+      ZETASQL_RETURN_IF_ERROR(collector.Add(std::move(row)));
+    }
+    ZETASQL_RETURN_IF_ERROR(iterator->Status());
+    ZETASQL_ASSIGN_OR_RETURN(result->rows, collector.Finish());
+    result->column_names = top_n_plan->output_names;
+    result->column_types = top_n_plan->output_types;
+    return result;
+  }
+
   while (iterator->NextRow()) {
-    values.emplace_back();
-    values.back().reserve(iterator->NumColumns());
+    result->rows.emplace_back();
+    result->rows.back().reserve(iterator->NumColumns());
     for (int i = 0; i < iterator->NumColumns(); ++i) {
-      values.back().push_back(iterator->GetValue(i));
+      result->rows.back().push_back(iterator->GetValue(i));
     }
+    ZETASQL_RETURN_IF_ERROR(result->memory->TryAllocate(
+        EstimateSizeInBytes(Key(), result->rows.back())));
   }
   ZETASQL_RETURN_IF_ERROR(iterator->Status());
-  *num_output_rows = values.size();
-  std::vector<std::string> names;
-  std::vector<const zetasql::Type*> types;
   for (int i = 0; i < iterator->NumColumns(); ++i) {
-    names.push_back(iterator->GetColumnName(i));
-    types.push_back(iterator->GetColumnType(i));
+    result->column_names.push_back(iterator->GetColumnName(i));
+    result->column_types.push_back(iterator->GetColumnType(i));
   }
-  return absl::make_unique<VectorsRowCursor>(names, types, values);
+  return result;
 }
 
 zetasql_base::StatusOr<std::map<std::string, zetasql::Value>> ExtractParameters(
@@ -496,37 +679,25 @@ zetasql_base::StatusOr<std::map<std::string, zetasql::Value>> ExtractParameters(
   return params;
 }
 
-zetasql_base::StatusOr<std::unique_ptr<zetasql::ResolvedStatement>>
+// Validates the statement analyzed into `analyzer_output` in a single walk of
+// its resolved AST, and returns it. The statement remains owned by
+// `analyzer_output`. Hints without a qualifier are treated as 'spanner' hints.
+zetasql_base::StatusOr<const zetasql::ResolvedStatement*>
 ExtractValidatedResolvedStatementAndOptions(
     const zetasql::AnalyzerOutput* analyzer_output, const Schema* schema,
     QueryEngineOptions* query_engine_options = nullptr) {
-  ZETASQL_RET_CHECK_NE(analyzer_output->resolved_statement(), nullptr);
-
-  // Rewrite query hints to use only the 'spanner' prefix.
-  HintRewriter rewriter;
-  ZETASQL_RETURN_IF_ERROR(analyzer_output->resolved_statement()->Accept(&rewriter));
-  ZETASQL_ASSIGN_OR_RETURN(auto statement,
-                   rewriter.ConsumeRootNode<zetasql::ResolvedStatement>());
+  const zetasql::ResolvedStatement* statement =
+      analyzer_output->resolved_statement();
+  ZETASQL_RET_CHECK_NE(statement, nullptr);
 
-  // Validate the query and extract and return any options specified
-  // through hint if the caller requested them.
+  // Validate the query, its index hints and its size limits, and extract and
+  // return any options specified through hint if the caller requested them.
   QueryEngineOptions options;
   QueryValidator query_validator{schema, &options};
   ZETASQL_RETURN_IF_ERROR(statement->Accept(&query_validator));
   if (query_engine_options != nullptr) {
     *query_engine_options = options;
   }
-
-  // Validate the index hints.
-  IndexHintValidator index_hint_validator{
-      schema, options.disable_query_null_filtered_index_check};
-  ZETASQL_RETURN_IF_ERROR(statement->Accept(&index_hint_validator));
-
-  // Check the query size limits
-  // https://cloud.google.com/spanner/quotas#query_limits
-  QuerySizeLimitsChecker checker;
-  ZETASQL_RETURN_IF_ERROR(checker.CheckQueryAgainstLimits(statement.get()));
-
   return statement;
 }
 
@@ -535,45 +706,127 @@ ExtractValidatedResolvedStatementAndOptions(
 zetasql_base::StatusOr<QueryResult> QueryEngine::ExecuteSql(
     const Query& query, const QueryContext& context) const {
   absl::Time start_time = absl::Now();
-  Catalog catalog{context.schema, &function_catalog_, context.reader};
+  // DML statements are analyzed without pruning unused columns, since the
+  // evaluator produces complete rows for the target table. Columns that DML
+  // does not reference are skipped by the pruning reader instead.
+  const bool is_dml = IsDMLQuery(query.sql);
+
+  // Queries reading an identified snapshot are answered from the result cache
+  // if an identical query read the same snapshot before.
+  std::string cache_key;
+  if (result_cache_ != nullptr && context.snapshot_timestamp.has_value() &&
+      !is_dml) {
+    cache_key = ResultCacheKey(query, context);
+    if (std::shared_ptr<const QueryResultRows> rows =
+            result_cache_->Lookup(cache_key);
+        rows != nullptr) {
+      QueryResult result;
+      result.num_output_rows = rows->rows.size();
+      result.rows = absl::make_unique<VectorsRowCursor>(std::move(rows));
+      result.elapsed_time = absl::Now() - start_time;
+      return result;
+    }
+  }
+
+  PruningRowReader pruning_reader(context.reader);
+  Catalog catalog{context.schema, &function_catalog_,
+                  context.reader != nullptr ? &pruning_reader : nullptr,
+                  storage_, memory_tracker_, admission_controller_,
+                  result_cache_.get()};
   ZETASQL_ASSIGN_OR_RETURN(auto analyzer_output,
                    Analyze(query.sql, query.declared_params, &catalog,
-                           type_factory_, /*prune_unused_columns=*/true));
+                           type_factory_, /*prune_unused_columns=*/!is_dml));
 
   ZETASQL_ASSIGN_OR_RETURN(auto params,
                    ExtractParameters(query, analyzer_output.get()));
 
+  QueryEngineOptions options;
   ZETASQL_ASSIGN_OR_RETURN(auto resolved_statement,
                    ExtractValidatedResolvedStatementAndOptions(
-                       analyzer_output.get(), context.schema));
+                       analyzer_output.get(), context.schema, &options));
 
   QueryResult result;
   if (analyzer_output->resolved_statement()->node_kind() ==
       zetasql::RESOLVED_QUERY_STMT) {
-    ZETASQL_ASSIGN_OR_RETURN(auto cursor,
-                     EvaluateQuery(resolved_statement.get(), params,
-                                   type_factory_, &result.num_output_rows));
-    result.rows = std::move(cursor);
+    const int64_t max_memory_bytes = options.max_query_memory_bytes > 0
+                                         ? options.max_query_memory_bytes
+                                         : config::max_query_memory_bytes();
+    ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<const QueryResultRows> rows,
+                     EvaluateQuery(resolved_statement, params, type_factory_,
+                                   memory_tracker_, max_memory_bytes));
+    if (!cache_key.empty() && IsDeterministic(resolved_statement) &&
+        !catalog.spanner_sys_accessed()) {
+      result_cache_->Insert(cache_key, rows);
+    }
+    result.num_output_rows = rows->rows.size();
+    result.rows = absl::make_unique<VectorsRowCursor>(std::move(rows));
   } else {
     ZETASQL_RET_CHECK_NE(context.writer, nullptr);
-    ZETASQL_ASSIGN_OR_RETURN(auto analyzer_output,
-                     Analyze(query.sql, query.declared_params, &catalog,
-                             type_factory_, /*prune_unused_columns=*/false));
-    ZETASQL_ASSIGN_OR_RETURN(auto resolved_statement,
-                     ExtractValidatedResolvedStatementAndOptions(
-                         analyzer_output.get(), context.schema));
+    ZETASQL_ASSIGN_OR_RETURN(DmlReadColumns read_columns,
+                     CollectDmlReadColumns(resolved_statement));
+    pruning_reader.Prune(std::move(read_columns));
 
     ZETASQL_ASSIGN_OR_RETURN(
-        const auto& mutation_and_count,
-        EvaluateUpdate(resolved_statement.get(), params, type_factory_));
-    ZETASQL_RETURN_IF_ERROR(context.writer->Write(mutation_and_count.first));
-    result.modified_row_count = static_cast<int64_t>(mutation_and_count.second);
+        auto prepared_modify,
+        PrepareUpdate(resolved_statement, params, type_factory_));
+    ZETASQL_ASSIGN_OR_RETURN(result.modified_row_count,
+                     EvaluateUpdate(resolved_statement,
+                                    prepared_modify.get(), params,
+                                    context.writer));
   }
 
   result.elapsed_time = absl::Now() - start_time;
   return result;
 }
 
+absl::Status QueryEngine::ExecuteBatchDml(
+    const std::vector<Query>& queries, const QueryContext& context,
+    std::vector<QueryResult>* results) const {
+  ZETASQL_RET_CHECK(!queries.empty());
+  ZETASQL_RET_CHECK_NE(context.writer, nullptr);
+  absl::Time start_time = absl::Now();
+  const Query& first_query = queries.front();
+  PruningRowReader pruning_reader(context.reader);
+  Catalog catalog{context.schema, &function_catalog_,
+                  context.reader != nullptr ? &pruning_reader : nullptr};
+  ZETASQL_ASSIGN_OR_RETURN(auto analyzer_output,
+                   Analyze(first_query.sql, first_query.declared_params,
+                           &catalog, type_factory_,
+                           /*prune_unused_columns=*/false));
+  ZETASQL_ASSIGN_OR_RETURN(auto resolved_statement,
+                   ExtractValidatedResolvedStatementAndOptions(
+                       analyzer_output.get(), context.schema));
+  ZETASQL_RET_CHECK_NE(resolved_statement->node_kind(),
+               zetasql::RESOLVED_QUERY_STMT);
+  ZETASQL_ASSIGN_OR_RETURN(DmlReadColumns read_columns,
+                   CollectDmlReadColumns(resolved_statement));
+  pruning_reader.Prune(std::move(read_columns));
+
+  // The statement is prepared with the parameters of the first query, which
+  // have the same types as the parameters of every other query in the batch.
+  std::unique_ptr<zetasql::PreparedModify> prepared_modify;
+  for (const Query& query : queries) {
+    ZETASQL_ASSIGN_OR_RETURN(auto params,
+                     ExtractParameters(query, analyzer_output.get()));
+    if (prepared_modify == nullptr) {
+      ZETASQL_ASSIGN_OR_RETURN(
+          prepared_modify,
+          PrepareUpdate(resolved_statement, params, type_factory_));
+    }
+
+    QueryResult result;
+    ZETASQL_ASSIGN_OR_RETURN(result.modified_row_count,
+                     EvaluateUpdate(resolved_statement,
+                                    prepared_modify.get(), params,
+                                    context.writer));
+    const absl::Time end_time = absl::Now();
+    result.elapsed_time = end_time - start_time;
+    start_time = end_time;
+    results->push_back(std::move(result));
+  }
+  return absl::OkStatus();
+}
+
 absl::Status QueryEngine::IsPartitionable(const Query& query,
                                           const QueryContext& context) const {
   Catalog catalog{context.schema, &function_catalog_, context.reader};
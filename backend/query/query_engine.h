@@ -19,16 +19,23 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "google/protobuf/struct.pb.h"
 #include "zetasql/public/type.h"
 #include "zetasql/public/value.h"
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "absl/types/optional.h"
 #include "backend/access/read.h"
 #include "backend/access/write.h"
+#include "backend/common/admission_controller.h"
+#include "backend/common/memory_tracker.h"
 #include "backend/query/function_catalog.h"
+#include "backend/query/query_result_cache.h"
 #include "backend/schema/catalog/schema.h"
+#include "backend/storage/storage.h"
 #include "absl/status/status.h"
 #include "zetasql/base/statusor.h"
 
@@ -79,19 +86,60 @@ struct QueryContext {
 
   // A writer for writing data for DML requests. Can be null for SELECT queries.
   RowWriter* writer;
+
+  // If set, the reader reads a snapshot of the database which contains all the
+  // commits up to this timestamp and none after it. The results of queries
+  // reading such a snapshot can be cached and reused by later queries reading
+  // the same snapshot.
+  absl::optional<absl::Time> snapshot_timestamp;
 };
 
 // QueryEngine handles SQL-related requests.
 class QueryEngine {
  public:
-  explicit QueryEngine(zetasql::TypeFactory* type_factory)
-      : type_factory_(type_factory), function_catalog_(type_factory) {}
+  // If a MemoryTracker is provided, materialized query results are accounted
+  // against it and queries whose results would exceed its limit fail with
+  // RESOURCE_EXHAUSTED.
+  //
+  // If result_cache_bytes is positive, the results of deterministic queries
+  // reading a snapshot identified by QueryContext::snapshot_timestamp are
+  // cached, up to that many bytes, and reused by identical queries.
+  //
+  // If a Storage is provided, queries can read its table statistics through
+  // the SPANNER_SYS tables, along with the counters of the AdmissionController
+  // if one is provided, and of the result cache if it is enabled.
+  explicit QueryEngine(zetasql::TypeFactory* type_factory,
+                       MemoryTracker* memory_tracker = nullptr,
+                       int64_t result_cache_bytes = 0,
+                       const Storage* storage = nullptr,
+                       const AdmissionController* admission_controller =
+                           nullptr)
+      : type_factory_(type_factory),
+        function_catalog_(type_factory),
+        memory_tracker_(memory_tracker),
+        storage_(storage),
+        admission_controller_(admission_controller),
+        result_cache_(result_cache_bytes > 0
+                          ? absl::make_unique<QueryResultCache>(
+                                result_cache_bytes, memory_tracker)
+                          : nullptr) {}
 
   // Executes a SQL query (SELECT query or DML).
   // Skip execution if validate_only is true.
   zetasql_base::StatusOr<QueryResult> ExecuteSql(const Query& query,
                                          const QueryContext& context) const;
 
+  // Executes a batch of DML statements which share the same SQL text and
+  // parameter types, one statement per query, in order. The statement is
+  // analyzed and prepared once and then evaluated against the parameters of
+  // each query, so each statement observes the writes of the ones before it.
+  // The results of the statements that succeeded are appended to 'results';
+  // execution stops at the first statement that fails, whose error is
+  // returned.
+  absl::Status ExecuteBatchDml(const std::vector<Query>& queries,
+                               const QueryContext& context,
+                               std::vector<QueryResult>* results) const;
+
   // Returns OK if query is partitionable.
   absl::Status IsPartitionable(const Query& query,
                                const QueryContext& context) const;
@@ -103,9 +151,26 @@ class QueryEngine {
 
   zetasql::TypeFactory* type_factory() const { return type_factory_; }
 
+  // Returns the counters of the query result cache, all zero if it is
+  // disabled.
+  QueryResultCacheStats result_cache_stats() const {
+    return result_cache_ != nullptr ? result_cache_->stats()
+                                    : QueryResultCacheStats();
+  }
+
  private:
   zetasql::TypeFactory* type_factory_;
   FunctionCatalog function_catalog_;
+  MemoryTracker* memory_tracker_;
+
+  // Storage whose statistics are exposed in SPANNER_SYS, may be nullptr.
+  const Storage* storage_;
+
+  // Controller whose counters are exposed in SPANNER_SYS, may be nullptr.
+  const AdmissionController* admission_controller_;
+
+  // Cache of query results, null if disabled.
+  std::unique_ptr<QueryResultCache> result_cache_;
 };
 
 }  // namespace backend
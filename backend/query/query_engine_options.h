@@ -17,6 +17,8 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_QUERY_ENGINE_OPTIONS_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_QUERY_ENGINE_OPTIONS_H_
 
+#include <cstdint>
+
 namespace google {
 namespace spanner {
 namespace emulator {
@@ -30,6 +32,10 @@ struct QueryEngineOptions {
   // If true, will disable checks to determine if a NULL_FILTERED index can be
   // used to answer a SQL query.
   bool disable_query_null_filtered_index_check = false;
+
+  // If positive, overrides the --max_query_memory_bytes limit on the bytes a
+  // query may hold in evaluator state and materialized results.
+  int64_t max_query_memory_bytes = 0;
 };
 
 }  // namespace backend
@@ -28,12 +28,19 @@
 #include "absl/memory/memory.h"
 #include "zetasql/base/statusor.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
 #include "backend/access/read.h"
 #include "backend/access/write.h"
+#include "backend/common/admission_controller.h"
+#include "backend/common/memory_tracker.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
 #include "backend/datamodel/key_set.h"
 #include "backend/datamodel/value.h"
 #include "backend/query/catalog.h"
 #include "backend/schema/catalog/schema.h"
+#include "backend/storage/in_memory_storage.h"
 #include "tests/common/row_reader.h"
 #include "tests/common/schema_constructor.h"
 #include "absl/status/status.h"
@@ -52,6 +59,7 @@ using testing::Field;
 using testing::IsTrue;
 using testing::Property;
 using testing::Return;
+using testing::SizeIs;
 using testing::UnorderedElementsAre;
 using zetasql_base::testing::IsOkAndHolds;
 
@@ -105,6 +113,7 @@ class QueryEngineTest : public testing::Test {
   const Schema* multi_table_schema() { return multi_table_schema_.get(); }
   RowReader* reader() { return &reader_; }
   QueryEngine& query_engine() { return query_engine_; }
+  zetasql::TypeFactory* type_factory() { return &type_factory_; }
 
  private:
   zetasql::TypeFactory type_factory_;
@@ -143,6 +152,199 @@ TEST_F(QueryEngineTest, ExecuteSqlSelectsOneFromTable) {
                                ElementsAre(Int64(1)))));
 }
 
+TEST_F(QueryEngineTest, ExecuteSqlOrderByLimitReturnsTopRows) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      QueryResult result,
+      query_engine().ExecuteSql(
+          Query{"SELECT int64_col FROM test_table "
+                "ORDER BY string_col DESC LIMIT 2 OFFSET 1"},
+          QueryContext{schema(), reader()}));
+  ASSERT_NE(result.rows, nullptr);
+  EXPECT_THAT(GetColumnNames(*result.rows), ElementsAre("int64_col"));
+  EXPECT_EQ(result.num_output_rows, 2);
+  // Rows ordered by string_col descending are "two", "one", "four".
+  EXPECT_THAT(GetAllColumnValues(std::move(result.rows)),
+              IsOkAndHolds(ElementsAre(ElementsAre(Int64(1)),
+                                       ElementsAre(Int64(4)))));
+}
+
+TEST_F(QueryEngineTest, ExecuteSqlFailsWhenExceedingQueryMemoryLimit) {
+  EXPECT_THAT(
+      query_engine().ExecuteSql(
+          Query{"@{spanner_emulator.max_query_memory_bytes=1} "
+                "SELECT int64_col, string_col FROM test_table"},
+          QueryContext{schema(), reader()}),
+      zetasql_base::testing::StatusIs(absl::StatusCode::kResourceExhausted));
+
+  ZETASQL_EXPECT_OK(query_engine().ExecuteSql(
+      Query{"@{spanner_emulator.max_query_memory_bytes=1000000} "
+            "SELECT int64_col, string_col FROM test_table"},
+      QueryContext{schema(), reader()}));
+}
+
+TEST_F(QueryEngineTest, ExecuteSqlFailsWhenExceedingQueryJoinLimit) {
+  std::string sql = "SELECT 1 FROM test_table AS t0";
+  for (int i = 1; i <= 16; ++i) {
+    absl::StrAppend(&sql, " CROSS JOIN test_table AS t", i);
+  }
+  EXPECT_THAT(
+      query_engine().ExecuteSql(Query{sql}, QueryContext{schema(), reader()}),
+      zetasql_base::testing::StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST_F(QueryEngineTest, ExecuteSqlReusesCachedResultsForSameSnapshot) {
+  QueryEngine engine(type_factory(), /*memory_tracker=*/nullptr,
+                     /*result_cache_bytes=*/1 << 20);
+  auto context = [&](absl::Time snapshot_timestamp) {
+    return QueryContext{.schema = schema(),
+                        .reader = reader(),
+                        .writer = nullptr,
+                        .snapshot_timestamp = snapshot_timestamp};
+  };
+  const Query query{"SELECT int64_col FROM test_table ORDER BY int64_col"};
+
+  for (int i = 0; i < 2; ++i) {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(QueryResult result,
+                         engine.ExecuteSql(query, context(absl::UnixEpoch())));
+    EXPECT_EQ(result.num_output_rows, 3);
+    EXPECT_THAT(GetAllColumnValues(std::move(result.rows)),
+                IsOkAndHolds(ElementsAre(ElementsAre(Int64(1)),
+                                         ElementsAre(Int64(2)),
+                                         ElementsAre(Int64(4)))));
+  }
+  EXPECT_EQ(engine.result_cache_stats().hits, 1);
+  EXPECT_EQ(engine.result_cache_stats().misses, 1);
+
+  // A different snapshot may contain different data.
+  ZETASQL_EXPECT_OK(engine.ExecuteSql(
+      query, context(absl::UnixEpoch() + absl::Seconds(1))));
+  EXPECT_EQ(engine.result_cache_stats().hits, 1);
+  EXPECT_EQ(engine.result_cache_stats().misses, 2);
+}
+
+TEST_F(QueryEngineTest, ExecuteSqlDoesNotCacheNonDeterministicResults) {
+  QueryEngine engine(type_factory(), /*memory_tracker=*/nullptr,
+                     /*result_cache_bytes=*/1 << 20);
+  const Query query{"SELECT CURRENT_TIMESTAMP() FROM test_table"};
+  const QueryContext context{.schema = schema(),
+                             .reader = reader(),
+                             .writer = nullptr,
+                             .snapshot_timestamp = absl::UnixEpoch()};
+
+  ZETASQL_EXPECT_OK(engine.ExecuteSql(query, context));
+  ZETASQL_EXPECT_OK(engine.ExecuteSql(query, context));
+  EXPECT_EQ(engine.result_cache_stats().hits, 0);
+  EXPECT_EQ(engine.result_cache_stats().entries, 0);
+}
+
+TEST_F(QueryEngineTest, ExecuteSqlReadsTableStatsFromStorage) {
+  InMemoryStorage storage;
+  const Table* table = schema()->FindTable("test_table");
+  for (int i = 0; i < 3; ++i) {
+    ZETASQL_ASSERT_OK(storage.Write(absl::UnixEpoch(), table->id(),
+                            Key({Int64(i)}),
+                            {table->FindColumn("string_col")->id()},
+                            {String(absl::StrCat("value-", i))}));
+  }
+  QueryEngine engine(type_factory(), /*memory_tracker=*/nullptr,
+                     /*result_cache_bytes=*/1 << 20, &storage);
+  const Query query{
+      "SELECT ROW_COUNT FROM SPANNER_SYS.TABLE_STATS "
+      "WHERE TABLE_NAME = 'test_table' AND INDEX_NAME IS NULL"};
+  const QueryContext context{.schema = schema(),
+                             .reader = reader(),
+                             .writer = nullptr,
+                             .snapshot_timestamp = absl::UnixEpoch()};
+
+  for (int i = 0; i < 2; ++i) {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(QueryResult result,
+                         engine.ExecuteSql(query, context));
+    EXPECT_THAT(GetAllColumnValues(std::move(result.rows)),
+                IsOkAndHolds(ElementsAre(ElementsAre(Int64(3)))));
+  }
+  // Statistics are not tied to the snapshot, so their results are not cached.
+  EXPECT_EQ(engine.result_cache_stats().entries, 0);
+}
+
+TEST_F(QueryEngineTest, ExecuteSqlAccountsResultRowsWhileTheyAreHeld) {
+  MemoryTracker database("database", /*limit_bytes=*/0);
+  QueryEngine engine(type_factory(), &database);
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      QueryResult result,
+      engine.ExecuteSql(Query{"SELECT int64_col FROM test_table"},
+                        QueryContext{schema(), reader()}));
+  // Three INT64 rows of 8 bytes each.
+  EXPECT_EQ(database.bytes_used(), 24);
+
+  result.rows.reset();
+  EXPECT_EQ(database.bytes_used(), 0);
+}
+
+TEST_F(QueryEngineTest, ExecuteSqlReadsMemoryUsage) {
+  InMemoryStorage storage;
+  MemoryTracker database("database", /*limit_bytes=*/1000);
+  ZETASQL_ASSERT_OK(database.TryAllocate(100));
+  QueryEngine engine(type_factory(), &database, /*result_cache_bytes=*/0,
+                     &storage);
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      QueryResult result,
+      engine.ExecuteSql(
+          Query{"SELECT RESOURCE_NAME, USED_BYTES, PEAK_USED_BYTES, "
+                "LIMIT_BYTES FROM SPANNER_SYS.MEMORY_USAGE"},
+          QueryContext{schema(), reader()}));
+  EXPECT_THAT(GetAllColumnValues(std::move(result.rows)),
+              IsOkAndHolds(ElementsAre(ElementsAre(
+                  String("database"), Int64(100), Int64(100), Int64(1000)))));
+}
+
+TEST_F(QueryEngineTest, ExecuteSqlReadsRequestAdmission) {
+  InMemoryStorage storage;
+  AdmissionController database("database", {.max_in_flight = 1});
+  ZETASQL_ASSERT_OK(database.Acquire());
+  // The queue holds no requests, so this one is rejected.
+  EXPECT_FALSE(database.Acquire().ok());
+  QueryEngine engine(type_factory(), /*memory_tracker=*/nullptr,
+                     /*result_cache_bytes=*/0, &storage, &database);
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      QueryResult result,
+      engine.ExecuteSql(
+          Query{"SELECT RESOURCE_NAME, IN_FLIGHT_REQUESTS, QUEUED_REQUESTS, "
+                "ADMITTED_REQUESTS, REJECTED_REQUESTS "
+                "FROM SPANNER_SYS.REQUEST_ADMISSION"},
+          QueryContext{schema(), reader()}));
+  EXPECT_THAT(GetAllColumnValues(std::move(result.rows)),
+              IsOkAndHolds(ElementsAre(ElementsAre(String("database"), Int64(1),
+                                                   Int64(0), Int64(1),
+                                                   Int64(1)))));
+  database.Release();
+}
+
+TEST_F(QueryEngineTest, ExecuteSqlReadsQueryResultCacheStats) {
+  InMemoryStorage storage;
+  QueryEngine engine(type_factory(), /*memory_tracker=*/nullptr,
+                     /*result_cache_bytes=*/1 << 20, &storage);
+  const QueryContext context{.schema = schema(),
+                             .reader = reader(),
+                             .writer = nullptr,
+                             .snapshot_timestamp = absl::UnixEpoch()};
+  for (int i = 0; i < 2; ++i) {
+    ZETASQL_EXPECT_OK(
+        engine.ExecuteSql(Query{"SELECT int64_col FROM test_table"}, context));
+  }
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      QueryResult result,
+      engine.ExecuteSql(Query{"SELECT ENTRIES, HITS, MISSES, EVICTIONS "
+                              "FROM SPANNER_SYS.QUERY_RESULT_CACHE"},
+                        QueryContext{schema(), reader()}));
+  EXPECT_THAT(GetAllColumnValues(std::move(result.rows)),
+              IsOkAndHolds(ElementsAre(
+                  ElementsAre(Int64(1), Int64(1), Int64(1), Int64(0)))));
+}
+
 TEST_F(QueryEngineTest, ExecuteSqlSelectsOneColumnFromTable) {
   ZETASQL_ASSERT_OK_AND_ASSIGN(
       QueryResult result,
@@ -391,6 +593,149 @@ TEST_F(QueryEngineTest, ExecuteSqlUpdatesRows) {
               IsOkAndHolds(Field(&QueryResult::modified_row_count, 2)));
 }
 
+TEST_F(QueryEngineTest, ExecuteSqlInsertSelectWritesRowsInBatches) {
+  MockRowWriter writer;
+  EXPECT_CALL(writer, Write(Property(&Mutation::ops,
+                                     ElementsAre(Field(&MutationOp::rows,
+                                                       SizeIs(1000))))))
+      .Times(2)
+      .WillRepeatedly(Return(absl::OkStatus()));
+  EXPECT_CALL(writer, Write(Property(&Mutation::ops,
+                                     ElementsAre(Field(&MutationOp::rows,
+                                                       SizeIs(500))))))
+      .Times(1)
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_THAT(
+      query_engine().ExecuteSql(
+          Query{"INSERT INTO test_table (int64_col) "
+                "SELECT 10 + d * 1000 + h * 100 + t * 10 + u FROM "
+                "UNNEST([0, 1, 2]) AS d, "
+                "UNNEST([0, 1, 2, 3, 4, 5, 6, 7, 8, 9]) AS h, "
+                "UNNEST([0, 1, 2, 3, 4, 5, 6, 7, 8, 9]) AS t, "
+                "UNNEST([0, 1, 2, 3, 4, 5, 6, 7, 8, 9]) AS u "
+                "WHERE d * 1000 + h * 100 + t * 10 + u < 2500"},
+          QueryContext{schema(), reader(), &writer}),
+      IsOkAndHolds(Field(&QueryResult::modified_row_count, 2500)));
+}
+
+// A TestRowReader which records each read.
+class RecordingRowReader : public test::TestRowReader {
+ public:
+  using TestRowReader::TestRowReader;
+
+  absl::Status Read(const ReadArg& read_arg,
+                    std::unique_ptr<RowCursor>* cursor) override {
+    reads_.push_back(read_arg);
+    return TestRowReader::Read(read_arg, cursor);
+  }
+
+  const std::vector<ReadArg>& reads() const { return reads_; }
+
+  // Returns the columns requested by each read.
+  std::vector<std::vector<std::string>> read_columns() const {
+    std::vector<std::vector<std::string>> read_columns;
+    for (const ReadArg& read_arg : reads_) {
+      read_columns.push_back(read_arg.columns);
+    }
+    return read_columns;
+  }
+
+ private:
+  std::vector<ReadArg> reads_;
+};
+
+TEST_F(QueryEngineTest, ExecuteSqlUpdateReadsAndWritesOnlyReferencedColumns) {
+  zetasql::TypeFactory type_factory;
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::unique_ptr<const Schema> schema,
+                       test::CreateSchemaFromDDL({R"(
+                         CREATE TABLE T (
+                           k INT64 NOT NULL,
+                           a STRING(MAX),
+                           b STRING(MAX),
+                           c INT64,
+                         ) PRIMARY KEY (k))"},
+                                                 &type_factory));
+  RecordingRowReader reader{
+      {{"T",
+        {{"k", "a", "b", "c"},
+         {zetasql::types::Int64Type(), zetasql::types::StringType(),
+          zetasql::types::StringType(), zetasql::types::Int64Type()},
+         {{Int64(1), String("x"), String("one"), Int64(10)},
+          {Int64(2), String("y"), String("two"), Int64(20)}}}}}};
+  MockRowWriter writer;
+  EXPECT_CALL(writer,
+              Write(Property(
+                  &Mutation::ops,
+                  ElementsAre(AllOf(
+                      Field(&MutationOp::type, MutationOpType::kUpdate),
+                      Field(&MutationOp::columns,
+                            std::vector<std::string>{"k", "c"}),
+                      Field(&MutationOp::rows,
+                            ElementsAre(ValueList{Int64(2), Int64(21)})))))))
+      .Times(1)
+      .WillOnce(Return(absl::OkStatus()));
+
+  EXPECT_THAT(query_engine().ExecuteSql(
+                  Query{"UPDATE T SET c = c + 1 WHERE a = 'y'"},
+                  QueryContext{schema.get(), &reader, &writer}),
+              IsOkAndHolds(Field(&QueryResult::modified_row_count, 1)));
+  EXPECT_THAT(reader.read_columns(),
+              ElementsAre(UnorderedElementsAre("k", "a", "c")));
+}
+
+TEST_F(QueryEngineTest, ExecuteSqlNarrowsForceIndexScanToIndexKeys) {
+  RecordingRowReader reader{
+      {{"test_table",
+        {{"int64_col", "string_col"},
+         {zetasql::types::Int64Type(), zetasql::types::StringType()},
+         {{Int64(1), String("one")},
+          {Int64(2), String("two")},
+          {Int64(4), String("four")}}}}}};
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      QueryResult result,
+      query_engine().ExecuteSql(
+          Query{"SELECT int64_col FROM test_table@{force_index=test_index} "
+                "WHERE string_col = 'two'"},
+          QueryContext{schema(), &reader}));
+  EXPECT_THAT(GetAllColumnValues(std::move(result.rows)),
+              IsOkAndHolds(ElementsAre(ElementsAre(Int64(2)))));
+
+  // The index is read for the matching keys before the table is read.
+  ASSERT_THAT(reader.reads(), SizeIs(2));
+  EXPECT_EQ(reader.reads()[0].index, "test_index");
+  EXPECT_THAT(reader.reads()[0].key_set.keys(),
+              ElementsAre(Key({String("two")})));
+  EXPECT_EQ(reader.reads()[1].index, "");
+}
+
+TEST_F(QueryEngineTest, ExecuteSqlNarrowsForceIndexScanToIndexKeyRange) {
+  RecordingRowReader reader{
+      {{"test_table",
+        {{"int64_col", "string_col"},
+         {zetasql::types::Int64Type(), zetasql::types::StringType()},
+         {{Int64(1), String("one")},
+          {Int64(2), String("two")},
+          {Int64(4), String("four")}}}}}};
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      QueryResult result,
+      query_engine().ExecuteSql(
+          Query{"SELECT int64_col FROM test_table@{force_index=test_index} "
+                "WHERE string_col >= 'four' AND string_col <= 'one'"},
+          QueryContext{schema(), &reader}));
+  EXPECT_THAT(GetAllColumnValues(std::move(result.rows)),
+              IsOkAndHolds(UnorderedElementsAre(ElementsAre(Int64(1)),
+                                                ElementsAre(Int64(4)))));
+
+  // test_index sorts string_col in descending order.
+  ASSERT_THAT(reader.reads(), SizeIs(2));
+  EXPECT_EQ(reader.reads()[0].index, "test_index");
+  EXPECT_THAT(reader.reads()[0].key_set.keys(), testing::IsEmpty());
+  EXPECT_THAT(reader.reads()[0].key_set.ranges(),
+              ElementsAre(KeyRange::ClosedOpen(
+                  Key({String("one")}),
+                  Key({String("four")}).ToPrefixLimit())));
+}
+
 TEST_F(QueryEngineTest, CannotInsertDuplicateValuesForPrimaryKey) {
   MockRowWriter writer;
   EXPECT_THAT(query_engine().ExecuteSql(
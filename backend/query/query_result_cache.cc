@@ -0,0 +1,93 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/query/query_result_cache.h"
+
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+#include "backend/common/memory_tracker.h"
+#include "backend/datamodel/key.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+std::shared_ptr<const QueryResultRows> QueryResultCache::Lookup(
+    const std::string& key) {
+  absl::MutexLock lock(&mu_);
+  auto itr = index_.find(key);
+  if (itr == index_.end()) {
+    ++stats_.misses;
+    return nullptr;
+  }
+  ++stats_.hits;
+  // Mark the entry as the most recently used one.
+  entries_.splice(entries_.begin(), entries_, itr->second);
+  return itr->second->result;
+}
+
+void QueryResultCache::Insert(const std::string& key,
+                              std::shared_ptr<const QueryResultRows> result) {
+  int64_t rows_bytes = 0;
+  for (const auto& row : result->rows) {
+    rows_bytes += EstimateSizeInBytes(Key(), row);
+  }
+  const int64_t bytes = key.size() + rows_bytes;
+  const int64_t accounted_bytes =
+      result->memory != nullptr ? key.size() : bytes;
+
+  absl::MutexLock lock(&mu_);
+  auto itr = index_.find(key);
+  if (itr != index_.end()) {
+    Remove(itr->second);
+  }
+  if (bytes > max_bytes_) {
+    return;
+  }
+  while (stats_.bytes + bytes > max_bytes_) {
+    Remove(std::prev(entries_.end()));
+    ++stats_.evictions;
+  }
+
+  entries_.push_front(Entry{key, std::move(result), bytes, accounted_bytes});
+  index_[key] = entries_.begin();
+  memory_.Allocate(accounted_bytes);
+  ++stats_.entries;
+  stats_.bytes += bytes;
+}
+
+void QueryResultCache::Remove(Entries::iterator entry) {
+  memory_.Release(entry->accounted_bytes);
+  --stats_.entries;
+  stats_.bytes -= entry->bytes;
+  index_.erase(entry->key);
+  entries_.erase(entry);
+}
+
+QueryResultCacheStats QueryResultCache::stats() const {
+  absl::MutexLock lock(&mu_);
+  return stats_;
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
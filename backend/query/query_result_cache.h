@@ -0,0 +1,136 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_QUERY_RESULT_CACHE_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_QUERY_RESULT_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "backend/common/memory_tracker.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// Counters describing the use of a QueryResultCache.
+struct QueryResultCacheStats {
+  // Number of lookups which found a cached result.
+  int64_t hits = 0;
+
+  // Number of lookups which did not find a cached result.
+  int64_t misses = 0;
+
+  // Number of results evicted to make room for newer ones.
+  int64_t evictions = 0;
+
+  // Number of results currently cached.
+  int64_t entries = 0;
+
+  // Estimated number of bytes held by the cached results.
+  int64_t bytes = 0;
+};
+
+// The materialized rows of a query result.
+struct QueryResultRows {
+  std::vector<std::string> column_names;
+  std::vector<const zetasql::Type*> column_types;
+  std::vector<std::vector<zetasql::Value>> rows;
+
+  // Accounts the bytes held by `rows` for as long as the result is alive, so
+  // that results kept by cursors or the cache count towards the database's
+  // memory. Null if the rows are not accounted.
+  std::unique_ptr<MemoryTracker> memory;
+};
+
+// QueryResultCache holds the results of recently executed queries so that
+// identical queries can reuse them instead of being evaluated again.
+//
+// The cache does not interpret its keys. Callers are responsible for building
+// keys which identify everything a result depends on, such that a result is
+// never stale for its key. Results are evicted in least recently used order
+// once they hold more than `max_bytes` in total. If a MemoryTracker is
+// provided, the bytes held by the cached results are accounted against it,
+// except for the rows of results which account them themselves.
+//
+// This class is thread-safe.
+class QueryResultCache {
+ public:
+  explicit QueryResultCache(int64_t max_bytes,
+                            MemoryTracker* memory_tracker = nullptr)
+      : max_bytes_(max_bytes),
+        memory_("query result cache", /*limit_bytes=*/0, memory_tracker) {}
+
+  // Returns the result cached for `key`, or nullptr if there is none.
+  std::shared_ptr<const QueryResultRows> Lookup(const std::string& key)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Caches `result` for `key`, replacing any result already cached for it.
+  // Results larger than the capacity of the cache are not cached.
+  void Insert(const std::string& key,
+              std::shared_ptr<const QueryResultRows> result)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the current counters of this cache.
+  QueryResultCacheStats stats() const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Entry {
+    std::string key;
+    std::shared_ptr<const QueryResultRows> result;
+    int64_t bytes;
+    // Bytes of the entry accounted by memory_.
+    int64_t accounted_bytes;
+  };
+  using Entries = std::list<Entry>;
+
+  // Removes the given entry from the cache.
+  void Remove(Entries::iterator entry) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Maximum number of bytes held by the cached results.
+  const int64_t max_bytes_;
+
+  // Tracker for the bytes held by the cached results.
+  MemoryTracker memory_;
+
+  mutable absl::Mutex mu_;
+
+  // Cached results, from the most to the least recently used.
+  Entries entries_ ABSL_GUARDED_BY(mu_);
+
+  // Index of entries_ by key.
+  absl::flat_hash_map<std::string, Entries::iterator> index_
+      ABSL_GUARDED_BY(mu_);
+
+  QueryResultCacheStats stats_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_QUERY_RESULT_CACHE_H_
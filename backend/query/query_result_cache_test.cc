@@ -0,0 +1,121 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/query/query_result_cache.h"
+
+#include <memory>
+#include <utility>
+
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "absl/memory/memory.h"
+#include "backend/common/memory_tracker.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using zetasql::values::Int64;
+
+// Returns a result with a single INT64 row, estimated at 8 bytes.
+std::shared_ptr<const QueryResultRows> SingleRowResult(int64_t value) {
+  auto result = std::make_shared<QueryResultRows>();
+  result->column_names = {"value"};
+  result->column_types = {zetasql::types::Int64Type()};
+  result->rows = {{Int64(value)}};
+  return result;
+}
+
+TEST(QueryResultCacheTest, ReturnsCachedResults) {
+  QueryResultCache cache(/*max_bytes=*/100);
+
+  EXPECT_EQ(cache.Lookup("a"), nullptr);
+  cache.Insert("a", SingleRowResult(1));
+  std::shared_ptr<const QueryResultRows> result = cache.Lookup("a");
+  ASSERT_NE(result, nullptr);
+  EXPECT_EQ(result->rows[0][0], Int64(1));
+
+  QueryResultCacheStats stats = cache.stats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+  EXPECT_EQ(stats.entries, 1);
+  EXPECT_EQ(stats.bytes, 9);
+}
+
+TEST(QueryResultCacheTest, EvictsLeastRecentlyUsedResults) {
+  // Each entry takes 9 bytes: 1 for its key and 8 for its row.
+  QueryResultCache cache(/*max_bytes=*/20);
+  cache.Insert("a", SingleRowResult(1));
+  cache.Insert("b", SingleRowResult(2));
+  EXPECT_NE(cache.Lookup("a"), nullptr);
+
+  cache.Insert("c", SingleRowResult(3));
+  EXPECT_NE(cache.Lookup("a"), nullptr);
+  EXPECT_EQ(cache.Lookup("b"), nullptr);
+  EXPECT_NE(cache.Lookup("c"), nullptr);
+
+  QueryResultCacheStats stats = cache.stats();
+  EXPECT_EQ(stats.evictions, 1);
+  EXPECT_EQ(stats.entries, 2);
+  EXPECT_EQ(stats.bytes, 18);
+}
+
+TEST(QueryResultCacheTest, DoesNotCacheResultsLargerThanCapacity) {
+  QueryResultCache cache(/*max_bytes=*/5);
+  cache.Insert("a", SingleRowResult(1));
+  EXPECT_EQ(cache.Lookup("a"), nullptr);
+  EXPECT_EQ(cache.stats().entries, 0);
+}
+
+TEST(QueryResultCacheTest, AccountsCachedResultsInMemoryTracker) {
+  MemoryTracker database("database", /*limit_bytes=*/0);
+  {
+    QueryResultCache cache(/*max_bytes=*/100, &database);
+    cache.Insert("a", SingleRowResult(1));
+    EXPECT_EQ(database.bytes_used(), 9);
+
+    cache.Insert("a", SingleRowResult(2));
+    EXPECT_EQ(database.bytes_used(), 9);
+    EXPECT_EQ(cache.Lookup("a")->rows[0][0], Int64(2));
+  }
+  EXPECT_EQ(database.bytes_used(), 0);
+}
+
+TEST(QueryResultCacheTest, DoesNotAccountRowsOfSelfAccountedResults) {
+  MemoryTracker database("database", /*limit_bytes=*/0);
+  QueryResultCache cache(/*max_bytes=*/100, &database);
+  auto result = std::make_shared<QueryResultRows>();
+  result->rows = {{Int64(1)}};
+  result->memory =
+      absl::make_unique<MemoryTracker>("query results", 0, &database);
+  ZETASQL_ASSERT_OK(result->memory->TryAllocate(8));
+
+  cache.Insert("a", std::move(result));
+  // The 8 bytes of the row are accounted once, plus 1 byte for the key.
+  EXPECT_EQ(database.bytes_used(), 9);
+  EXPECT_EQ(cache.stats().bytes, 9);
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -92,6 +92,9 @@ constexpr absl::string_view kHintDisableQueryPartitionabilityCheck =
 constexpr absl::string_view kHintDisableQueryNullFilteredIndexCheck =
     "disable_query_null_filtered_index_check";
 
+constexpr absl::string_view kHintMaxQueryMemoryBytes =
+    "max_query_memory_bytes";
+
 absl::Status CollectHintsForNode(
     const zetasql::ResolvedOption* hint,
     absl::flat_hash_map<absl::string_view, zetasql::Value>* node_hint_map) {
@@ -146,6 +149,50 @@ absl::Status QueryValidator::ValidateHints(
   return ExtractEmulatorOptionsForNode(emulator_hint_map);
 }
 
+absl::Status QueryValidator::VisitChildren(const zetasql::ResolvedNode* node) {
+  if (depth_ == 0) {
+    in_statement_ = node->IsStatement();
+  }
+  if (in_statement_) {
+    if (size_limits_status_.ok()) {
+      size_limits_status_ = size_limits_checker_.AddNode(node, depth_);
+    }
+    if (node->node_kind() == zetasql::RESOLVED_TABLE_SCAN) {
+      ZETASQL_RETURN_IF_ERROR(index_hint_validator_.CollectIndexHint(
+          node->GetAs<zetasql::ResolvedTableScan>()));
+    }
+  }
+
+  ++depth_;
+  absl::Status status = zetasql::ResolvedASTVisitor::DefaultVisit(node);
+  --depth_;
+  ZETASQL_RETURN_IF_ERROR(status);
+  if (depth_ == 0 && in_statement_) {
+    return ValidateTree(node);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status QueryValidator::ValidateTree(const zetasql::ResolvedNode* root) {
+  switch (root->node_kind()) {
+    case zetasql::RESOLVED_QUERY_STMT:
+    case zetasql::RESOLVED_INSERT_STMT:
+    case zetasql::RESOLVED_UPDATE_STMT:
+    case zetasql::RESOLVED_DELETE_STMT:
+      ZETASQL_RETURN_IF_ERROR(index_hint_validator_.ValidateIndexesForTables(
+          extracted_options_ != nullptr &&
+          extracted_options_->disable_query_null_filtered_index_check));
+      break;
+    default:
+      break;
+  }
+
+  // Check the query size limits
+  // https://cloud.google.com/spanner/quotas#query_limits
+  ZETASQL_RETURN_IF_ERROR(size_limits_status_);
+  return size_limits_checker_.CheckAddedNodes();
+}
+
 absl::Status QueryValidator::CheckSpannerHintName(
     absl::string_view name, const zetasql::ResolvedNodeKind node_kind) const {
   static const auto* supported_hints = new const absl::flat_hash_map<
@@ -188,7 +235,7 @@ absl::Status QueryValidator::CheckEmulatorHintName(
       {zetasql::RESOLVED_TABLE_SCAN,
        {kHintDisableQueryNullFilteredIndexCheck}},
       {zetasql::RESOLVED_QUERY_STMT,
-       {kHintDisableQueryPartitionabilityCheck}},
+       {kHintDisableQueryPartitionabilityCheck, kHintMaxQueryMemoryBytes}},
   };
 
   const auto& iter = supported_hints->find(node_kind);
@@ -304,6 +351,14 @@ absl::Status QueryValidator::ExtractEmulatorOptionsForNode(
             hint_value.bool_value();
       }
     }
+    if (absl::EqualsIgnoreCase(hint_name, kHintMaxQueryMemoryBytes)) {
+      if (!hint_value.type()->IsInt64() || hint_value.int64_value() <= 0) {
+        return error::InvalidEmulatorHintValue(hint_name,
+                                               hint_value.DebugString());
+      } else {
+        extracted_options_->max_query_memory_bytes = hint_value.int64_value();
+      }
+    }
   }
   return absl::OkStatus();
 }
@@ -342,7 +397,7 @@ absl::Status QueryValidator::VisitResolvedFunctionCall(
         CheckAllowedCasts(node->argument_list(0)->type(), node->type()));
   }
 
-  return zetasql::ResolvedASTVisitor::DefaultVisit(node);
+  return VisitChildren(node);
 }
 
 absl::Status QueryValidator::VisitResolvedAggregateFunctionCall(
@@ -357,13 +412,13 @@ absl::Status QueryValidator::VisitResolvedAggregateFunctionCall(
   // are unimplemented or may require additional validation of arguments.
   ZETASQL_RETURN_IF_ERROR(FilterSafeModeFunction(*node));
   ZETASQL_RETURN_IF_ERROR(FilterResolvedAggregateFunction(sql_features_, *node));
-  return zetasql::ResolvedASTVisitor::DefaultVisit(node);
+  return VisitChildren(node);
 }
 
 absl::Status QueryValidator::VisitResolvedCast(
     const zetasql::ResolvedCast* node) {
   ZETASQL_RETURN_IF_ERROR(CheckAllowedCasts(node->expr()->type(), node->type()));
-  return zetasql::ResolvedASTVisitor::DefaultVisit(node);
+  return VisitChildren(node);
 }
 
 }  // namespace backend
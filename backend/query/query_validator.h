@@ -23,7 +23,9 @@
 #include "zetasql/resolved_ast/resolved_ast_visitor.h"
 #include "backend/common/case.h"
 #include "backend/query/analyzer_options.h"
+#include "backend/query/feature_filter/query_size_limits_checker.h"
 #include "backend/query/feature_filter/sql_features_view.h"
+#include "backend/query/index_hint_validator.h"
 #include "backend/query/query_engine_options.h"
 #include "backend/schema/catalog/schema.h"
 #include "absl/status/status.h"
@@ -34,6 +36,14 @@ namespace emulator {
 namespace backend {
 
 // Implements ResolvedASTVisitor to validate various nodes in an AST.
+//
+// When the root of the AST is a statement, the validator also collects the
+// index hints and the query size metrics of the tree in the same walk. Once
+// the root has been visited, the index hints are validated with an
+// IndexHintValidator and the tree is checked against the query size limits
+// with a QuerySizeLimitsChecker, so that a statement is validated without
+// walking it again. Other trees, such as the expressions of generated columns,
+// are not subject to these checks.
 class QueryValidator : public zetasql::ResolvedASTVisitor {
  public:
   explicit QueryValidator(const Schema* schema,
@@ -42,11 +52,12 @@ class QueryValidator : public zetasql::ResolvedASTVisitor {
         analyzer_options_(MakeGoogleSqlAnalyzerOptions()),
         language_options_(MakeGoogleSqlLanguageOptions()),
         sql_features_(SqlFeaturesView()),
-        extracted_options_(extracted_options) {}
+        extracted_options_(extracted_options),
+        index_hint_validator_(schema) {}
 
   absl::Status DefaultVisit(const zetasql::ResolvedNode* node) override {
     ZETASQL_RETURN_IF_ERROR(ValidateHints(node));
-    return zetasql::ResolvedASTVisitor::DefaultVisit(node);
+    return VisitChildren(node);
   }
 
  protected:
@@ -62,6 +73,14 @@ class QueryValidator : public zetasql::ResolvedASTVisitor {
   // Validates the child hint nodes of `node`.
   absl::Status ValidateHints(const zetasql::ResolvedNode* node) const;
 
+  // Collects the index hints and the query size metrics of `node` if it belongs
+  // to a statement, and visits its children. Runs the checks over the whole
+  // statement once `node` is its root.
+  absl::Status VisitChildren(const zetasql::ResolvedNode* node);
+
+  // Runs the checks which need all the nodes of the tree rooted at `root`.
+  absl::Status ValidateTree(const zetasql::ResolvedNode* root);
+
   // Returns an OK if `name` is a supported hint name for nodes with kind
   // `node_kind`; otherwise, returns an invalid argument error.
   absl::Status CheckSpannerHintName(
@@ -101,6 +120,22 @@ class QueryValidator : public zetasql::ResolvedASTVisitor {
   // Options for the query engine that are extracted through user-specified
   // hints.
   QueryEngineOptions* extracted_options_;
+
+  // Collects the index hints of table scans, validated once the tree is.
+  IndexHintValidator index_hint_validator_;
+
+  // Collects the metrics checked against the query size limits.
+  QuerySizeLimitsChecker size_limits_checker_;
+
+  // First error found by the query size limits checks while walking the tree.
+  // Reported after any other validation error of the tree.
+  absl::Status size_limits_status_;
+
+  // Depth of the node being visited below the root of the tree.
+  int depth_ = 0;
+
+  // Whether the root of the tree being visited is a statement.
+  bool in_statement_ = false;
 };
 
 }  // namespace backend
@@ -153,6 +153,57 @@ TEST_F(QueryValidatorTest, CollectEmulatorOnlyOptionsFromHints) {
   }
 }
 
+TEST_F(QueryValidatorTest, ValidateStatementWithUnknownIndexHintReturnsError) {
+  QueryableTable table{schema()->FindTable("test_table"), /*reader=*/nullptr};
+  std::unique_ptr<zetasql::ResolvedTableScan> resolved_table_scan =
+      zetasql::MakeResolvedTableScan(/*column_list=*/{}, &table,
+                                       /*for_system_time_expr=*/nullptr);
+  resolved_table_scan->add_hint_list(zetasql::MakeResolvedOption(
+      /*qualifier=*/"", /*name=*/"force_index",
+      zetasql::MakeResolvedLiteral(zetasql::Value::String("no_such_index"))));
+  std::unique_ptr<zetasql::ResolvedQueryStmt> resolved_query_stmt =
+      zetasql::MakeResolvedQueryStmt(/*output_column_list=*/{},
+                                       /*is_value_table=*/false,
+                                       std::move(resolved_table_scan));
+
+  QueryEngineOptions opts;
+  QueryValidator validator{schema(), &opts};
+  EXPECT_THAT(resolved_query_stmt->Accept(&validator),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST_F(QueryValidatorTest, CollectQueryMemoryLimitFromHint) {
+  std::unique_ptr<zetasql::ResolvedQueryStmt> resolved_query_stmt =
+      zetasql::MakeResolvedQueryStmt(/*output_column_list=*/{},
+                                       /*is_value_table=*/false,
+                                       zetasql::MakeResolvedSingleRowScan());
+  resolved_query_stmt->add_hint_list(zetasql::MakeResolvedOption(
+      /*qualifier=*/"spanner_emulator",
+      /*name=*/"max_query_memory_bytes",
+      zetasql::MakeResolvedLiteral(zetasql::Value::Int64(1024))));
+
+  QueryEngineOptions opts;
+  QueryValidator validator{schema(), &opts};
+  ZETASQL_ASSERT_OK(resolved_query_stmt->Accept(&validator));
+  EXPECT_EQ(opts.max_query_memory_bytes, 1024);
+}
+
+TEST_F(QueryValidatorTest, ValidateQueryMemoryLimitHintValue) {
+  std::unique_ptr<zetasql::ResolvedQueryStmt> resolved_query_stmt =
+      zetasql::MakeResolvedQueryStmt(/*output_column_list=*/{},
+                                       /*is_value_table=*/false,
+                                       zetasql::MakeResolvedSingleRowScan());
+  resolved_query_stmt->add_hint_list(zetasql::MakeResolvedOption(
+      /*qualifier=*/"spanner_emulator",
+      /*name=*/"max_query_memory_bytes",
+      zetasql::MakeResolvedLiteral(zetasql::Value::Int64(0))));
+
+  QueryEngineOptions opts;
+  QueryValidator validator{schema(), &opts};
+  EXPECT_THAT(resolved_query_stmt->Accept(&validator),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 }  // namespace
 
 }  // namespace backend
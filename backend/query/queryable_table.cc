@@ -17,48 +17,273 @@
 #include "backend/query/queryable_table.h"
 
 #include <algorithm>
+#include <functional>
 #include <memory>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "zetasql/public/evaluator_table_iterator.h"
 #include "zetasql/public/value.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "zetasql/base/statusor.h"
 #include "absl/types/span.h"
 #include "backend/access/read.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/datamodel/key_set.h"
 #include "backend/query/queryable_column.h"
+#include "backend/schema/catalog/column.h"
+#include "backend/schema/catalog/index.h"
+#include "backend/schema/catalog/table.h"
 #include "absl/status/status.h"
+#include "zetasql/base/ret_check.h"
+#include "zetasql/base/status_macros.h"
 
 namespace google {
 namespace spanner {
 namespace emulator {
 namespace backend {
 
-// An implementation of EvaluatorTableIterator which wraps a RowCursor.
+namespace {
+
+// Maximum number of point keys (or key prefixes) a table scan is narrowed to.
+// Filters that would produce more keys are only pushed down on a shorter
+// prefix of the primary key, and indexes matching more rows are not used.
+constexpr int64_t kMaxPushedDownKeys = 10000;
+
+// Returns in 'values' the values which a column of the given type must have to
+// satisfy the filter, and false if the filter does not restrict the column to
+// a set of points. NULLs never satisfy a filter and are omitted.
+bool PointValuesForFilter(const zetasql::ColumnFilter& filter,
+                          const zetasql::Type* type,
+                          std::vector<zetasql::Value>* values) {
+  // Equality of floating point values (NaN, signed zeros) differs from the
+  // ordering of keys, so such columns are always scanned.
+  if (type->IsFloatingPoint()) {
+    return false;
+  }
+  std::vector<zetasql::Value> candidates;
+  switch (filter.kind()) {
+    case zetasql::ColumnFilter::kInList:
+      candidates = filter.in_list();
+      break;
+    case zetasql::ColumnFilter::kRange:
+      if (!filter.lower_bound().is_valid() ||
+          !filter.upper_bound().is_valid() ||
+          !filter.lower_bound().Equals(filter.upper_bound())) {
+        return false;
+      }
+      candidates.push_back(filter.lower_bound());
+      break;
+  }
+  for (zetasql::Value& value : candidates) {
+    if (!value.type()->Equals(type)) {
+      return false;
+    }
+    if (!value.is_null()) {
+      values->push_back(std::move(value));
+    }
+  }
+  return true;
+}
+
+// Returns in 'lower' and 'upper' the inclusive bounds which the values of a
+// column of the given type must be within to satisfy the filter, and false if
+// the filter does not restrict the column to a range. Missing bounds are left
+// invalid.
+bool RangeForFilter(const zetasql::ColumnFilter& filter,
+                    const zetasql::Type* type, zetasql::Value* lower,
+                    zetasql::Value* upper) {
+  if (type->IsFloatingPoint() ||
+      filter.kind() != zetasql::ColumnFilter::kRange) {
+    return false;
+  }
+  if (!filter.lower_bound().is_valid() && !filter.upper_bound().is_valid()) {
+    return false;
+  }
+  for (const zetasql::Value* bound :
+       {&filter.lower_bound(), &filter.upper_bound()}) {
+    if (bound->is_valid() &&
+        (bound->is_null() || !bound->type()->Equals(type))) {
+      return false;
+    }
+  }
+  *lower = filter.lower_bound();
+  *upper = filter.upper_bound();
+  return true;
+}
+
+// Returns the range of keys which extend 'prefix' with a value of the next key
+// column within ['lower', 'upper'], either of which may be unbounded (invalid).
+// Descending columns sort their values in reverse, so their bounds are swapped.
+KeyRange RangeWithinPrefix(const Key& prefix, const zetasql::Value& lower,
+                           const zetasql::Value& upper, bool descending) {
+  const zetasql::Value& first = descending ? upper : lower;
+  const zetasql::Value& last = descending ? lower : upper;
+  Key start_key = prefix;
+  if (first.is_valid()) {
+    start_key.AddColumn(first);
+  }
+  Key limit_key = prefix;
+  if (last.is_valid()) {
+    limit_key.AddColumn(last);
+  }
+  return KeyRange::ClosedOpen(start_key, limit_key.ToPrefixLimit());
+}
+
+// Sets 'key_set' to the keys covering every row which may satisfy 'filters' on
+// a prefix of 'key_columns', and returns false if the filters do not restrict
+// the first key column. Point filters narrow each key column in turn, and a
+// range filter can narrow the key column following them. 'filters' is keyed by
+// the column of the queried table, given by 'filtered_column' for each key
+// column.
+bool KeySetForKeyFilters(
+    absl::Span<const KeyColumn* const> key_columns,
+    const std::function<const Column*(const KeyColumn*)>& filtered_column,
+    const absl::flat_hash_map<const Column*, const zetasql::ColumnFilter*>&
+        filters,
+    KeySet* key_set) {
+  std::vector<Key> prefixes = {Key()};
+  int num_key_columns = 0;
+  const KeyColumn* range_column = nullptr;
+  zetasql::Value lower, upper;
+  for (const KeyColumn* key_column : key_columns) {
+    auto filter_itr = filters.find(filtered_column(key_column));
+    if (filter_itr == filters.end()) {
+      break;
+    }
+    const zetasql::ColumnFilter& filter = *filter_itr->second;
+    const zetasql::Type* type = key_column->column()->GetType();
+    std::vector<zetasql::Value> values;
+    if (!PointValuesForFilter(filter, type, &values)) {
+      if (RangeForFilter(filter, type, &lower, &upper)) {
+        range_column = key_column;
+      }
+      break;
+    }
+    if (static_cast<int64_t>(prefixes.size() * values.size()) >
+        kMaxPushedDownKeys) {
+      break;
+    }
+
+    std::vector<Key> extended_prefixes;
+    extended_prefixes.reserve(prefixes.size() * values.size());
+    for (const Key& prefix : prefixes) {
+      for (const zetasql::Value& value : values) {
+        Key key = prefix;
+        key.AddColumn(value);
+        extended_prefixes.push_back(std::move(key));
+      }
+    }
+    prefixes = std::move(extended_prefixes);
+    ++num_key_columns;
+  }
+
+  if (num_key_columns == 0 && range_column == nullptr) {
+    return false;
+  }
+  // The read canonicalizes the key set for the table, which applies the
+  // column sort orders and sorts and merges the keys.
+  *key_set = KeySet();
+  for (const Key& prefix : prefixes) {
+    if (range_column != nullptr) {
+      key_set->AddRange(RangeWithinPrefix(prefix, lower, upper,
+                                          range_column->is_descending()));
+    } else if (num_key_columns == key_columns.size()) {
+      key_set->AddKey(prefix);
+    } else {
+      key_set->AddRange(KeyRange::Prefix(prefix));
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+// An implementation of EvaluatorTableIterator which reads a table through a
+// RowReader.
+//
+// The read is deferred until the first call to NextRow so that column filters
+// set by the evaluator can narrow it: in-list and equality filters on a prefix
+// of the primary key turn the full table scan into a multi-point read, and a
+// range filter on the next key column into a range read. If the filters do not
+// narrow the primary key but narrow the key of a secondary index in the same
+// way, the index is read first for the primary keys of the matching rows, and
+// only those rows are read from the table, unless there are more than
+// kMaxPushedDownKeys of them, in which case the table is scanned. The
+// evaluator still applies the filters to the returned rows.
 //
 // Used by QueryableTable::CreateEvaluatorTableIterator.
-class RowCursorEvaluatorTableIterator
+class RowReaderEvaluatorTableIterator
     : public zetasql::EvaluatorTableIterator {
  public:
-  explicit RowCursorEvaluatorTableIterator(std::unique_ptr<RowCursor> cursor)
-      : cursor_(std::move(cursor)) {
-    values_.reserve(cursor_->NumColumns());
-    for (int i = 0; i < cursor_->NumColumns(); ++i) {
-      values_.push_back(zetasql::values::Null(cursor_->ColumnType(i)));
+  RowReaderEvaluatorTableIterator(const backend::Table* table,
+                                  RowReader* reader,
+                                  std::vector<const backend::Column*> columns)
+      : table_(table),
+        reader_(reader),
+        columns_(std::move(columns)),
+        key_set_(KeySet::All()) {
+    values_.reserve(columns_.size());
+    for (const backend::Column* column : columns_) {
+      values_.push_back(zetasql::values::Null(column->GetType()));
     }
   }
 
-  int NumColumns() const override { return cursor_->NumColumns(); }
+  int NumColumns() const override { return columns_.size(); }
 
   std::string GetColumnName(int i) const override {
-    return cursor_->ColumnName(i);
+    return columns_[i]->Name();
   }
 
   const zetasql::Type* GetColumnType(int i) const override {
-    return cursor_->ColumnType(i);
+    return columns_[i]->GetType();
+  }
+
+  absl::Status SetColumnFilterMap(
+      absl::flat_hash_map<int, std::unique_ptr<zetasql::ColumnFilter>>
+          filter_map) override {
+    ZETASQL_RET_CHECK(cursor_ == nullptr)
+        << "Column filters must be set before reading rows";
+    absl::flat_hash_map<const Column*, const zetasql::ColumnFilter*> filters;
+    for (const auto& [column_index, filter] : filter_map) {
+      if (column_index >= 0 && column_index < columns_.size()) {
+        filters[columns_[column_index]] = filter.get();
+      }
+    }
+    if (KeySetForKeyFilters(
+            table_->primary_key(),
+            [](const KeyColumn* key_column) { return key_column->column(); },
+            filters, &key_set_)) {
+      return absl::OkStatus();
+    }
+
+    // Null-filtered indexes omit the rows with a NULL in any of their key
+    // columns, which the filters may not exclude, so they are not used.
+    for (const Index* index : table_->indexes()) {
+      if (!index->is_null_filtered() &&
+          KeySetForKeyFilters(
+              index->key_columns(),
+              [](const KeyColumn* key_column) {
+                return key_column->column()->source_column();
+              },
+              filters, &index_key_set_)) {
+        index_ = index;
+        break;
+      }
+    }
+    return absl::OkStatus();
   }
 
   bool NextRow() override {
+    if (cursor_ == nullptr) {
+      status_ = Read();
+      if (!status_.ok()) {
+        return false;
+      }
+    }
     if (cursor_->Next()) {
       for (int i = 0; i < cursor_->NumColumns(); ++i) {
         values_[i] = cursor_->ColumnValue(i);
@@ -71,15 +296,84 @@ class RowCursorEvaluatorTableIterator
 
   const zetasql::Value& GetValue(int i) const override { return values_[i]; }
 
-  absl::Status Status() const override { return cursor_->Status(); }
+  absl::Status Status() const override {
+    if (!status_.ok() || cursor_ == nullptr) {
+      return status_;
+    }
+    return cursor_->Status();
+  }
 
   // Cancel is best-effort and not required.
   absl::Status Cancel() override { return absl::OkStatus(); }
 
  private:
-  // The wrapped RowCursor.
+  absl::Status Read() {
+    if (index_ != nullptr) {
+      ZETASQL_ASSIGN_OR_RETURN(key_set_, ReadIndexedKeys());
+    }
+    ReadArg read_arg;
+    read_arg.table = table_->Name();
+    read_arg.key_set = key_set_;
+    for (const backend::Column* column : columns_) {
+      read_arg.columns.push_back(column->Name());
+    }
+    return reader_->Read(read_arg, &cursor_);
+  }
+
+  // Returns the primary keys of the rows which index_ holds for
+  // index_key_set_, or all keys if there are more than kMaxPushedDownKeys of
+  // them, since scanning the table is then cheaper than reading each row by
+  // key.
+  zetasql_base::StatusOr<KeySet> ReadIndexedKeys() {
+    ReadArg read_arg;
+    read_arg.table = table_->Name();
+    read_arg.index = index_->Name();
+    read_arg.key_set = index_key_set_;
+    for (const KeyColumn* key_column : table_->primary_key()) {
+      read_arg.columns.push_back(key_column->column()->Name());
+    }
+    std::unique_ptr<RowCursor> cursor;
+    ZETASQL_RETURN_IF_ERROR(reader_->Read(read_arg, &cursor));
+
+    KeySet key_set;
+    int64_t num_keys = 0;
+    while (cursor->Next()) {
+      if (++num_keys > kMaxPushedDownKeys) {
+        return KeySet::All();
+      }
+      Key key;
+      for (int i = 0; i < cursor->NumColumns(); ++i) {
+        key.AddColumn(cursor->ColumnValue(i));
+      }
+      key_set.AddKey(key);
+    }
+    ZETASQL_RETURN_IF_ERROR(cursor->Status());
+    return key_set;
+  }
+
+  // The table being read.
+  const backend::Table* table_;
+
+  // The reader which the table is read through.
+  RowReader* reader_;
+
+  // The columns returned by this iterator.
+  const std::vector<const backend::Column*> columns_;
+
+  // The keys to read, narrowed by the column filters.
+  KeySet key_set_;
+
+  // The secondary index to find the keys to read in, if the column filters
+  // narrow its keys rather than the table's, and the index keys to read.
+  const Index* index_ = nullptr;
+  KeySet index_key_set_;
+
+  // The cursor over the rows read, null until the first call to NextRow.
   std::unique_ptr<RowCursor> cursor_;
 
+  // Status of the read.
+  absl::Status status_;
+
   // Values of the current row. EvaluatorTableIterator::GetValue need to return
   // a reference so we need to buffer the values instead of simply delegate to
   // RowCursor::ColumnValue.
@@ -108,18 +402,13 @@ QueryableTable::CreateEvaluatorTableIterator(
     absl::Span<const int> column_idxs) const {
   ZETASQL_RET_CHECK_NE(reader_, nullptr);
 
-  std::vector<std::string> column_names;
+  std::vector<const backend::Column*> columns;
+  columns.reserve(column_idxs.size());
   for (int idx : column_idxs) {
-    column_names.push_back(GetColumn(idx)->Name());
+    columns.push_back(wrapped_table_->columns()[idx]);
   }
-
-  ReadArg read_arg;
-  read_arg.table = Name();
-  read_arg.key_set = KeySet::All();
-  read_arg.columns = column_names;
-  std::unique_ptr<RowCursor> cursor;
-  ZETASQL_RETURN_IF_ERROR(reader_->Read(read_arg, &cursor));
-  return absl::make_unique<RowCursorEvaluatorTableIterator>(std::move(cursor));
+  return absl::make_unique<RowReaderEvaluatorTableIterator>(
+      wrapped_table_, reader_, std::move(columns));
 }
 
 const zetasql::Column* QueryableTable::FindColumnByName(
@@ -16,12 +16,22 @@
 
 #include "backend/query/queryable_table.h"
 
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/evaluator_table_iterator.h"
 #include "zetasql/public/type.h"
 #include "zetasql/public/value.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
 #include "backend/access/read.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/datamodel/key_set.h"
 #include "backend/query/catalog.h"
 #include "backend/query/queryable_column.h"
 #include "tests/common/row_cursor.h"
@@ -36,17 +46,40 @@ namespace backend {
 namespace {
 
 using testing::ElementsAre;
+using testing::IsEmpty;
+using zetasql::values::Int64;
+using zetasql::values::String;
+
+// A TestRowReader which records its reads.
+class KeySetRecordingRowReader : public test::TestRowReader {
+ public:
+  using TestRowReader::TestRowReader;
+
+  absl::Status Read(const ReadArg& read_arg,
+                    std::unique_ptr<RowCursor>* cursor) override {
+    reads_.push_back(read_arg);
+    return TestRowReader::Read(read_arg, cursor);
+  }
+
+  // Returns the key set of the last read.
+  const KeySet& key_set() const { return reads_.back().key_set; }
+
+  const std::vector<ReadArg>& reads() const { return reads_; }
+
+ private:
+  std::vector<ReadArg> reads_;
+};
 
 class QueryableTableTest : public testing::Test {
  public:
   const Schema* schema() { return schema_.get(); }
-  RowReader* reader() { return &reader_; }
+  KeySetRecordingRowReader* reader() { return &reader_; }
 
  private:
   zetasql::TypeFactory type_factory_;
   std::unique_ptr<const Schema> schema_ =
       test::CreateSchemaWithOneTable(&type_factory_);
-  test::TestRowReader reader_{
+  KeySetRecordingRowReader reader_{
       {{"test_table",
         {{"int64_col", "string_col"},
          {zetasql::types::Int64Type(), zetasql::types::StringType()},
@@ -112,6 +145,125 @@ TEST_F(QueryableTableTest, CreateEvaluatorTableIteratorWithAllColumns) {
   ASSERT_FALSE(iterator->NextRow());
 }
 
+TEST_F(QueryableTableTest, CreateEvaluatorTableIteratorReadsAllKeys) {
+  QueryableTable table{schema()->FindTable("test_table"), reader()};
+  auto iterator =
+      table.CreateEvaluatorTableIterator(/*column_idxs=*/{0, 1}).value();
+  ASSERT_TRUE(iterator->NextRow());
+  EXPECT_EQ(reader()->key_set().DebugString(), KeySet::All().DebugString());
+}
+
+TEST_F(QueryableTableTest, InListFilterOnKeyColumnReadsPointKeys) {
+  QueryableTable table{schema()->FindTable("test_table"), reader()};
+  auto iterator =
+      table.CreateEvaluatorTableIterator(/*column_idxs=*/{1, 0}).value();
+  absl::flat_hash_map<int, std::unique_ptr<zetasql::ColumnFilter>> filters;
+  filters[1] = absl::make_unique<zetasql::ColumnFilter>(
+      std::vector<zetasql::Value>{Int64(42), Int64(7),
+                                  zetasql::values::NullInt64()});
+  ZETASQL_ASSERT_OK(iterator->SetColumnFilterMap(std::move(filters)));
+
+  ASSERT_TRUE(iterator->NextRow());
+  EXPECT_THAT(reader()->key_set().keys(),
+              ElementsAre(Key({Int64(42)}), Key({Int64(7)})));
+  EXPECT_THAT(reader()->key_set().ranges(), IsEmpty());
+}
+
+TEST_F(QueryableTableTest, RangeFilterOnKeyColumnReadsKeyRange) {
+  QueryableTable table{schema()->FindTable("test_table"), reader()};
+  auto iterator =
+      table.CreateEvaluatorTableIterator(/*column_idxs=*/{0, 1}).value();
+  absl::flat_hash_map<int, std::unique_ptr<zetasql::ColumnFilter>> filters;
+  filters[0] = absl::make_unique<zetasql::ColumnFilter>(Int64(7), Int64(42));
+  ZETASQL_ASSERT_OK(iterator->SetColumnFilterMap(std::move(filters)));
+
+  ASSERT_TRUE(iterator->NextRow());
+  ASSERT_EQ(reader()->reads().size(), 1);
+  EXPECT_THAT(reader()->key_set().keys(), IsEmpty());
+  EXPECT_THAT(reader()->key_set().ranges(),
+              ElementsAre(KeyRange::ClosedOpen(
+                  Key({Int64(7)}), Key({Int64(42)}).ToPrefixLimit())));
+}
+
+TEST_F(QueryableTableTest, EqualityFilterOnIndexKeyReadsIndexedKeys) {
+  QueryableTable table{schema()->FindTable("test_table"), reader()};
+  auto iterator =
+      table.CreateEvaluatorTableIterator(/*column_idxs=*/{0, 1}).value();
+  absl::flat_hash_map<int, std::unique_ptr<zetasql::ColumnFilter>> filters;
+  filters[1] = absl::make_unique<zetasql::ColumnFilter>(
+      std::vector<zetasql::Value>{String("foo")});
+  ZETASQL_ASSERT_OK(iterator->SetColumnFilterMap(std::move(filters)));
+
+  ASSERT_TRUE(iterator->NextRow());
+  EXPECT_EQ(iterator->GetValue(0).int64_value(), 42);
+  EXPECT_EQ(iterator->GetValue(1).string_value(), "foo");
+  ASSERT_FALSE(iterator->NextRow());
+
+  // The index is read for the primary keys of the rows, and the table for the
+  // rows with those keys.
+  ASSERT_EQ(reader()->reads().size(), 2);
+  const ReadArg& index_read = reader()->reads()[0];
+  EXPECT_EQ(index_read.index, "test_index");
+  EXPECT_THAT(index_read.columns, ElementsAre("int64_col"));
+  EXPECT_THAT(index_read.key_set.keys(), ElementsAre(Key({String("foo")})));
+  EXPECT_THAT(index_read.key_set.ranges(), IsEmpty());
+  const ReadArg& table_read = reader()->reads()[1];
+  EXPECT_EQ(table_read.index, "");
+  EXPECT_THAT(table_read.key_set.keys(), ElementsAre(Key({Int64(42)})));
+  EXPECT_THAT(table_read.key_set.ranges(), IsEmpty());
+}
+
+TEST_F(QueryableTableTest, RangeFilterOnDescendingIndexKeyReadsIndexRange) {
+  QueryableTable table{schema()->FindTable("test_table"), reader()};
+  auto iterator =
+      table.CreateEvaluatorTableIterator(/*column_idxs=*/{0, 1}).value();
+  absl::flat_hash_map<int, std::unique_ptr<zetasql::ColumnFilter>> filters;
+  filters[1] = absl::make_unique<zetasql::ColumnFilter>(String("bar"),
+                                                        String("foo"));
+  ZETASQL_ASSERT_OK(iterator->SetColumnFilterMap(std::move(filters)));
+
+  ASSERT_TRUE(iterator->NextRow());
+  ASSERT_EQ(reader()->reads().size(), 2);
+  // test_index sorts string_col in descending order, so the range starts at
+  // the upper bound.
+  const ReadArg& index_read = reader()->reads()[0];
+  EXPECT_EQ(index_read.index, "test_index");
+  EXPECT_THAT(index_read.key_set.keys(), IsEmpty());
+  EXPECT_THAT(index_read.key_set.ranges(),
+              ElementsAre(KeyRange::ClosedOpen(
+                  Key({String("foo")}), Key({String("bar")}).ToPrefixLimit())));
+  EXPECT_THAT(reader()->reads()[1].key_set.keys(),
+              ElementsAre(Key({Int64(42)})));
+}
+
+TEST_F(QueryableTableTest, RangeFilterMatchingManyIndexedRowsScansTable) {
+  // More rows than the index is used for.
+  std::vector<std::vector<zetasql::Value>> rows;
+  for (int i = 0; i <= 10000; ++i) {
+    rows.push_back({Int64(i), String("foo")});
+  }
+  KeySetRecordingRowReader reader{
+      {{"test_table",
+        {{"int64_col", "string_col"},
+         {zetasql::types::Int64Type(), zetasql::types::StringType()},
+         rows}}}};
+  QueryableTable table{schema()->FindTable("test_table"), &reader};
+  auto iterator =
+      table.CreateEvaluatorTableIterator(/*column_idxs=*/{0, 1}).value();
+  absl::flat_hash_map<int, std::unique_ptr<zetasql::ColumnFilter>> filters;
+  filters[1] = absl::make_unique<zetasql::ColumnFilter>(String("bar"),
+                                                        String("foo"));
+  ZETASQL_ASSERT_OK(iterator->SetColumnFilterMap(std::move(filters)));
+
+  ASSERT_TRUE(iterator->NextRow());
+  ASSERT_EQ(reader.reads().size(), 2);
+  EXPECT_EQ(reader.reads()[0].index, "test_index");
+  EXPECT_EQ(reader.reads()[1].index, "");
+  EXPECT_THAT(reader.reads()[1].key_set.keys(), IsEmpty());
+  EXPECT_THAT(reader.reads()[1].key_set.ranges(),
+              ElementsAre(KeyRange::All()));
+}
+
 }  // namespace
 
 }  // namespace backend
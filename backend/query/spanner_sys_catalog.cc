@@ -0,0 +1,230 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/query/spanner_sys_catalog.h"
+
+#include <vector>
+
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+using zetasql::types::Int64Type;
+using zetasql::types::StringType;
+using zetasql::values::Int64;
+using zetasql::values::NullInt64;
+using zetasql::values::NullString;
+using zetasql::values::String;
+
+// Calls 'fn' with the name, index name (NULL for tables) and storage table id
+// of each table and index in 'schema'.
+template <typename Fn>
+void ForEachDataTable(const Schema* schema, Fn fn) {
+  for (const Table* table : schema->tables()) {
+    fn(String(table->Name()), NullString(), table->id());
+    for (const Index* index : table->indexes()) {
+      fn(String(table->Name()), String(index->Name()),
+         index->index_data_table()->id());
+    }
+  }
+}
+
+}  // namespace
+
+SpannerSysCatalog::SpannerSysCatalog(const Schema* default_schema,
+                                     const Storage* storage,
+                                     const MemoryTracker* memory_tracker,
+                                     const AdmissionController*
+                                         admission_controller,
+                                     const QueryResultCache* result_cache)
+    : zetasql::SimpleCatalog(kName),
+      default_schema_(default_schema),
+      storage_(storage),
+      memory_tracker_(memory_tracker),
+      admission_controller_(admission_controller),
+      result_cache_(result_cache) {
+  AddTableStatsTable();
+  AddTableKeySamplesTable();
+  AddTableSplitsTable();
+  if (memory_tracker_ != nullptr) {
+    AddMemoryUsageTable();
+  }
+  if (admission_controller_ != nullptr) {
+    AddRequestAdmissionTable();
+  }
+  if (result_cache_ != nullptr) {
+    AddQueryResultCacheTable();
+  }
+}
+
+void SpannerSysCatalog::AddTableStatsTable() {
+  // Setup table schema.
+  auto table_stats =
+      new zetasql::SimpleTable("TABLE_STATS", {{"TABLE_NAME", StringType()},
+                                                 {"INDEX_NAME", StringType()},
+                                                 {"ROW_COUNT", Int64Type()},
+                                                 {"USED_BYTES", Int64Type()}});
+
+  // Add table rows.
+  std::vector<std::vector<zetasql::Value>> rows;
+  ForEachDataTable(default_schema_, [&](const zetasql::Value& table_name,
+                                        const zetasql::Value& index_name,
+                                        const TableID& table_id) {
+    TableStats stats;
+    if (!storage_->GetTableStats(table_id, &stats).ok()) {
+      return;
+    }
+    rows.push_back({table_name, index_name, Int64(stats.row_count),
+                    Int64(stats.byte_size)});
+  });
+
+  // Add table to catalog.
+  table_stats->SetContents(rows);
+  AddOwnedTable(table_stats);
+}
+
+void SpannerSysCatalog::AddTableKeySamplesTable() {
+  // Setup table schema.
+  auto key_samples = new zetasql::SimpleTable(
+      "TABLE_KEY_SAMPLES", {{"TABLE_NAME", StringType()},
+                            {"INDEX_NAME", StringType()},
+                            {"ORDINAL_POSITION", Int64Type()},
+                            {"SAMPLE_KEY", StringType()}});
+
+  // Add table rows.
+  std::vector<std::vector<zetasql::Value>> rows;
+  ForEachDataTable(default_schema_, [&](const zetasql::Value& table_name,
+                                        const zetasql::Value& index_name,
+                                        const TableID& table_id) {
+    TableStats stats;
+    if (!storage_->GetTableStats(table_id, &stats).ok()) {
+      return;
+    }
+    for (int i = 0; i < stats.key_sample.size(); ++i) {
+      rows.push_back({table_name, index_name, Int64(i + 1),
+                      String(stats.key_sample[i].DebugString())});
+    }
+  });
+
+  // Add table to catalog.
+  key_samples->SetContents(rows);
+  AddOwnedTable(key_samples);
+}
+
+void SpannerSysCatalog::AddTableSplitsTable() {
+  // Setup table schema.
+  auto table_splits = new zetasql::SimpleTable(
+      "TABLE_SPLITS", {{"TABLE_NAME", StringType()},
+                       {"INDEX_NAME", StringType()},
+                       {"ORDINAL_POSITION", Int64Type()},
+                       {"START_KEY", StringType()},
+                       {"ROW_COUNT", Int64Type()},
+                       {"USED_BYTES", Int64Type()}});
+
+  // Add table rows.
+  std::vector<std::vector<zetasql::Value>> rows;
+  ForEachDataTable(default_schema_, [&](const zetasql::Value& table_name,
+                                        const zetasql::Value& index_name,
+                                        const TableID& table_id) {
+    std::vector<TableSplit> splits;
+    if (!storage_->GetTableSplits(table_id, &splits).ok()) {
+      return;
+    }
+    for (int i = 0; i < splits.size(); ++i) {
+      rows.push_back({table_name, index_name, Int64(i + 1),
+                      String(splits[i].start_key.DebugString()),
+                      Int64(splits[i].row_count), Int64(splits[i].byte_size)});
+    }
+  });
+
+  // Add table to catalog.
+  table_splits->SetContents(rows);
+  AddOwnedTable(table_splits);
+}
+
+void SpannerSysCatalog::AddMemoryUsageTable() {
+  // Setup table schema.
+  auto memory_usage = new zetasql::SimpleTable(
+      "MEMORY_USAGE", {{"RESOURCE_NAME", StringType()},
+                       {"USED_BYTES", Int64Type()},
+                       {"PEAK_USED_BYTES", Int64Type()},
+                       {"LIMIT_BYTES", Int64Type()}});
+
+  // Add table rows.
+  const int64_t limit_bytes = memory_tracker_->limit_bytes();
+  memory_usage->SetContents(
+      {{String(memory_tracker_->name()), Int64(memory_tracker_->bytes_used()),
+        Int64(memory_tracker_->peak_bytes_used()),
+        limit_bytes > 0 ? Int64(limit_bytes) : NullInt64()}});
+
+  // Add table to catalog.
+  AddOwnedTable(memory_usage);
+}
+
+void SpannerSysCatalog::AddRequestAdmissionTable() {
+  // Setup table schema.
+  auto request_admission = new zetasql::SimpleTable(
+      "REQUEST_ADMISSION", {{"RESOURCE_NAME", StringType()},
+                            {"IN_FLIGHT_REQUESTS", Int64Type()},
+                            {"QUEUED_REQUESTS", Int64Type()},
+                            {"PEAK_QUEUED_REQUESTS", Int64Type()},
+                            {"ADMITTED_REQUESTS", Int64Type()},
+                            {"REJECTED_REQUESTS", Int64Type()},
+                            {"TOTAL_QUEUE_TIME_USEC", Int64Type()}});
+
+  // Add table rows.
+  const AdmissionStats stats = admission_controller_->stats();
+  request_admission->SetContents(
+      {{String(admission_controller_->name()), Int64(stats.in_flight),
+        Int64(stats.queued), Int64(stats.peak_queued), Int64(stats.admitted),
+        Int64(stats.rejected),
+        Int64(absl::ToInt64Microseconds(stats.total_queue_time))}});
+
+  // Add table to catalog.
+  AddOwnedTable(request_admission);
+}
+
+void SpannerSysCatalog::AddQueryResultCacheTable() {
+  // Setup table schema.
+  auto result_cache = new zetasql::SimpleTable(
+      "QUERY_RESULT_CACHE", {{"ENTRIES", Int64Type()},
+                             {"USED_BYTES", Int64Type()},
+                             {"HITS", Int64Type()},
+                             {"MISSES", Int64Type()},
+                             {"EVICTIONS", Int64Type()}});
+
+  // Add table rows.
+  const QueryResultCacheStats stats = result_cache_->stats();
+  result_cache->SetContents({{Int64(stats.entries), Int64(stats.bytes),
+                              Int64(stats.hits), Int64(stats.misses),
+                              Int64(stats.evictions)}});
+
+  // Add table to catalog.
+  AddOwnedTable(result_cache);
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
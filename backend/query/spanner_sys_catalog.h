@@ -0,0 +1,92 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_SPANNER_SYS_CATALOG_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_SPANNER_SYS_CATALOG_H_
+
+#include "zetasql/public/simple_catalog.h"
+#include "backend/common/admission_controller.h"
+#include "backend/common/memory_tracker.h"
+#include "backend/query/query_result_cache.h"
+#include "backend/schema/catalog/schema.h"
+#include "backend/storage/storage.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// SpannerSysCatalog provides the SPANNER_SYS statistics tables.
+//
+// The emulator exposes the statistics which storage maintains for the tables
+// and indexes of the default schema:
+//
+//   TABLE_STATS: the number of rows and the estimated bytes used by each table
+//     and index (INDEX_NAME is NULL for tables).
+//   TABLE_KEY_SAMPLES: a uniform random sample of the keys of each table and
+//     index in key order, which forms an equi-depth histogram of its keys.
+//   TABLE_SPLITS: the key-range splits of each table and index in key order,
+//     with their start keys, number of rows and estimated bytes used.
+//
+// If the database's MemoryTracker is provided, it also exposes:
+//
+//   MEMORY_USAGE: the bytes currently and at most accounted by the database,
+//     and its limit (NULL if unlimited).
+//
+// If the database's AdmissionController is provided, it also exposes:
+//
+//   REQUEST_ADMISSION: the number of requests executing and waiting to execute
+//     on the database, the highest number which waited at once, the total
+//     numbers of requests admitted and rejected, and the total time admitted
+//     requests waited.
+//
+// If the database's QueryResultCache is provided, it also exposes:
+//
+//   QUERY_RESULT_CACHE: the number of results cached and the estimated bytes
+//     they hold, and the total numbers of cache hits, misses and evictions.
+//
+// Like the information schema, the contents are snapshotted when the catalog is
+// created, and reflect the latest committed state of storage.
+class SpannerSysCatalog : public zetasql::SimpleCatalog {
+ public:
+  static constexpr char kName[] = "SPANNER_SYS";
+
+  SpannerSysCatalog(const Schema* default_schema, const Storage* storage,
+                    const MemoryTracker* memory_tracker = nullptr,
+                    const AdmissionController* admission_controller = nullptr,
+                    const QueryResultCache* result_cache = nullptr);
+
+ private:
+  void AddTableStatsTable();
+  void AddTableKeySamplesTable();
+  void AddTableSplitsTable();
+  void AddMemoryUsageTable();
+  void AddRequestAdmissionTable();
+  void AddQueryResultCacheTable();
+
+  const Schema* default_schema_;
+  const Storage* storage_;
+  const MemoryTracker* memory_tracker_;
+  const AdmissionController* admission_controller_;
+  const QueryResultCache* result_cache_;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_SPANNER_SYS_CATALOG_H_
@@ -0,0 +1,235 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/query/top_n.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/evaluator.h"
+#include "zetasql/public/value.h"
+#include "zetasql/resolved_ast/resolved_ast.h"
+#include "zetasql/resolved_ast/resolved_ast_deep_copy_visitor.h"
+#include "zetasql/resolved_ast/resolved_node_kind.pb.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "zetasql/base/status_macros.h"
+#include "zetasql/base/statusor.h"
+#include "backend/common/memory_tracker.h"
+#include "backend/datamodel/key.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+// Maximum number of rows (limit + offset) kept by a top-N evaluation. Queries
+// keeping more rows than this are sorted by the evaluator.
+constexpr int64_t kMaxTopNRows = 100000;
+
+// Returns the value of a LIMIT or OFFSET expression, or an invalid value if it
+// is not a literal or parameter.
+zetasql::Value ConstantValue(const zetasql::ResolvedExpr* expr,
+                               const zetasql::ParameterValueMap& parameters) {
+  if (expr->node_kind() == zetasql::RESOLVED_LITERAL) {
+    return expr->GetAs<zetasql::ResolvedLiteral>()->value();
+  }
+  if (expr->node_kind() == zetasql::RESOLVED_PARAMETER) {
+    const std::string& name =
+        expr->GetAs<zetasql::ResolvedParameter>()->name();
+    for (const auto& [parameter_name, value] : parameters) {
+      if (absl::EqualsIgnoreCase(parameter_name, name)) {
+        return value;
+      }
+    }
+  }
+  return zetasql::Value();
+}
+
+// Returns the position of `column` in `column_list`, or -1.
+int FindColumn(const zetasql::ResolvedColumnList& column_list,
+               const zetasql::ResolvedColumn& column) {
+  for (int i = 0; i < column_list.size(); ++i) {
+    if (column_list[i].column_id() == column.column_id()) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+}  // namespace
+
+zetasql_base::StatusOr<std::unique_ptr<TopNPlan>> MakeTopNPlan(
+    const zetasql::ResolvedQueryStmt* statement,
+    const zetasql::ParameterValueMap& parameters) {
+  if (statement->is_value_table() ||
+      statement->query()->node_kind() != zetasql::RESOLVED_LIMIT_OFFSET_SCAN) {
+    return nullptr;
+  }
+  const auto* limit_offset_scan =
+      statement->query()->GetAs<zetasql::ResolvedLimitOffsetScan>();
+  if (limit_offset_scan->input_scan()->node_kind() !=
+      zetasql::RESOLVED_ORDER_BY_SCAN) {
+    return nullptr;
+  }
+  const auto* order_by_scan =
+      limit_offset_scan->input_scan()->GetAs<zetasql::ResolvedOrderByScan>();
+
+  // Only constant bounds are known before evaluation. Invalid bounds are left
+  // for the evaluator to report.
+  auto plan = absl::make_unique<TopNPlan>();
+  const zetasql::Value limit =
+      ConstantValue(limit_offset_scan->limit(), parameters);
+  if (!limit.is_valid() || limit.is_null() || !limit.type()->IsInt64() ||
+      limit.int64_value() < 0) {
+    return nullptr;
+  }
+  plan->limit = limit.int64_value();
+  if (limit_offset_scan->offset() != nullptr) {
+    const zetasql::Value offset =
+        ConstantValue(limit_offset_scan->offset(), parameters);
+    if (!offset.is_valid() || offset.is_null() || !offset.type()->IsInt64() ||
+        offset.int64_value() < 0) {
+      return nullptr;
+    }
+    plan->offset = offset.int64_value();
+  }
+  if (plan->limit > kMaxTopNRows || plan->offset > kMaxTopNRows - plan->limit) {
+    return nullptr;
+  }
+
+  const zetasql::ResolvedScan* input_scan = order_by_scan->input_scan();
+  const zetasql::ResolvedColumnList& input_columns = input_scan->column_list();
+  for (const auto& order_by_item : order_by_scan->order_by_item_list()) {
+    const int position =
+        FindColumn(input_columns, order_by_item->column_ref()->column());
+    if (position < 0) {
+      return nullptr;
+    }
+    plan->order_by_columns.push_back(position);
+    plan->descending.push_back(order_by_item->is_descending());
+  }
+  for (const auto& output_column : statement->output_column_list()) {
+    const int position = FindColumn(input_columns, output_column->column());
+    if (position < 0) {
+      return nullptr;
+    }
+    plan->output_columns.push_back(position);
+    plan->output_names.push_back(output_column->name());
+    plan->output_types.push_back(output_column->column().type());
+  }
+
+  // Evaluate the scan below the ORDER BY as a query of its own.
+  zetasql::ResolvedASTDeepCopyVisitor copier;
+  ZETASQL_RETURN_IF_ERROR(input_scan->Accept(&copier));
+  ZETASQL_ASSIGN_OR_RETURN(std::unique_ptr<zetasql::ResolvedScan> input_scan_copy,
+                   copier.ConsumeRootNode<zetasql::ResolvedScan>());
+  std::vector<std::unique_ptr<const zetasql::ResolvedOutputColumn>>
+      input_output_columns;
+  for (const zetasql::ResolvedColumn& column : input_columns) {
+    input_output_columns.push_back(
+        zetasql::MakeResolvedOutputColumn(column.name(), column));
+  }
+  plan->input_statement = zetasql::MakeResolvedQueryStmt(
+      std::move(input_output_columns), /*is_value_table=*/false,
+      std::move(input_scan_copy));
+  return plan;
+}
+
+bool TopNCollector::RowLess(const std::vector<zetasql::Value>& lhs,
+                            const std::vector<zetasql::Value>& rhs) const {
+  // Value::LessThan orders NULLs first, matching the default ORDER BY order.
+  for (int i = 0; i < plan_->order_by_columns.size(); ++i) {
+    const zetasql::Value& left = lhs[plan_->order_by_columns[i]];
+    const zetasql::Value& right = rhs[plan_->order_by_columns[i]];
+    if (left.LessThan(right)) {
+      return !plan_->descending[i];
+    }
+    if (right.LessThan(left)) {
+      return plan_->descending[i];
+    }
+  }
+  return false;
+}
+
+TopNCollector::~TopNCollector() { memory_->Release(heap_bytes_); }
+
+absl::Status TopNCollector::Add(std::vector<zetasql::Value> row) {
+  const int64_t capacity = plan_->limit + plan_->offset;
+  if (capacity == 0) {
+    return absl::OkStatus();
+  }
+  auto less = [this](const std::vector<zetasql::Value>& lhs,
+                     const std::vector<zetasql::Value>& rhs) {
+    return RowLess(lhs, rhs);
+  };
+  if (heap_.size() == capacity && !RowLess(row, heap_.front())) {
+    return absl::OkStatus();
+  }
+
+  const int64_t row_bytes = EstimateSizeInBytes(Key(), row);
+  ZETASQL_RETURN_IF_ERROR(memory_->TryAllocate(row_bytes));
+  heap_bytes_ += row_bytes;
+  if (heap_.size() == capacity) {
+    std::pop_heap(heap_.begin(), heap_.end(), less);
+    const int64_t evicted_bytes = EstimateSizeInBytes(Key(), heap_.back());
+    memory_->Release(evicted_bytes);
+    heap_bytes_ -= evicted_bytes;
+    heap_.back() = std::move(row);
+  } else {
+    heap_.push_back(std::move(row));
+  }
+  std::push_heap(heap_.begin(), heap_.end(), less);
+  return absl::OkStatus();
+}
+
+zetasql_base::StatusOr<std::vector<std::vector<zetasql::Value>>>
+TopNCollector::Finish() {
+  std::sort_heap(heap_.begin(), heap_.end(),
+                 [this](const std::vector<zetasql::Value>& lhs,
+                        const std::vector<zetasql::Value>& rhs) {
+                   return RowLess(lhs, rhs);
+                 });
+  std::vector<std::vector<zetasql::Value>> rows;
+  for (int64_t i = plan_->offset; i < heap_.size(); ++i) {
+    std::vector<zetasql::Value> row;
+    row.reserve(plan_->output_columns.size());
+    for (int position : plan_->output_columns) {
+      row.push_back(heap_[i][position]);
+    }
+    rows.push_back(std::move(row));
+  }
+
+  // Hand the accounting of the kept rows over to the returned ones.
+  memory_->Release(heap_bytes_);
+  heap_bytes_ = 0;
+  heap_.clear();
+  for (const auto& row : rows) {
+    ZETASQL_RETURN_IF_ERROR(
+        memory_->TryAllocate(EstimateSizeInBytes(Key(), row)));
+  }
+  return rows;
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
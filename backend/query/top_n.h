@@ -0,0 +1,118 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_TOP_N_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_TOP_N_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "zetasql/public/evaluator.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "zetasql/resolved_ast/resolved_ast.h"
+#include "absl/status/status.h"
+#include "zetasql/base/statusor.h"
+#include "backend/common/memory_tracker.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// TopNPlan evaluates a query of the form
+//
+//   SELECT ... FROM ... ORDER BY <columns> LIMIT <n> [OFFSET <m>]
+//
+// by streaming the rows to be ordered through a bounded heap of n + m rows,
+// instead of materializing and sorting all of them in the evaluator.
+struct TopNPlan {
+  // A query which evaluates the rows to be ordered. Its output columns are the
+  // columns of the scan below the ORDER BY.
+  std::unique_ptr<const zetasql::ResolvedQueryStmt> input_statement;
+
+  // Positions of the ORDER BY columns in the rows of `input_statement`, and
+  // whether each is sorted in descending order.
+  std::vector<int> order_by_columns;
+  std::vector<bool> descending;
+
+  // Number of rows to skip, and number of rows to return after them.
+  int64_t offset = 0;
+  int64_t limit = 0;
+
+  // Positions, names and types of the output columns of the original query in
+  // the rows of `input_statement`.
+  std::vector<int> output_columns;
+  std::vector<std::string> output_names;
+  std::vector<const zetasql::Type*> output_types;
+};
+
+// Returns a TopNPlan for `statement`, or null if the statement does not have
+// the shape above, its LIMIT and OFFSET are not literals or parameters, or it
+// would keep too many rows for a bounded heap to be worthwhile.
+zetasql_base::StatusOr<std::unique_ptr<TopNPlan>> MakeTopNPlan(
+    const zetasql::ResolvedQueryStmt* statement,
+    const zetasql::ParameterValueMap& parameters);
+
+// TopNCollector keeps the first limit + offset rows added to it in the order
+// of a TopNPlan, using memory proportional to limit + offset.
+//
+// The rows kept are accounted to a MemoryTracker from the time they enter the
+// heap until they are evicted from it or the collector is destroyed.
+class TopNCollector {
+ public:
+  TopNCollector(const TopNPlan* plan, MemoryTracker* memory)
+      : plan_(plan), memory_(memory) {}
+  ~TopNCollector();
+
+  TopNCollector(const TopNCollector&) = delete;
+  TopNCollector& operator=(const TopNCollector&) = delete;
+
+  // Adds a row of the plan's input statement. Returns RESOURCE_EXHAUSTED if
+  // keeping the row would exceed the limits of the memory tracker.
+  absl::Status Add(std::vector<zetasql::Value> row);
+
+  // Returns the rows of the original query, in order, projected to its output
+  // columns. The rows returned remain accounted to the memory tracker, and the
+  // rows kept but not returned are released from it.
+  zetasql_base::StatusOr<std::vector<std::vector<zetasql::Value>>> Finish();
+
+ private:
+  // Returns true if row `lhs` is ordered before row `rhs`.
+  bool RowLess(const std::vector<zetasql::Value>& lhs,
+               const std::vector<zetasql::Value>& rhs) const;
+
+  const TopNPlan* plan_;
+
+  // Tracker of the rows kept.
+  MemoryTracker* memory_;
+
+  // Number of bytes of the rows in the heap accounted to memory_.
+  int64_t heap_bytes_ = 0;
+
+  // Max-heap of the rows kept so far under RowLess, whose top is the row that
+  // would be evicted next.
+  std::vector<std::vector<zetasql::Value>> heap_;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_QUERY_TOP_N_H_
@@ -0,0 +1,237 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/query/top_n.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "zetasql/public/analyzer.h"
+#include "zetasql/public/simple_catalog.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "absl/status/status.h"
+#include "zetasql/base/status_macros.h"
+#include "zetasql/base/statusor.h"
+#include "backend/common/memory_tracker.h"
+#include "backend/query/analyzer_options.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+using zetasql::values::Int64;
+using zetasql::values::NullInt64;
+using zetasql::values::String;
+using zetasql_base::testing::IsOkAndHolds;
+using zetasql_base::testing::StatusIs;
+
+using Row = std::vector<zetasql::Value>;
+
+// Returns a plan over rows of an INT64 and a STRING column, which returns both
+// columns of the rows ordered by the given columns.
+TopNPlan MakePlan(std::vector<int> order_by_columns,
+                  std::vector<bool> descending, int64_t limit,
+                  int64_t offset = 0) {
+  TopNPlan plan;
+  plan.order_by_columns = std::move(order_by_columns);
+  plan.descending = std::move(descending);
+  plan.limit = limit;
+  plan.offset = offset;
+  plan.output_columns = {0, 1};
+  return plan;
+}
+
+// Adds `rows` to a collector for `plan` and returns the rows it collected.
+zetasql_base::StatusOr<std::vector<Row>> Collect(const TopNPlan& plan,
+                                           std::vector<Row> rows) {
+  MemoryTracker memory("query results", /*limit_bytes=*/0);
+  TopNCollector collector(&plan, &memory);
+  for (Row& row : rows) {
+    ZETASQL_RETURN_IF_ERROR(collector.Add(std::move(row)));
+  }
+  return collector.Finish();
+}
+
+TEST(TopNCollectorTest, OrdersNullsFirstInAscendingOrder) {
+  EXPECT_THAT(Collect(MakePlan({0}, {false}, /*limit=*/3),
+                      {{Int64(3), String("c")},
+                       {NullInt64(), String("n")},
+                       {Int64(1), String("a")}}),
+              IsOkAndHolds(ElementsAre(Row{NullInt64(), String("n")},
+                                       Row{Int64(1), String("a")},
+                                       Row{Int64(3), String("c")})));
+}
+
+TEST(TopNCollectorTest, OrdersNullsLastInDescendingOrder) {
+  EXPECT_THAT(Collect(MakePlan({0}, {true}, /*limit=*/3),
+                      {{Int64(3), String("c")},
+                       {NullInt64(), String("n")},
+                       {Int64(1), String("a")}}),
+              IsOkAndHolds(ElementsAre(Row{Int64(3), String("c")},
+                                       Row{Int64(1), String("a")},
+                                       Row{NullInt64(), String("n")})));
+}
+
+TEST(TopNCollectorTest, KeepsTiedRowsUpToTheLimit) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::vector<Row> rows,
+                       Collect(MakePlan({0}, {false}, /*limit=*/3),
+                               {{Int64(2), String("b1")},
+                                {Int64(3), String("c")},
+                                {Int64(2), String("b2")},
+                                {Int64(1), String("a")},
+                                {Int64(2), String("b3")}}));
+  ASSERT_EQ(rows.size(), 3);
+  EXPECT_EQ(rows[0], (Row{Int64(1), String("a")}));
+  // Which of the tied rows are returned is unspecified.
+  for (int i = 1; i < 3; ++i) {
+    EXPECT_EQ(rows[i][0], Int64(2));
+  }
+  EXPECT_NE(rows[1][1], rows[2][1]);
+}
+
+TEST(TopNCollectorTest, OrdersByMultipleColumns) {
+  EXPECT_THAT(Collect(MakePlan({0, 1}, {false, true}, /*limit=*/3),
+                      {{Int64(2), String("y")},
+                       {Int64(1), String("x")},
+                       {Int64(2), String("w")},
+                       {Int64(1), String("z")}}),
+              IsOkAndHolds(ElementsAre(Row{Int64(1), String("z")},
+                                       Row{Int64(1), String("x")},
+                                       Row{Int64(2), String("y")})));
+}
+
+TEST(TopNCollectorTest, LimitZeroReturnsNoRows) {
+  TopNPlan plan = MakePlan({0}, {false}, /*limit=*/0);
+  MemoryTracker memory("query results", /*limit_bytes=*/0);
+  TopNCollector collector(&plan, &memory);
+  ZETASQL_EXPECT_OK(collector.Add({Int64(1), String("a")}));
+  EXPECT_EQ(memory.bytes_used(), 0);
+  EXPECT_THAT(collector.Finish(), IsOkAndHolds(IsEmpty()));
+}
+
+TEST(TopNCollectorTest, OffsetPastTheRowsReturnsNoRows) {
+  TopNPlan plan = MakePlan({0}, {false}, /*limit=*/2, /*offset=*/5);
+  MemoryTracker memory("query results", /*limit_bytes=*/0);
+  TopNCollector collector(&plan, &memory);
+  for (int i = 0; i < 3; ++i) {
+    ZETASQL_EXPECT_OK(collector.Add({Int64(i), String("a")}));
+  }
+  EXPECT_THAT(collector.Finish(), IsOkAndHolds(IsEmpty()));
+  EXPECT_EQ(memory.bytes_used(), 0);
+}
+
+TEST(TopNCollectorTest, AccountsTheRowsInTheHeap) {
+  TopNPlan plan = MakePlan({0}, {false}, /*limit=*/1, /*offset=*/1);
+  plan.output_columns = {0};
+  MemoryTracker memory("query results", /*limit_bytes=*/0);
+  {
+    TopNCollector collector(&plan, &memory);
+    ZETASQL_EXPECT_OK(collector.Add({Int64(5), String("aaaa")}));
+    ZETASQL_EXPECT_OK(collector.Add({Int64(4), String("bb")}));
+    EXPECT_EQ(memory.bytes_used(), 12 + 10);
+
+    // The new row evicts the first one.
+    ZETASQL_EXPECT_OK(collector.Add({Int64(3), String("c")}));
+    EXPECT_EQ(memory.bytes_used(), 10 + 9);
+
+    // Rows ordered after the heap are never accounted.
+    ZETASQL_EXPECT_OK(collector.Add({Int64(6), String("dddddddd")}));
+    EXPECT_EQ(memory.bytes_used(), 10 + 9);
+    EXPECT_EQ(memory.peak_bytes_used(), 12 + 10 + 9);
+
+    // Only the projected rows returned remain accounted.
+    EXPECT_THAT(collector.Finish(),
+                IsOkAndHolds(ElementsAre(ElementsAre(Int64(4)))));
+    EXPECT_EQ(memory.bytes_used(), 8);
+  }
+  EXPECT_EQ(memory.bytes_used(), 8);
+}
+
+TEST(TopNCollectorTest, ReleasesTheRowsInTheHeapWhenDestroyed) {
+  TopNPlan plan = MakePlan({0}, {false}, /*limit=*/2);
+  MemoryTracker memory("query results", /*limit_bytes=*/0);
+  {
+    TopNCollector collector(&plan, &memory);
+    ZETASQL_EXPECT_OK(collector.Add({Int64(1), String("a")}));
+    EXPECT_EQ(memory.bytes_used(), 9);
+  }
+  EXPECT_EQ(memory.bytes_used(), 0);
+}
+
+TEST(TopNCollectorTest, FailsWhenTheRowsInTheHeapExceedTheMemoryLimit) {
+  TopNPlan plan = MakePlan({0}, {false}, /*limit=*/10);
+  MemoryTracker memory("query results", /*limit_bytes=*/20);
+  TopNCollector collector(&plan, &memory);
+  ZETASQL_EXPECT_OK(collector.Add({Int64(1), String("aaaaaaaaaa")}));
+  EXPECT_THAT(collector.Add({Int64(2), String("bbbb")}),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+}
+
+TEST(TopNCollectorTest, UsesParameterizedLimitAndOffset) {
+  zetasql::TypeFactory type_factory;
+  zetasql::SimpleCatalog catalog("test");
+  zetasql::AnalyzerOptions options = MakeGoogleSqlAnalyzerOptions();
+  ZETASQL_ASSERT_OK(
+      options.AddQueryParameter("limit", zetasql::types::Int64Type()));
+  ZETASQL_ASSERT_OK(
+      options.AddQueryParameter("offset", zetasql::types::Int64Type()));
+  std::unique_ptr<const zetasql::AnalyzerOutput> output;
+  ZETASQL_ASSERT_OK(zetasql::AnalyzeStatement(
+      "SELECT x FROM UNNEST([1, 2, 3, 4, 5]) AS x ORDER BY x DESC "
+      "LIMIT @limit OFFSET @offset",
+      options, &catalog, &type_factory, &output));
+  const auto* statement =
+      output->resolved_statement()->GetAs<zetasql::ResolvedQueryStmt>();
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<TopNPlan> plan,
+      MakeTopNPlan(statement, {{"limit", Int64(2)}, {"offset", Int64(1)}}));
+  ASSERT_NE(plan, nullptr);
+  EXPECT_EQ(plan->limit, 2);
+  EXPECT_EQ(plan->offset, 1);
+  EXPECT_THAT(plan->descending, ElementsAre(true));
+
+  MemoryTracker memory("query results", /*limit_bytes=*/0);
+  TopNCollector collector(plan.get(), &memory);
+  for (int x = 1; x <= 5; ++x) {
+    ZETASQL_EXPECT_OK(collector.Add({Int64(x)}));
+  }
+  EXPECT_THAT(collector.Finish(),
+              IsOkAndHolds(ElementsAre(ElementsAre(Int64(4)),
+                                       ElementsAre(Int64(3)))));
+
+  // NULL bounds are left for the evaluator to report.
+  EXPECT_THAT(
+      MakeTopNPlan(statement, {{"limit", NullInt64()}, {"offset", Int64(1)}}),
+      IsOkAndHolds(nullptr));
+}
+
+}  // namespace
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -56,8 +56,8 @@ const Index* Schema::FindIndex(const std::string& index_name) const {
   return itr->second;
 }
 
-Schema::Schema(std::unique_ptr<const SchemaGraph> graph)
-    : graph_(std::move(graph)) {
+Schema::Schema(std::unique_ptr<const SchemaGraph> graph, int64_t generation)
+    : graph_(std::move(graph)), generation_(generation) {
   tables_.clear();
   tables_map_.clear();
   index_map_.clear();
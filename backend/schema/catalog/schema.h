@@ -41,9 +41,12 @@ class Schema {
  public:
   Schema() : graph_(absl::make_unique<SchemaGraph>()) {}
 
-  explicit Schema(std::unique_ptr<const SchemaGraph> graph);
+  explicit Schema(std::unique_ptr<const SchemaGraph> graph,
+                  int64_t generation = 0);
 
-  // Returns the generation number of this schema.
+  // Returns the generation number of this schema. Each schema change derives
+  // a schema with the next generation number from the one it changes, so that
+  // the generation identifies a schema among those of a database.
   int64_t generation() const { return generation_; }
 
   // Finds a table by its name. Returns a const pointer of the table, or nullptr
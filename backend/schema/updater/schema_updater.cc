@@ -339,7 +339,8 @@ SchemaUpdaterImpl::ApplyDDLStatement(absl::string_view statement) {
                        << ddl_statement.kind_case();
   }
   ZETASQL_ASSIGN_OR_RETURN(auto new_schema_graph, editor_->CanonicalizeGraph());
-  return absl::make_unique<const Schema>(std::move(new_schema_graph));
+  return absl::make_unique<const Schema>(std::move(new_schema_graph),
+                                         latest_schema_->generation() + 1);
 }
 
 zetasql_base::StatusOr<std::vector<SchemaValidationContext>>
@@ -106,6 +106,26 @@ TEST_F(SchemaUpdaterTest, CreationOrder) {
               testing::ElementsAreArray(expected));
 }
 
+TEST_F(SchemaUpdaterTest, EachStatementAdvancesTheGeneration) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto schema, CreateSchema({
+                                        R"(
+      CREATE TABLE T (
+        k1 INT64,
+        c1 INT64
+      ) PRIMARY KEY (k1)
+    )",
+                                        R"(
+      CREATE INDEX Idx ON T(c1)
+    )"}));
+  EXPECT_EQ(schema->generation(), 2);
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto new_schema,
+                       UpdateSchema(schema.get(), {R"(
+      DROP INDEX Idx
+    )"}));
+  EXPECT_EQ(new_schema->generation(), 3);
+}
+
 }  // namespace
 
 }  // namespace test
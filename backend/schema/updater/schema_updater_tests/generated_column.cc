@@ -14,6 +14,12 @@
 // limitations under the License.
 //
 
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "backend/query/feature_filter/query_size_limits_checker.h"
 #include "backend/schema/updater/schema_updater_tests/base.h"
 #include "tests/common/scoped_feature_flags_setter.h"
 
@@ -91,6 +97,31 @@ TEST_F(GeneratedColumnSchemaUpdaterTest, Basic) {
               testing::UnorderedElementsAreArray({"G1"}));
 }
 
+TEST_F(GeneratedColumnSchemaUpdaterTest,
+       ExpressionsAreNotSubjectToQuerySizeLimits) {
+  // A conjunction of comparisons is a single level of nesting, but has more
+  // function calls than queries may have.
+  std::vector<std::string> comparisons;
+  for (int i = 0; i <= QuerySizeLimitsChecker::kMaxFunctionNodes; ++i) {
+    comparisons.push_back(absl::StrCat("K > ", i));
+  }
+  const std::string expression =
+      absl::StrCat("(", absl::StrJoin(comparisons, " AND "), ")");
+  const std::string create_table = absl::StrCat(R"(
+      CREATE TABLE T (
+        K INT64 NOT NULL,
+        G BOOL AS )",
+                                                 expression, R"( STORED,
+      ) PRIMARY KEY (K)
+    )");
+  ZETASQL_ASSERT_OK_AND_ASSIGN(auto schema, CreateSchema({create_table}));
+
+  const Column* col = schema->FindTable("T")->FindColumn("G");
+  ASSERT_NE(col, nullptr);
+  EXPECT_TRUE(col->is_generated());
+  EXPECT_EQ(col->expression().value(), expression);
+}
+
 }  // namespace test
 }  // namespace backend
 }  // namespace emulator
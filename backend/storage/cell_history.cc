@@ -0,0 +1,260 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/storage/cell_history.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+// Maps signed integers to unsigned ones so that values of small magnitude have
+// short varint encodings.
+uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+void AppendVarint(int64_t value, std::string* buffer) {
+  uint64_t encoded = ZigZagEncode(value);
+  while (encoded >= 0x80) {
+    buffer->push_back(static_cast<char>(encoded | 0x80));
+    encoded >>= 7;
+  }
+  buffer->push_back(static_cast<char>(encoded));
+}
+
+// Reads a varint appended by AppendVarint from the start of 'buffer' and
+// removes it.
+int64_t ReadVarint(absl::string_view* buffer) {
+  uint64_t encoded = 0;
+  for (int shift = 0;; shift += 7) {
+    const uint8_t byte = static_cast<uint8_t>(buffer->front());
+    buffer->remove_prefix(1);
+    encoded |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if (byte < 0x80) {
+      break;
+    }
+  }
+  return ZigZagDecode(encoded);
+}
+
+// In the INT64 encoding of values, deltas of zero are followed by a byte
+// telling a version repeating the previous value from a deleted version, which
+// has no value.
+constexpr char kRepeatedValue = 0;
+constexpr char kDeletedValue = 1;
+
+void AppendInt64Delta(int64_t delta, std::string* buffer) {
+  AppendVarint(delta, buffer);
+  if (delta == 0) {
+    buffer->push_back(kRepeatedValue);
+  }
+}
+
+void AppendInt64Deletion(std::string* buffer) {
+  AppendVarint(0, buffer);
+  buffer->push_back(kDeletedValue);
+}
+
+// Reads a delta appended by AppendInt64Delta or AppendInt64Deletion from the
+// start of 'buffer' and removes it. Returns false if the version is deleted,
+// in which case the delta is zero.
+bool ReadInt64Delta(absl::string_view* buffer, int64_t* delta) {
+  *delta = ReadVarint(buffer);
+  if (*delta != 0) {
+    return true;
+  }
+  const char kind = buffer->front();
+  buffer->remove_prefix(1);
+  return kind != kDeletedValue;
+}
+
+bool IsInt64Encodable(const zetasql::Value& value) {
+  return !value.is_valid() ||
+         (!value.is_null() && value.type_kind() == zetasql::TYPE_INT64);
+}
+
+}  // namespace
+
+void CellHistory::Add(absl::Time timestamp, zetasql::Value value) {
+  if (size_ == 0 || timestamp > last_timestamp_) {
+    Append(timestamp, std::move(value));
+    return;
+  }
+
+  // Versions are rarely added out of order, so re-encode the whole history.
+  std::vector<Version> versions = Decode();
+  auto itr = std::lower_bound(
+      versions.begin(), versions.end(), timestamp,
+      [](const Version& version, absl::Time t) { return version.first < t; });
+  if (itr != versions.end() && itr->first == timestamp) {
+    itr->second = std::move(value);
+  } else {
+    versions.insert(itr, {timestamp, std::move(value)});
+  }
+  *this = CellHistory();
+  for (auto& [version_timestamp, version_value] : versions) {
+    Append(version_timestamp, std::move(version_value));
+  }
+}
+
+void CellHistory::Append(absl::Time timestamp, zetasql::Value value) {
+  AppendVarint(absl::ToInt64Nanoseconds(timestamp - last_timestamp_),
+               &timestamp_deltas_);
+  last_timestamp_ = timestamp;
+
+  if (int64_encoded_ && !IsInt64Encodable(value)) {
+    values_ = DecodeValues();
+    int64_encoded_ = false;
+    std::string().swap(int64_deltas_);
+  }
+  const bool deleted = !value.is_valid();
+  if (int64_encoded_ && deleted) {
+    AppendInt64Deletion(&int64_deltas_);
+  } else if (int64_encoded_) {
+    // Deltas are computed in unsigned arithmetic, where they wrap around.
+    const int64_t int64_value = value.int64_value();
+    AppendInt64Delta(static_cast<int64_t>(static_cast<uint64_t>(int64_value) -
+                                          static_cast<uint64_t>(last_int64_)),
+                     &int64_deltas_);
+    last_int64_ = int64_value;
+  } else {
+    values_.push_back(std::move(value));
+  }
+  if (size_ % kRestartInterval == 0) {
+    restart_points_.push_back({timestamp, timestamp_deltas_.size(),
+                               last_int64_, deleted, int64_deltas_.size()});
+  }
+  ++size_;
+}
+
+int64_t CellHistory::IndexAt(absl::Time timestamp,
+                             absl::Time* next_timestamp) const {
+  // Find the last restart point at or before the timestamp.
+  auto restart_itr = std::upper_bound(
+      restart_points_.begin(), restart_points_.end(), timestamp,
+      [](absl::Time t, const RestartPoint& restart_point) {
+        return t < restart_point.timestamp;
+      });
+  if (restart_itr == restart_points_.begin()) {
+    *next_timestamp =
+        size_ == 0 ? absl::InfiniteFuture() : restart_itr->timestamp;
+    return -1;
+  }
+  --restart_itr;
+
+  // Decode the versions following it.
+  int64_t index = (restart_itr - restart_points_.begin()) * kRestartInterval;
+  absl::string_view deltas = absl::string_view(timestamp_deltas_)
+                                 .substr(restart_itr->timestamp_offset);
+  absl::Time version_timestamp = restart_itr->timestamp;
+  for (; index + 1 < size_; ++index) {
+    version_timestamp += absl::Nanoseconds(ReadVarint(&deltas));
+    if (version_timestamp > timestamp) {
+      *next_timestamp = version_timestamp;
+      return index;
+    }
+  }
+  *next_timestamp = absl::InfiniteFuture();
+  return index;
+}
+
+zetasql::Value CellHistory::ValueAt(absl::Time timestamp) const {
+  absl::Time next_timestamp;
+  const int64_t index = IndexAt(timestamp, &next_timestamp);
+  if (index < 0) {
+    return zetasql::Value();
+  }
+  if (!int64_encoded_) {
+    return values_[index];
+  }
+  const RestartPoint& restart_point = restart_points_[index / kRestartInterval];
+  absl::string_view deltas =
+      absl::string_view(int64_deltas_).substr(restart_point.int64_offset);
+  uint64_t value = static_cast<uint64_t>(restart_point.int64_value);
+  bool deleted = restart_point.int64_deleted;
+  for (int64_t i = index % kRestartInterval; i > 0; --i) {
+    int64_t delta;
+    deleted = !ReadInt64Delta(&deltas, &delta);
+    value += static_cast<uint64_t>(delta);
+  }
+  if (deleted) {
+    return zetasql::Value();
+  }
+  return zetasql::values::Int64(static_cast<int64_t>(value));
+}
+
+absl::Time CellHistory::NextTimestampAfter(absl::Time timestamp) const {
+  absl::Time next_timestamp;
+  IndexAt(timestamp, &next_timestamp);
+  return next_timestamp;
+}
+
+std::vector<zetasql::Value> CellHistory::DecodeValues() const {
+  if (!int64_encoded_) {
+    return values_;
+  }
+  std::vector<zetasql::Value> values;
+  values.reserve(size_);
+  absl::string_view deltas = int64_deltas_;
+  uint64_t value = 0;
+  for (int64_t i = 0; i < size_; ++i) {
+    int64_t delta;
+    if (!ReadInt64Delta(&deltas, &delta)) {
+      values.push_back(zetasql::Value());
+      continue;
+    }
+    value += static_cast<uint64_t>(delta);
+    values.push_back(zetasql::values::Int64(static_cast<int64_t>(value)));
+  }
+  return values;
+}
+
+std::vector<CellHistory::Version> CellHistory::Decode() const {
+  std::vector<zetasql::Value> values = DecodeValues();
+  std::vector<Version> versions;
+  versions.reserve(size_);
+  absl::string_view deltas = timestamp_deltas_;
+  absl::Time version_timestamp = absl::UnixEpoch();
+  for (int64_t i = 0; i < size_; ++i) {
+    version_timestamp += absl::Nanoseconds(ReadVarint(&deltas));
+    versions.emplace_back(version_timestamp, std::move(values[i]));
+  }
+  return versions;
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,131 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_CELL_HISTORY_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_CELL_HISTORY_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/value.h"
+#include "absl/time/time.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// CellHistory holds the older versions of a storage cell compactly.
+//
+// Cells which are updated frequently (e.g. counters) accumulate many versions,
+// most of which are only read by stale reads. Instead of a map node with a
+// full zetasql::Value per version, the timestamps of the versions are stored
+// as varint-encoded deltas from the previous version in an append-only buffer.
+// As long as all values are non-NULL INT64s, they are encoded the same way, so
+// that a version of a counter typically takes a few bytes. Deletions, which
+// are versions with an invalid value, are flagged in the INT64 encoding, so
+// that deleting and re-inserting a row keeps its counters encoded. Values of
+// other types are kept as-is.
+//
+// Versions are usually added in timestamp order and appended. Adding a version
+// older than the newest one re-encodes the history. Every kRestartInterval-th
+// version is also recorded decoded, with its position in the buffers, as a
+// restart point. Lookups binary search the restart points and decode the
+// versions following the closest one, so that stale reads of long histories
+// take logarithmic rather than linear time, at the cost of a restart point
+// every kRestartInterval versions.
+//
+// This class is not thread-safe.
+class CellHistory {
+ public:
+  // Sets the value of the version at the given timestamp.
+  void Add(absl::Time timestamp, zetasql::Value value);
+
+  // Returns the value of the last version at or before the given timestamp, or
+  // an invalid value if there is none.
+  zetasql::Value ValueAt(absl::Time timestamp) const;
+
+  // Returns the timestamp of the first version after the given timestamp, or
+  // absl::InfiniteFuture() if there is none.
+  absl::Time NextTimestampAfter(absl::Time timestamp) const;
+
+  // Returns the number of versions.
+  int64_t size() const { return size_; }
+
+  // Returns true if the values are delta encoded as INT64s.
+  bool int64_encoded() const { return int64_encoded_; }
+
+ private:
+  using Version = std::pair<absl::Time, zetasql::Value>;
+
+  // Number of versions between consecutive restart points.
+  static constexpr int64_t kRestartInterval = 16;
+
+  // A version decoded, and the offsets in the buffers of the deltas of the
+  // version following it.
+  struct RestartPoint {
+    absl::Time timestamp;
+    size_t timestamp_offset;
+    // Only set while the values are int64 encoded: the value of the version,
+    // or of the last version before it which was not deleted, and whether the
+    // version is deleted.
+    int64_t int64_value;
+    bool int64_deleted;
+    size_t int64_offset;
+  };
+
+  // Appends a version newer than all others.
+  void Append(absl::Time timestamp, zetasql::Value value);
+
+  // Returns the index of the last version at or before the given timestamp,
+  // or -1 if there is none, and sets 'next_timestamp' to the timestamp of the
+  // version after it, or to absl::InfiniteFuture() if there is none.
+  int64_t IndexAt(absl::Time timestamp, absl::Time* next_timestamp) const;
+
+  // Returns all the values, in timestamp order.
+  std::vector<zetasql::Value> DecodeValues() const;
+
+  // Returns all the versions, in timestamp order.
+  std::vector<Version> Decode() const;
+
+  // Number of versions.
+  int64_t size_ = 0;
+
+  // Deltas between the timestamps of consecutive versions, the first relative
+  // to the Unix epoch, and the timestamp of the newest version.
+  std::string timestamp_deltas_;
+  absl::Time last_timestamp_ = absl::UnixEpoch();
+
+  // If all values are non-NULL INT64s or invalid, deltas between consecutive
+  // valid values (the first relative to zero), with deleted versions flagged,
+  // and the newest valid value. Otherwise the values as-is.
+  bool int64_encoded_ = true;
+  std::string int64_deltas_;
+  int64_t last_int64_ = 0;
+  std::vector<zetasql::Value> values_;
+
+  // Restart points of versions 0, kRestartInterval, 2 * kRestartInterval...
+  std::vector<RestartPoint> restart_points_;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_CELL_HISTORY_H_
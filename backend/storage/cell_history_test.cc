@@ -0,0 +1,190 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/storage/cell_history.h"
+
+#include <cstdint>
+#include <limits>
+
+#include "zetasql/public/value.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using zetasql::values::Int64;
+using zetasql::values::NullInt64;
+using zetasql::values::String;
+
+TEST(CellHistoryTest, ReturnsValueOfLastVersionAtTimestamp) {
+  absl::Time t0 = absl::FromUnixSeconds(1000);
+  CellHistory history;
+  for (int i = 0; i < 100; ++i) {
+    history.Add(t0 + absl::Microseconds(10 * i), Int64(1000 + i));
+  }
+  EXPECT_EQ(history.size(), 100);
+
+  EXPECT_FALSE(history.ValueAt(t0 - absl::Microseconds(1)).is_valid());
+  EXPECT_EQ(history.ValueAt(t0), Int64(1000));
+  EXPECT_EQ(history.ValueAt(t0 + absl::Microseconds(15)), Int64(1001));
+  EXPECT_EQ(history.ValueAt(t0 + absl::Hours(1)), Int64(1099));
+}
+
+TEST(CellHistoryTest, ReturnsNextTimestampAfterTimestamp) {
+  absl::Time t0 = absl::FromUnixSeconds(1000);
+  CellHistory history;
+  history.Add(t0, Int64(1));
+  history.Add(t0 + absl::Seconds(1), Int64(2));
+
+  EXPECT_EQ(history.NextTimestampAfter(t0 - absl::Seconds(1)), t0);
+  EXPECT_EQ(history.NextTimestampAfter(t0), t0 + absl::Seconds(1));
+  EXPECT_EQ(history.NextTimestampAfter(t0 + absl::Seconds(1)),
+            absl::InfiniteFuture());
+}
+
+TEST(CellHistoryTest, EncodesExtremeInt64Values) {
+  absl::Time t0 = absl::FromUnixSeconds(1000);
+  CellHistory history;
+  history.Add(t0, Int64(std::numeric_limits<int64_t>::max()));
+  history.Add(t0 + absl::Seconds(1),
+              Int64(std::numeric_limits<int64_t>::min()));
+  history.Add(t0 + absl::Seconds(2), Int64(-1));
+
+  EXPECT_EQ(history.ValueAt(t0), Int64(std::numeric_limits<int64_t>::max()));
+  EXPECT_EQ(history.ValueAt(t0 + absl::Seconds(1)),
+            Int64(std::numeric_limits<int64_t>::min()));
+  EXPECT_EQ(history.ValueAt(t0 + absl::Seconds(2)), Int64(-1));
+}
+
+TEST(CellHistoryTest, KeepsValuesOfOtherTypes) {
+  absl::Time t0 = absl::FromUnixSeconds(1000);
+  CellHistory history;
+  history.Add(t0, Int64(1));
+  history.Add(t0 + absl::Seconds(1), NullInt64());
+  history.Add(t0 + absl::Seconds(2), String("two"));
+  history.Add(t0 + absl::Seconds(3), zetasql::Value());
+
+  EXPECT_EQ(history.ValueAt(t0), Int64(1));
+  EXPECT_EQ(history.ValueAt(t0 + absl::Seconds(1)), NullInt64());
+  EXPECT_EQ(history.ValueAt(t0 + absl::Seconds(2)), String("two"));
+  EXPECT_FALSE(history.ValueAt(t0 + absl::Seconds(3)).is_valid());
+}
+
+TEST(CellHistoryTest, KeepsInt64EncodingAcrossDeletions) {
+  absl::Time t0 = absl::FromUnixSeconds(1000);
+  CellHistory history;
+  // Deletions land on restart points and between them, and values repeat.
+  for (int i = 0; i < 40; ++i) {
+    history.Add(t0 + absl::Seconds(i),
+                i % 8 == 0 ? zetasql::Value() : Int64(i / 3));
+  }
+  EXPECT_TRUE(history.int64_encoded());
+
+  for (int i = 0; i < 40; ++i) {
+    const zetasql::Value value = history.ValueAt(t0 + absl::Seconds(i));
+    if (i % 8 == 0) {
+      EXPECT_FALSE(value.is_valid());
+    } else {
+      EXPECT_EQ(value, Int64(i / 3));
+    }
+  }
+
+  // Re-encoding the history out of order keeps the deletions.
+  history.Add(t0 - absl::Seconds(1), Int64(7));
+  EXPECT_TRUE(history.int64_encoded());
+  EXPECT_EQ(history.ValueAt(t0 - absl::Seconds(1)), Int64(7));
+  EXPECT_FALSE(history.ValueAt(t0).is_valid());
+  EXPECT_EQ(history.ValueAt(t0 + absl::Seconds(1)), Int64(0));
+  EXPECT_FALSE(history.ValueAt(t0 + absl::Seconds(32)).is_valid());
+  EXPECT_EQ(history.ValueAt(t0 + absl::Seconds(39)), Int64(13));
+}
+
+TEST(CellHistoryTest, AddsVersionsOutOfOrder) {
+  absl::Time t0 = absl::FromUnixSeconds(1000);
+  CellHistory history;
+  history.Add(t0 + absl::Seconds(2), Int64(2));
+  history.Add(t0, Int64(0));
+  history.Add(t0 + absl::Seconds(1), Int64(1));
+  history.Add(t0 + absl::Seconds(2), Int64(20));
+  EXPECT_EQ(history.size(), 3);
+
+  EXPECT_EQ(history.ValueAt(t0), Int64(0));
+  EXPECT_EQ(history.ValueAt(t0 + absl::Seconds(1)), Int64(1));
+  EXPECT_EQ(history.ValueAt(t0 + absl::Seconds(2)), Int64(20));
+}
+
+TEST(CellHistoryTest, LooksUpEveryVersionAcrossRestartPoints) {
+  absl::Time t0 = absl::FromUnixSeconds(1000);
+  CellHistory history;
+  for (int i = 0; i < 100; ++i) {
+    history.Add(t0 + absl::Seconds(i), Int64(i * i - 50));
+  }
+
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(history.ValueAt(t0 + absl::Seconds(i)), Int64(i * i - 50));
+    EXPECT_EQ(history.ValueAt(t0 + absl::Seconds(i) + absl::Milliseconds(1)),
+              Int64(i * i - 50));
+    EXPECT_EQ(history.NextTimestampAfter(t0 + absl::Seconds(i) -
+                                         absl::Milliseconds(1)),
+              t0 + absl::Seconds(i));
+  }
+  EXPECT_EQ(history.NextTimestampAfter(t0 + absl::Seconds(99)),
+            absl::InfiniteFuture());
+}
+
+TEST(CellHistoryTest, LooksUpVersionsAddedOutOfOrderAcrossRestartPoints) {
+  absl::Time t0 = absl::FromUnixSeconds(1000);
+  CellHistory history;
+  for (int i = 0; i < 40; i += 2) {
+    history.Add(t0 + absl::Seconds(i), Int64(i));
+  }
+  for (int i = 1; i < 40; i += 2) {
+    history.Add(t0 + absl::Seconds(i), Int64(i));
+  }
+  EXPECT_EQ(history.size(), 40);
+
+  for (int i = 0; i < 40; ++i) {
+    EXPECT_EQ(history.ValueAt(t0 + absl::Seconds(i)), Int64(i));
+    EXPECT_EQ(history.NextTimestampAfter(t0 + absl::Seconds(i)),
+              i + 1 < 40 ? t0 + absl::Seconds(i + 1) : absl::InfiniteFuture());
+  }
+}
+
+TEST(CellHistoryTest, LooksUpValuesOfOtherTypesAcrossRestartPoints) {
+  absl::Time t0 = absl::FromUnixSeconds(1000);
+  CellHistory history;
+  for (int i = 0; i < 20; ++i) {
+    history.Add(t0 + absl::Seconds(i), Int64(i));
+  }
+  for (int i = 20; i < 40; ++i) {
+    history.Add(t0 + absl::Seconds(i), String("value"));
+  }
+
+  EXPECT_EQ(history.ValueAt(t0 + absl::Seconds(17)), Int64(17));
+  EXPECT_EQ(history.ValueAt(t0 + absl::Seconds(19)), Int64(19));
+  EXPECT_EQ(history.ValueAt(t0 + absl::Seconds(35)), String("value"));
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -16,9 +16,17 @@
 
 #include "backend/storage/in_memory_storage.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <memory>
+#include <utility>
+#include <vector>
 
+#include "zetasql/public/type.h"
 #include "zetasql/public/value.h"
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "backend/storage/in_memory_iterator.h"
@@ -34,39 +42,201 @@ namespace {
 
 static constexpr char kExistsColumn[] = "_exists";
 
+// Minimum number of rows materialized by each thread of a parallel read. Reads
+// of fewer rows than twice this are materialized on the calling thread.
+static constexpr int64_t kMinRowsPerReadSplit = 8192;
+
+// Number of keys sampled per table for its key histogram.
+static constexpr int64_t kKeySampleSize = 128;
+
 }  // namespace
 
+size_t InMemoryStorage::KeyHash::operator()(const Key& key) const {
+  // Keys are equal if their columns are equal, which Value::HashCode is
+  // consistent with.
+  size_t hash = key.NumColumns();
+  for (const zetasql::Value& value : key.column_values()) {
+    hash = absl::Hash<std::pair<size_t, uint64_t>>()({hash, value.HashCode()});
+  }
+  return hash;
+}
+
+std::vector<int> InMemoryStorage::FindColumnIndexes(
+    const Table& table, const std::vector<ColumnID>& column_ids) {
+  std::vector<int> column_indexes;
+  column_indexes.reserve(column_ids.size());
+  for (const ColumnID& column_id : column_ids) {
+    auto index_itr = table.column_indexes.find(column_id);
+    column_indexes.push_back(
+        index_itr == table.column_indexes.end() ? -1 : index_itr->second);
+  }
+  return column_indexes;
+}
+
+int InMemoryStorage::FindOrAddColumnIndex(Table* table,
+                                          const ColumnID& column_id) {
+  auto [index_itr, inserted] =
+      table->column_indexes.try_emplace(column_id, table->columns.size());
+  if (inserted) {
+    table->columns.emplace_back();
+  }
+  return index_itr->second;
+}
+
 zetasql::Value InMemoryStorage::GetCellValueAtTimestamp(
-    const Row& row, const ColumnID& column_id, absl::Time timestamp) const {
-  // Perform the lookup for given cell.
-  auto cell_itr = row.find(column_id);
-  if (cell_itr == row.end()) {
+    const Table& table, const Row& row, int column_index,
+    absl::Time timestamp) {
+  if (column_index < 0) {
     return zetasql::Value();
   }
-  const Cell& cell = cell_itr->second;
-  auto val_itr = cell.upper_bound(timestamp);
 
-  // Timestamp is earlier than the time the cell was first written to.
-  if (val_itr == cell.begin()) {
+  // Most reads are of the latest version of the cell.
+  const Column& column = table.columns[column_index];
+  if (row.row_id < column.timestamps.size() &&
+      column.timestamps[row.row_id] <= timestamp) {
+    return column.values[row.row_id];
+  }
+
+  // Perform the lookup for given cell in the older versions.
+  auto cell_itr = row.history.find(column_index);
+  if (cell_itr == row.history.end()) {
     return zetasql::Value();
   }
+  return cell_itr->second.ValueAt(timestamp);
+}
+
+zetasql::Value InMemoryStorage::EncodeValue(Table* table,
+                                               const ColumnID& column_id,
+                                               const zetasql::Value& value) {
+  if (!value.is_valid() || value.is_null() ||
+      value.type_kind() != zetasql::TYPE_STRING) {
+    return value;
+  }
+  return table->dictionaries[column_id].Intern(value);
+}
 
-  // Fetch the value from the column.
-  --val_itr;
-  return val_itr->second;
+int64_t InMemoryStorage::VersionSizeInBytes(const Table& table,
+                                            const Row& row, int column_index,
+                                            absl::Time timestamp) {
+  const Column& column = table.columns[column_index];
+  if (row.row_id < column.timestamps.size() &&
+      column.timestamps[row.row_id] == timestamp) {
+    return EstimateSizeInBytes(column.values[row.row_id]);
+  }
+  auto cell_itr = row.history.find(column_index);
+  if (cell_itr == row.history.end() ||
+      cell_itr->second.NextTimestampAfter(timestamp - absl::Nanoseconds(1)) !=
+          timestamp) {
+    return 0;
+  }
+  return EstimateSizeInBytes(cell_itr->second.ValueAt(timestamp));
+}
+
+absl::Time InMemoryStorage::SetCellValue(Table* table, Row* row,
+                                         int column_index,
+                                         absl::Time timestamp,
+                                         zetasql::Value value) {
+  Column& column = table->columns[column_index];
+  if (row->row_id >= column.timestamps.size()) {
+    column.timestamps.resize(row->row_id + 1, absl::InfiniteFuture());
+    column.values.resize(row->row_id + 1);
+  }
+  absl::Time& latest_timestamp = column.timestamps[row->row_id];
+  zetasql::Value& latest_value = column.values[row->row_id];
+  if (latest_timestamp == absl::InfiniteFuture() ||
+      timestamp == latest_timestamp) {
+    latest_timestamp = timestamp;
+    latest_value = std::move(value);
+  } else if (timestamp > latest_timestamp) {
+    row->history[column_index].Add(latest_timestamp, std::move(latest_value));
+    latest_timestamp = timestamp;
+    latest_value = std::move(value);
+  } else {
+    // Only writes older than the latest version need to look up the history
+    // for the version following them.
+    CellHistory& history = row->history[column_index];
+    history.Add(timestamp, std::move(value));
+    const absl::Time next_timestamp = history.NextTimestampAfter(timestamp);
+    return next_timestamp == absl::InfiniteFuture() ? latest_timestamp
+                                                    : next_timestamp;
+  }
+  return absl::InfiniteFuture();
 }
 
-bool InMemoryStorage::Exists(const Row& row, absl::Time timestamp) const {
+bool InMemoryStorage::Exists(const Table& table, const Row& row,
+                             absl::Time timestamp) {
   zetasql::Value value =
-      GetCellValueAtTimestamp(row, kExistsColumn, timestamp);
+      GetCellValueAtTimestamp(table, row, kExistsColumnIndex, timestamp);
   return value.is_valid() && value.bool_value();
 }
 
+Key InMemoryStorage::InterleavedKey(const Interleaving& interleaving,
+                                    const Key& key) {
+  if (interleaving.tags.empty() || key.IsInfinity()) {
+    return key;
+  }
+  Key interleaved_key;
+  int ancestor = 0;
+  for (int i = 0; i < key.NumColumns(); ++i) {
+    interleaved_key.AddColumn(key.ColumnValue(i), key.IsColumnDescending(i));
+    if (ancestor < interleaving.ancestor_key_sizes.size() &&
+        i + 1 == interleaving.ancestor_key_sizes[ancestor]) {
+      interleaved_key.AddColumn(
+          zetasql::values::Int64(interleaving.tags[ancestor++]));
+    }
+  }
+  return key.IsPrefixLimit() ? interleaved_key.ToPrefixLimit()
+                             : interleaved_key;
+}
+
+Key InMemoryStorage::KeyspaceKey(const Table& table, const Key& key) {
+  return InterleavedKey(table.interleaving, key);
+}
+
+InMemoryStorage::Splits::iterator InMemoryStorage::FindSplit(
+    Table* table, const Key& key) {
+  // The first split starts at the empty key, which precedes all keys.
+  return std::prev(table->splits.upper_bound(key));
+}
+
+const InMemoryStorage::Table* InMemoryStorage::FindTable(
+    const TableID& table_id) const {
+  auto table_itr = tables_.find(table_id);
+  return table_itr == tables_.end() ? nullptr : &table_itr->second;
+}
+
+InMemoryStorage::Table* InMemoryStorage::FindTable(const TableID& table_id) {
+  auto table_itr = tables_.find(table_id);
+  return table_itr == tables_.end() ? nullptr : &table_itr->second;
+}
+
+InMemoryStorage::Table* InMemoryStorage::FindOrCreateTable(
+    const TableID& table_id) {
+  auto [table_itr, inserted] = tables_.try_emplace(table_id);
+  Table* table = &table_itr->second;
+  if (inserted) {
+    FindOrAddColumnIndex(table, kExistsColumn);
+    table->splits.emplace(Key(), Split());
+  }
+  return table;
+}
+
+void InMemoryStorage::AddTableIfMissing(const TableID& table_id) {
+  {
+    absl::ReaderMutexLock lock(&mu_);
+    if (FindTable(table_id) != nullptr) {
+      return;
+    }
+  }
+  absl::MutexLock lock(&mu_);
+  FindOrCreateTable(table_id);
+}
+
 absl::Status InMemoryStorage::Lookup(
     absl::Time timestamp, const TableID& table_id, const Key& key,
     const std::vector<ColumnID>& column_ids,
     std::vector<zetasql::Value>* values) const {
-  absl::MutexLock lock(&mu_);
+  absl::ReaderMutexLock tables_lock(&mu_);
 
   // Validate the request.
   if (!column_ids.empty() && values == nullptr) {
@@ -79,18 +249,19 @@ absl::Status InMemoryStorage::Lookup(
   }
 
   // Lookup for given table.
-  auto table_itr = tables_.find(table_id);
-  if (table_itr == tables_.end()) {
+  const Table* table_ptr = FindTable(table_id);
+  if (table_ptr == nullptr) {
     return absl::Status(
         absl::StatusCode::kNotFound,
         absl::StrCat("Key: ", key.DebugString(), " not found for table: ",
                      table_id, " at timestamp: ", absl::FormatTime(timestamp)));
   }
-  const Table& table = table_itr->second;
+  const Table& table = *table_ptr;
+  absl::ReaderMutexLock table_lock(table.keyspace_mu);
 
   // Lookup for given key.
-  auto row_itr = table.find(key);
-  if (row_itr == table.end()) {
+  auto row_itr = table.rows.find(key);
+  if (row_itr == table.rows.end()) {
     return absl::Status(
         absl::StatusCode::kNotFound,
         absl::StrCat("Key: ", key.DebugString(), " not found for table: ",
@@ -99,7 +270,7 @@ absl::Status InMemoryStorage::Lookup(
   const Row& row = row_itr->second;
 
   // Verify if the row exists at the given timestamp.
-  if (!Exists(row, timestamp)) {
+  if (!Exists(table, row, timestamp)) {
     return absl::Status(
         absl::StatusCode::kNotFound,
         absl::StrCat(
@@ -113,9 +284,9 @@ absl::Status InMemoryStorage::Lookup(
   }
 
   // Fetch the value from the cell at the given timestamp.
-  for (int i = 0; i < column_ids.size(); ++i) {
+  for (int column_index : FindColumnIndexes(table, column_ids)) {
     values->emplace_back(
-        GetCellValueAtTimestamp(row, column_ids[i], timestamp));
+        GetCellValueAtTimestamp(table, row, column_index, timestamp));
   }
 
   return absl::OkStatus();
@@ -125,7 +296,7 @@ absl::Status InMemoryStorage::Read(
     absl::Time timestamp, const TableID& table_id, const KeyRange& key_range,
     const std::vector<ColumnID>& column_ids,
     std::unique_ptr<StorageIterator>* itr) const {
-  absl::MutexLock lock(&mu_);
+  absl::ReaderMutexLock tables_lock(&mu_);
 
   // Validate the request.
   if (!key_range.IsClosedOpen()) {
@@ -143,30 +314,291 @@ absl::Status InMemoryStorage::Read(
   }
 
   // Lookup for given table.
-  auto table_itr = tables_.find(table_id);
-  if (table_itr == tables_.end()) {
+  const Table* table_ptr = FindTable(table_id);
+  if (table_ptr == nullptr) {
+    *itr = absl::make_unique<FixedRowStorageIterator>();
+    return absl::OkStatus();
+  }
+  const Table& table = *table_ptr;
+  absl::ReaderMutexLock table_lock(table.keyspace_mu);
+
+  // Reads of a key prefix which was never written, e.g. of the children of a
+  // parent without any, are answered without searching the table.
+  if (enable_prefix_filters_ &&
+      key_range.limit_key() == key_range.start_key().ToPrefixLimit() &&
+      !table.prefix_filter.MayContainPrefix(key_range.start_key())) {
     *itr = absl::make_unique<FixedRowStorageIterator>();
     return absl::OkStatus();
   }
-  const Table& table = table_itr->second;
+
+  // Resolve the requested columns once, so that materializing a row only
+  // indexes the value vectors of the columns read.
+  const std::vector<int> column_indexes = FindColumnIndexes(table, column_ids);
 
   // Lookup keys from the given key range.
-  auto row_start_itr = table.lower_bound(key_range.start_key());
-  auto row_end_itr = table.lower_bound(key_range.limit_key());
-  for (auto itr = row_start_itr; itr != row_end_itr; ++itr) {
-    const InMemoryStorage::Row& row = itr->second;
-    if (!Exists(row, timestamp)) {
+  const OrderedRows& keyspace = *table.keyspace;
+  auto row_start_itr =
+      keyspace.lower_bound(KeyspaceKey(table, key_range.start_key()));
+  auto row_end_itr =
+      keyspace.lower_bound(KeyspaceKey(table, key_range.limit_key()));
+
+  // Estimate the number of rows in the key range from the sizes of the table
+  // splits it overlaps, rather than counting them, and collect the start keys
+  // of the splits after the first one.
+  int64_t num_rows = 0;
+  std::vector<const Key*> split_keys;
+  auto table_split_itr = table.splits.upper_bound(key_range.start_key());
+  num_rows += std::prev(table_split_itr)->second.num_entries;
+  for (; table_split_itr != table.splits.end() &&
+         table_split_itr->first < key_range.limit_key();
+       ++table_split_itr) {
+    split_keys.push_back(&table_split_itr->first);
+    num_rows += table_split_itr->second.num_entries;
+  }
+  const int64_t num_table_splits = split_keys.size() + 1;
+  const int64_t num_splits =
+      std::min({static_cast<int64_t>(read_parallelism_), num_table_splits,
+                num_rows / kMinRowsPerReadSplit});
+  if (num_splits < 2) {
+    MaterializeRows(table, row_start_itr, row_end_itr, timestamp,
+                    column_indexes, &rows);
+    *itr = absl::make_unique<FixedRowStorageIterator>(std::move(rows));
+    return absl::OkStatus();
+  }
+
+  // Split the key range into contiguous sub-ranges of whole table splits,
+  // materialize them on the read pool and concatenate them in order. The
+  // workers only read the table, which is kept stable by holding its lock.
+  std::vector<OrderedRows::const_iterator> split_bounds = {row_start_itr};
+  for (int64_t i = 1; i < num_splits; ++i) {
+    const Key& split_key = *split_keys[i * num_table_splits / num_splits - 1];
+    split_bounds.push_back(keyspace.lower_bound(KeyspaceKey(table, split_key)));
+  }
+  split_bounds.push_back(row_end_itr);
+
+  std::vector<std::vector<FixedRowStorageIterator::Row>> split_rows(num_splits);
+  read_pool_.ParallelFor(num_splits, [&](int64_t i) {
+    MaterializeRows(table, split_bounds[i], split_bounds[i + 1], timestamp,
+                    column_indexes, &split_rows[i]);
+  });
+
+  int64_t num_existing_rows = 0;
+  for (const auto& split : split_rows) {
+    num_existing_rows += split.size();
+  }
+  rows.reserve(num_existing_rows);
+  for (auto& split : split_rows) {
+    std::move(split.begin(), split.end(), std::back_inserter(rows));
+  }
+  *itr = absl::make_unique<FixedRowStorageIterator>(std::move(rows));
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryStorage::CountRows(absl::Time timestamp,
+                                        const TableID& table_id,
+                                        int64_t* count) const {
+  absl::ReaderMutexLock tables_lock(&mu_);
+
+  *count = 0;
+  const Table* table = FindTable(table_id);
+  if (table == nullptr) {
+    return absl::OkStatus();
+  }
+  absl::ReaderMutexLock table_lock(table->keyspace_mu);
+  const RowCounts& counts = table->row_counts;
+  auto count_itr = counts.upper_bound(timestamp);
+  if (count_itr != counts.begin()) {
+    *count = std::prev(count_itr)->second;
+  }
+  return absl::OkStatus();
+}
+
+void InMemoryStorage::AddToPrefixFilter(Table* table, const Key& key) const {
+  if (!enable_prefix_filters_) {
+    return;
+  }
+  table->prefix_filter.Add(key);
+  if (table->prefix_filter.IsFull()) {
+    // Rebuild the filter with twice the capacity to keep its false positive
+    // rate low. Doubling keeps the cost of rebuilds amortized constant per key.
+    KeyPrefixFilter filter(2 * table->prefix_filter.capacity());
+    for (const auto& [row_key, row] : table->rows) {
+      filter.Add(row_key);
+    }
+    table->prefix_filter = std::move(filter);
+  }
+}
+
+void InMemoryStorage::AddToKeySample(Table* table, const Key& key) {
+  // Reservoir sampling: the n-th key replaces a random sampled key with
+  // probability kKeySampleSize / n, which keeps the sample uniform.
+  if (static_cast<int64_t>(table->key_sample.size()) < kKeySampleSize) {
+    table->key_sample.push_back(key);
+    return;
+  }
+  const int64_t index =
+      absl::Uniform<int64_t>(table->bitgen, 0,
+                             static_cast<int64_t>(table->rows.size()));
+  if (index < kKeySampleSize) {
+    table->key_sample[index] = key;
+  }
+}
+
+void InMemoryStorage::AdjustRowCount(Table* table, absl::Time timestamp,
+                                     absl::Time next_change_timestamp,
+                                     int64_t delta) {
+  RowCounts& counts = table->row_counts;
+  // Adds an entry at the given timestamp, carrying over the count before it.
+  auto add_entry = [&counts](absl::Time entry_timestamp) {
+    auto itr = counts.upper_bound(entry_timestamp);
+    int64_t count = itr == counts.begin() ? 0 : std::prev(itr)->second;
+    return counts.emplace(entry_timestamp, count).first;
+  };
+
+  // Rows are usually written at increasing timestamps, in which case this only
+  // updates the last entry.
+  auto start_itr = add_entry(timestamp);
+  auto end_itr = next_change_timestamp == absl::InfiniteFuture()
+                     ? counts.end()
+                     : add_entry(next_change_timestamp);
+  for (auto itr = start_itr; itr != end_itr; ++itr) {
+    itr->second += delta;
+  }
+}
+
+void InMemoryStorage::MaterializeRows(
+    const Table& table, OrderedRows::const_iterator begin,
+    OrderedRows::const_iterator end, absl::Time timestamp,
+    const std::vector<int>& column_indexes,
+    std::vector<FixedRowStorageIterator::Row>* rows) {
+  for (auto itr = begin; itr != end; ++itr) {
+    // Skip the rows of the other tables sharing the keyspace.
+    if (itr->table != &table) {
+      continue;
+    }
+    const InMemoryStorage::Row& row = itr->entry->second;
+    if (!Exists(table, row, timestamp)) {
       continue;
     }
 
     std::vector<zetasql::Value> values;
-    values.reserve(column_ids.size());
-    for (const ColumnID& column_id : column_ids) {
-      values.emplace_back(GetCellValueAtTimestamp(row, column_id, timestamp));
+    values.reserve(column_indexes.size());
+    for (int column_index : column_indexes) {
+      values.emplace_back(
+          GetCellValueAtTimestamp(table, row, column_index, timestamp));
     }
-    rows.emplace_back(std::make_pair(itr->first, values));
+    rows->emplace_back(std::make_pair(itr->entry->first, values));
+  }
+}
+
+absl::Status InMemoryStorage::GetTableStats(const TableID& table_id,
+                                            TableStats* stats) const {
+  absl::ReaderMutexLock tables_lock(&mu_);
+
+  *stats = TableStats();
+  const Table* table = FindTable(table_id);
+  if (table == nullptr) {
+    return absl::OkStatus();
+  }
+  absl::ReaderMutexLock table_lock(table->keyspace_mu);
+  stats->byte_size = table->byte_size;
+  stats->key_sample = table->key_sample;
+  std::sort(stats->key_sample.begin(), stats->key_sample.end());
+  if (!table->row_counts.empty()) {
+    stats->row_count = table->row_counts.rbegin()->second;
   }
-  *itr = absl::make_unique<FixedRowStorageIterator>(std::move(rows));
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryStorage::GetTableSplits(
+    const TableID& table_id, std::vector<TableSplit>* splits) const {
+  absl::ReaderMutexLock tables_lock(&mu_);
+
+  splits->clear();
+  const Table* table = FindTable(table_id);
+  if (table == nullptr) {
+    splits->push_back(TableSplit());
+    return absl::OkStatus();
+  }
+  absl::ReaderMutexLock table_lock(table->keyspace_mu);
+  splits->reserve(table->splits.size());
+  for (const auto& [start_key, split] : table->splits) {
+    splits->push_back(TableSplit{start_key, split.row_count, split.byte_size});
+  }
+  return absl::OkStatus();
+}
+
+void InMemoryStorage::DivideSplitIfFull(Table* table,
+                                        Splits::iterator split_itr) const {
+  Split& split = split_itr->second;
+  if (split.num_entries <= max_rows_per_split_) {
+    return;
+  }
+
+  // Find the middle row of the split, and the statistics of the rows from it
+  // to the end of the split, which form the new split.
+  const OrderedRows& keyspace = *table->keyspace;
+  auto next_split_itr = std::next(split_itr);
+  auto row_itr = keyspace.lower_bound(KeyspaceKey(*table, split_itr->first));
+  auto row_end_itr =
+      next_split_itr == table->splits.end()
+          ? keyspace.end()
+          : keyspace.lower_bound(KeyspaceKey(*table, next_split_itr->first));
+  const int64_t num_lower_entries = split.num_entries / 2;
+  int64_t num_entries = 0;
+  const Key* middle_key = nullptr;
+  Split upper_split;
+  for (; row_itr != row_end_itr; ++row_itr) {
+    // Skip the rows of the other tables sharing the keyspace.
+    if (row_itr->table != table || num_entries++ < num_lower_entries) {
+      continue;
+    }
+    if (middle_key == nullptr) {
+      middle_key = &row_itr->entry->first;
+    }
+    ++upper_split.num_entries;
+    if (Exists(*table, row_itr->entry->second, absl::InfiniteFuture())) {
+      ++upper_split.row_count;
+    }
+  }
+  if (middle_key == nullptr) {
+    return;
+  }
+
+  // Sizes are not tracked per row, so the bytes are divided in proportion to
+  // the number of rows.
+  upper_split.byte_size =
+      split.byte_size * upper_split.num_entries / split.num_entries;
+  split.num_entries -= upper_split.num_entries;
+  split.row_count -= upper_split.row_count;
+  split.byte_size -= upper_split.byte_size;
+  table->splits.emplace_hint(next_split_itr, *middle_key, upper_split);
+}
+
+absl::Status InMemoryStorage::InterleaveTable(const TableID& child_table_id,
+                                              const TableID& parent_table_id,
+                                              int parent_key_size) {
+  absl::MutexLock lock(&mu_);
+
+  if (!interleave_tables_) {
+    return absl::OkStatus();
+  }
+  Table& parent = *FindOrCreateTable(parent_table_id);
+  Table& child = *FindOrCreateTable(child_table_id);
+  if (child.keyspace == parent.keyspace) {
+    return absl::OkStatus();
+  }
+  if (!child.rows.empty()) {
+    return error::Internal(absl::StrCat(
+        "InMemoryStorage::InterleaveTable should be called before rows are "
+        "written, found rows in table: ",
+        child_table_id));
+  }
+  child.interleaving = parent.interleaving;
+  child.interleaving.ancestor_key_sizes.push_back(parent_key_size);
+  child.interleaving.tags.push_back(++last_interleaving_tag_);
+  child.keyspace = parent.keyspace;
+  child.keyspace_mu = parent.keyspace_mu;
   return absl::OkStatus();
 }
 
@@ -174,20 +606,57 @@ absl::Status InMemoryStorage::Write(
     absl::Time timestamp, const TableID& table_id, const Key& key,
     const std::vector<ColumnID>& column_ids,
     const std::vector<zetasql::Value>& values) {
-  absl::MutexLock lock(&mu_);
-
   // Add the table if it does not exist.
-  Table& table = tables_[table_id];
+  AddTableIfMissing(table_id);
+  absl::ReaderMutexLock tables_lock(&mu_);
+  Table& table = *FindTable(table_id);
+  absl::MutexLock table_lock(table.keyspace_mu);
 
   // Add the row with _exists system column if it does not exist.
-  Row& row = table[key];
-  if (!Exists(row, timestamp)) {
-    row[kExistsColumn][timestamp] = zetasql::values::Bool(true);
+  auto [row_itr, inserted] = table.rows.try_emplace(key);
+  Row& row = row_itr->second;
+  Splits::iterator split_itr = FindSplit(&table, key);
+  Split& split = split_itr->second;
+  if (inserted) {
+    ++split.num_entries;
+    row.row_id = table.rows.size() - 1;
+    if (!table.interleaving.tags.empty()) {
+      row.interleaved_key =
+          absl::make_unique<const Key>(KeyspaceKey(table, key));
+    }
+    table.keyspace->insert({&*row_itr, &table});
+    AddToPrefixFilter(&table, key);
+    AddToKeySample(&table, key);
+  }
+  if (!Exists(table, row, timestamp)) {
+    const absl::Time next_change_timestamp =
+        SetCellValue(&table, &row, kExistsColumnIndex, timestamp,
+                     zetasql::values::Bool(true));
+    AdjustRowCount(&table, timestamp, next_change_timestamp, 1);
+    if (next_change_timestamp == absl::InfiniteFuture()) {
+      ++split.row_count;
+    }
   }
 
-  // Add the values for the given columns.
+  // Add the values for the given columns. Values overwritten at the same
+  // timestamp no longer take space.
+  int64_t bytes = EstimateSizeInBytes(inserted ? key : Key(), values);
   for (int i = 0; i < column_ids.size(); ++i) {
-    row[column_ids[i]][timestamp] = values[i];
+    const int column_index = FindOrAddColumnIndex(&table, column_ids[i]);
+    bytes -= VersionSizeInBytes(table, row, column_index, timestamp);
+    SetCellValue(&table, &row, column_index, timestamp,
+                 EncodeValue(&table, column_ids[i], values[i]));
+  }
+
+  table.byte_size += bytes;
+  split.byte_size += bytes;
+  DivideSplitIfFull(&table, split_itr);
+  if (memory_tracker_ != nullptr) {
+    if (bytes >= 0) {
+      memory_tracker_->Allocate(bytes);
+    } else {
+      memory_tracker_->Release(-bytes);
+    }
   }
 
   return absl::OkStatus();
@@ -196,7 +665,7 @@ absl::Status InMemoryStorage::Write(
 absl::Status InMemoryStorage::Delete(absl::Time timestamp,
                                      const TableID& table_id,
                                      const KeyRange& key_range) {
-  absl::MutexLock lock(&mu_);
+  absl::ReaderMutexLock tables_lock(&mu_);
 
   if (!key_range.IsClosedOpen()) {
     return error::Internal(
@@ -209,35 +678,178 @@ absl::Status InMemoryStorage::Delete(absl::Time timestamp,
   }
 
   // Lookup for given table.
-  auto table_itr = tables_.find(table_id);
-  if (table_itr == tables_.end()) {
+  Table* table_ptr = FindTable(table_id);
+  if (table_ptr == nullptr) {
     return absl::OkStatus();
   }
-  Table& table = table_itr->second;
+  Table& table = *table_ptr;
+  absl::MutexLock table_lock(table.keyspace_mu);
 
   // Lookup keys from the given key range.
-  auto row_start_itr = table.lower_bound(key_range.start_key());
-  if (row_start_itr == table.end()) {
+  OrderedRows& keyspace = *table.keyspace;
+  auto row_start_itr =
+      keyspace.lower_bound(KeyspaceKey(table, key_range.start_key()));
+  if (row_start_itr == keyspace.end()) {
     return absl::OkStatus();
   }
-  auto row_end_itr = table.lower_bound(key_range.limit_key());
+  auto row_end_itr =
+      keyspace.lower_bound(KeyspaceKey(table, key_range.limit_key()));
 
-  // Mark the keys as deleted.
+  // Mark the keys as deleted. Values written at the same timestamp are
+  // replaced and no longer take space.
+  int64_t released_bytes = 0;
   for (auto itr = row_start_itr; itr != row_end_itr; ++itr) {
-    if (!Exists(itr->second, timestamp)) {
+    if (itr->table != &table) {
+      continue;
+    }
+    Row& row = itr->entry->second;
+    if (!Exists(table, row, timestamp)) {
       continue;
     }
 
-    for (const auto& columns : itr->second) {
-      if (columns.first == kExistsColumn) {
-        itr->second[kExistsColumn][timestamp] = zetasql::values::Bool(false);
-      } else {
-        // Column values are marked invalid zetasql::Value to avoid reading
-        // the value of the cell before the delete.
-        itr->second[columns.first][timestamp] = zetasql::Value();
+    Split& split = FindSplit(&table, itr->entry->first)->second;
+    const absl::Time next_change_timestamp =
+        SetCellValue(&table, &row, kExistsColumnIndex, timestamp,
+                     zetasql::values::Bool(false));
+    AdjustRowCount(&table, timestamp, next_change_timestamp, -1);
+    if (next_change_timestamp == absl::InfiniteFuture()) {
+      --split.row_count;
+    }
+    for (int i = kExistsColumnIndex + 1; i < table.columns.size(); ++i) {
+      const Column& column = table.columns[i];
+      if (row.row_id >= column.timestamps.size() ||
+          column.timestamps[row.row_id] == absl::InfiniteFuture()) {
+        continue;
       }
+      // Column values are marked invalid zetasql::Value to avoid reading
+      // the value of the cell before the delete.
+      const int64_t bytes = VersionSizeInBytes(table, row, i, timestamp);
+      split.byte_size -= bytes;
+      released_bytes += bytes;
+      SetCellValue(&table, &row, i, timestamp, zetasql::Value());
+    }
+  }
+  table.byte_size -= released_bytes;
+  if (memory_tracker_ != nullptr) {
+    memory_tracker_->Release(released_bytes);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryStorage::BulkLoad(
+    absl::Time timestamp, const TableID& table_id,
+    const std::vector<ColumnID>& column_ids,
+    std::vector<std::pair<Key, std::vector<zetasql::Value>>> rows) {
+  AddTableIfMissing(table_id);
+  absl::ReaderMutexLock tables_lock(&mu_);
+  Table& table = *FindTable(table_id);
+  absl::MutexLock table_lock(table.keyspace_mu);
+  if (!table.rows.empty()) {
+    return error::Internal(
+        absl::StrCat("InMemoryStorage::BulkLoad should be called with an "
+                     "empty table, found rows in table: ",
+                     table_id));
+  }
+
+  // Sort the rows so that they can be appended to the ordered index in linear
+  // time instead of being inserted one by one.
+  std::sort(rows.begin(), rows.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  table.rows.reserve(rows.size());
+  std::vector<int> column_indexes;
+  column_indexes.reserve(column_ids.size());
+  for (const ColumnID& column_id : column_ids) {
+    column_indexes.push_back(FindOrAddColumnIndex(&table, column_id));
+  }
+  for (Column& column : table.columns) {
+    column.timestamps.reserve(rows.size());
+    column.values.reserve(rows.size());
+  }
+  if (enable_prefix_filters_) {
+    int64_t num_prefixes = 0;
+    for (const auto& row : rows) {
+      num_prefixes += row.first.NumColumns();
+    }
+    table.prefix_filter = KeyPrefixFilter(
+        std::max(num_prefixes, KeyPrefixFilter::kDefaultCapacity));
+  }
+  int64_t bytes = 0;
+  const Key* prev_key = nullptr;
+  for (auto& [key, values] : rows) {
+    if (prev_key != nullptr && *prev_key == key) {
+      return error::Internal(absl::StrCat(
+          "InMemoryStorage::BulkLoad was passed duplicate key: ",
+          key.DebugString(), " for table: ", table_id));
     }
+    const int64_t row_bytes = EstimateSizeInBytes(key, values);
+    bytes += row_bytes;
+    Row row;
+    row.row_id = table.rows.size();
+    if (!table.interleaving.tags.empty()) {
+      row.interleaved_key =
+          absl::make_unique<const Key>(KeyspaceKey(table, key));
+    }
+    auto row_itr = table.rows.emplace(std::move(key), std::move(row)).first;
+    prev_key = &row_itr->first;
+    SetCellValue(&table, &row_itr->second, kExistsColumnIndex, timestamp,
+                 zetasql::values::Bool(true));
+    for (int i = 0; i < column_ids.size(); ++i) {
+      SetCellValue(&table, &row_itr->second, column_indexes[i], timestamp,
+                   EncodeValue(&table, column_ids[i], values[i]));
+    }
+    // The rows are appended in key order, so the end of the keyspace is the
+    // right position unless the keyspace is shared with other tables, in
+    // which case the btree falls back to a search.
+    table.keyspace->insert(table.keyspace->end(), {&*row_itr, &table});
+    AddToPrefixFilter(&table, row_itr->first);
+    AddToKeySample(&table, row_itr->first);
+    Splits::iterator split_itr = FindSplit(&table, row_itr->first);
+    ++split_itr->second.num_entries;
+    ++split_itr->second.row_count;
+    split_itr->second.byte_size += row_bytes;
+    DivideSplitIfFull(&table, split_itr);
+  }
+  table.byte_size += bytes;
+
+  if (!rows.empty()) {
+    table.row_counts[timestamp] = rows.size();
+  }
+
+  if (memory_tracker_ != nullptr) {
+    memory_tracker_->Allocate(bytes);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InMemoryStorage::DropTable(const TableID& table_id) {
+  absl::MutexLock lock(&mu_);
+
+  auto table_itr = tables_.find(table_id);
+  if (table_itr == tables_.end()) {
+    return absl::OkStatus();
+  }
+  Table& table = table_itr->second;
+  for (const auto& [other_table_id, other_table] : tables_) {
+    if (&other_table != &table && other_table.keyspace == &table.ordered_rows) {
+      return error::Internal(absl::StrCat(
+          "InMemoryStorage::DropTable should be called after dropping the "
+          "tables interleaved in the table, found interleaved table: ",
+          other_table_id, " in table: ", table_id));
+    }
+  }
+
+  // No operation uses the table while mu_ is held exclusively, so its entries
+  // can be removed from the keyspace it shares with its ancestors.
+  if (table.keyspace != &table.ordered_rows) {
+    for (auto itr = table.keyspace->begin(); itr != table.keyspace->end();) {
+      itr = itr->table == &table ? table.keyspace->erase(itr) : std::next(itr);
+    }
+  }
+  if (memory_tracker_ != nullptr) {
+    memory_tracker_->Release(table.byte_size);
   }
+  tables_.erase(table_itr);
   return absl::OkStatus();
 }
 
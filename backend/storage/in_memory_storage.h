@@ -17,13 +17,32 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_IN_MEMORY_STORAGE_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_IN_MEMORY_STORAGE_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "zetasql/public/value.h"
+#include "absl/container/btree_map.h"
+#include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/random/random.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "backend/common/ids.h"
+#include "backend/common/memory_tracker.h"
+#include "backend/common/thread_pool.h"
 #include "backend/datamodel/key.h"
 #include "backend/datamodel/key_range.h"
+#include "backend/storage/cell_history.h"
+#include "backend/storage/in_memory_iterator.h"
 #include "backend/storage/iterator.h"
+#include "backend/storage/key_prefix_filter.h"
 #include "backend/storage/storage.h"
+#include "backend/storage/string_dictionary.h"
 #include "absl/status/status.h"
 
 namespace google {
@@ -33,15 +52,77 @@ namespace backend {
 
 // InMemoryStorage implements an in-memory multi-version data store.
 //
-// Keys are stored in sorted order. Value versions for a given column are also
-// sorted in order of the timestamp written. Keys are never deleted, but are
-// marked deleted for multi-version lookup.
+// Rows are owned by a hash map keyed by their keys, which serves point lookups
+// and existence checks in constant time. Keys are also stored in sorted order
+// in a B-tree of pointers to the rows, which keeps many adjacent rows in each
+// node so that range scans touch fewer, contiguous allocations than a
+// node-per-row binary tree. Keys are never deleted, but are marked deleted for
+// multi-version lookup.
+//
+// Cell values are stored by column: each row is assigned a row id, and the
+// latest version of every cell is kept at that index in a per-column vector,
+// so that reading a few columns of a wide table only touches the memory of
+// the columns read. Older value versions are kept, compactly encoded (see
+// CellHistory), only for the rows whose cells were overwritten or deleted.
 //
 // Lookup and Read return invalid zetasql::Value(s) for non-existent columns.
 //
-// This class is thread-safe.
+// STRING values are dictionary encoded per column (see StringDictionary), so
+// that cells of low-cardinality columns share their string buffers.
+//
+// If a MemoryTracker is provided, the estimated size of all keys and cell
+// versions written is accounted to it. Writes are never failed because of the
+// tracker's limit since they only happen once a transaction has committed.
+//
+// The number of live rows of each table is maintained at every timestamp that
+// rows were inserted or deleted at, so that CountRows does not scan the table.
+//
+// Each table keeps a bloom filter over the prefixes of its keys, so that reads
+// of a key prefix which was never written (e.g. looking for the children of a
+// parent without any) return without searching the table. The filters can be
+// disabled to verify that results do not depend on them.
+//
+// Optionally, the rows of interleaved tables are kept in the ordered keyspace
+// of the root table of their interleaving hierarchy, right after their parent
+// rows (see InterleavedKey). Reads of a parent row and its children, such as
+// the ones of cascading deletes, then scan adjacent rows, while reads of a
+// single table skip the rows of the other tables in its range.
+//
+// Tables also keep their size and a reservoir sample of their keys, which
+// together with the live row counts are exposed by GetTableStats.
+//
+// Tables are divided into key-range splits, each holding at most
+// max_rows_per_split rows: a split which grows past the limit is divided at
+// its middle row. Splits keep their own row counts and sizes, exposed by
+// GetTableSplits. Rows are never removed, so splits are never merged.
+//
+// Reads of key ranges spanning several large splits are divided into
+// contiguous groups of splits whose rows are materialized in parallel, and
+// concatenated in key order. The reading thread is helped by a pool of
+// read_parallelism - 1 threads shared by all the reads of the storage, so that
+// concurrent reads do not add threads.
+//
+// This class is thread-safe. Each table (or interleaving hierarchy, which
+// shares a keyspace) has its own lock, held in shared mode by readers, so that
+// operations on different tables and concurrent reads of the same table do
+// not contend. The storage-wide lock only guards the set of tables, and is
+// held exclusively only to add tables or change their interleaving.
 class InMemoryStorage : public Storage {
  public:
+  // Default maximum number of rows in a split of a table.
+  static constexpr int64_t kDefaultMaxRowsPerSplit = 16384;
+
+  explicit InMemoryStorage(
+      MemoryTracker* memory_tracker = nullptr, int read_parallelism = 1,
+      bool enable_prefix_filters = true, bool interleave_tables = false,
+      int64_t max_rows_per_split = kDefaultMaxRowsPerSplit)
+      : memory_tracker_(memory_tracker),
+        read_parallelism_(read_parallelism),
+        enable_prefix_filters_(enable_prefix_filters),
+        interleave_tables_(interleave_tables),
+        max_rows_per_split_(max_rows_per_split),
+        read_pool_(read_parallelism - 1) {}
+
   absl::Status Lookup(absl::Time timestamp, const TableID& table_id,
                       const Key& key, const std::vector<ColumnID>& column_ids,
                       std::vector<zetasql::Value>* values) const override
@@ -53,6 +134,23 @@ class InMemoryStorage : public Storage {
                     std::unique_ptr<StorageIterator>* itr) const override
       ABSL_LOCKS_EXCLUDED(mu_);
 
+  absl::Status CountRows(absl::Time timestamp, const TableID& table_id,
+                         int64_t* count) const override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  absl::Status GetTableStats(const TableID& table_id,
+                             TableStats* stats) const override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  absl::Status GetTableSplits(const TableID& table_id,
+                              std::vector<TableSplit>* splits) const override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  absl::Status InterleaveTable(const TableID& child_table_id,
+                               const TableID& parent_table_id,
+                               int parent_key_size) override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
   absl::Status Write(absl::Time timestamp, const TableID& table_id,
                      const Key& key, const std::vector<ColumnID>& column_ids,
                      const std::vector<zetasql::Value>& values) override
@@ -62,24 +160,260 @@ class InMemoryStorage : public Storage {
                       const KeyRange& key_range) override
       ABSL_LOCKS_EXCLUDED(mu_);
 
+  absl::Status BulkLoad(
+      absl::Time timestamp, const TableID& table_id,
+      const std::vector<ColumnID>& column_ids,
+      std::vector<std::pair<Key, std::vector<zetasql::Value>>> rows) override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  absl::Status DropTable(const TableID& table_id) override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
  private:
-  using Cell = std::map<absl::Time, zetasql::Value>;
-  using Row = absl::flat_hash_map<ColumnID, Cell>;
-  using Table = std::map<Key, Row>;
-  using Tables = absl::flat_hash_map<TableID, Table>;
+  // Latest versions of the cells of a column, indexed by row id. Cells which
+  // were never written have an invalid value at absl::InfiniteFuture(), as do
+  // rows beyond the end of the vectors.
+  struct Column {
+    std::vector<absl::Time> timestamps;
+    std::vector<zetasql::Value> values;
+  };
+  struct Row {
+    // Index of the row's cells in the columns of its table.
+    size_t row_id = 0;
+
+    // Key of the row in the keyspace of its interleaving hierarchy (see
+    // InterleavedKey), null if its table is not interleaved.
+    std::unique_ptr<const Key> interleaved_key;
+
+    // Versions of the row's cells older than the latest ones, by column index.
+    // Empty unless some cell of the row was written more than once.
+    absl::flat_hash_map<int, CellHistory> history;
+  };
+  // Hashes keys consistently with their equality.
+  struct KeyHash {
+    size_t operator()(const Key& key) const;
+  };
+  using Rows = absl::node_hash_map<Key, Row, KeyHash>;
+  using RowEntry = Rows::value_type;
+  struct Table;
+  // Entry of a row in an ordered keyspace, with the table owning the row.
+  struct OrderedRow {
+    RowEntry* entry;
+    const Table* table;
+  };
+  // Returns the key by which the given row is ordered in its keyspace.
+  static const Key& OrderingKey(const RowEntry* entry) {
+    return entry->second.interleaved_key != nullptr
+               ? *entry->second.interleaved_key
+               : entry->first;
+  }
+  // Orders rows by their keys in the keyspace, also accepting keys for lookups.
+  struct OrderedRowLess {
+    using is_transparent = void;
+    bool operator()(const OrderedRow& a, const OrderedRow& b) const {
+      return OrderingKey(a.entry) < OrderingKey(b.entry);
+    }
+    bool operator()(const OrderedRow& a, const Key& b) const {
+      return OrderingKey(a.entry) < b;
+    }
+    bool operator()(const Key& a, const OrderedRow& b) const {
+      return a < OrderingKey(b.entry);
+    }
+  };
+  using OrderedRows = absl::btree_set<OrderedRow, OrderedRowLess>;
+  // Position of a table in an interleaving hierarchy: the number of key
+  // columns of each of its ancestors from the root down, and the tag which
+  // identifies the child of each ancestor on the path to the table.
+  struct Interleaving {
+    std::vector<int> ancestor_key_sizes;
+    std::vector<int64_t> tags;
+  };
+  // Number of live rows of a table, as of each timestamp it changed at.
+  using RowCounts = std::map<absl::Time, int64_t>;
+  // Statistics of a split of a table.
+  struct Split {
+    // Number of rows of the split, including deleted ones.
+    int64_t num_entries = 0;
+    // Number of rows of the split which currently exist.
+    int64_t row_count = 0;
+    // Estimated number of bytes held by the rows of the split.
+    int64_t byte_size = 0;
+  };
+  // Splits of a table by their start keys.
+  using Splits = absl::btree_map<Key, Split>;
+  // The fields of a table are guarded by *keyspace_mu, held in shared mode by
+  // readers and exclusively by writers.
+  struct Table {
+    // Lock of the table, and the lock guarding it: the one of the root table
+    // of its interleaving hierarchy, which shares its keyspace.
+    mutable absl::Mutex mu;
+    absl::Mutex* keyspace_mu = &mu;
+
+    // Rows of the table by key. Node-based, so that the entries keep their
+    // addresses as rows are added.
+    Rows rows;
+
+    // Keyspace holding the entries of 'rows' in key order. This is
+    // 'ordered_rows', unless the table is interleaved in another one, in which
+    // case it is the keyspace of the root table of its hierarchy, shared with
+    // all the tables of the hierarchy.
+    OrderedRows ordered_rows;
+    OrderedRows* keyspace = &ordered_rows;
+
+    // Position of the table in its interleaving hierarchy, empty if the table
+    // is not interleaved.
+    Interleaving interleaving;
+
+    // Columns of the table by column index, starting with the _exists system
+    // column, and the indexes of the columns by id.
+    std::vector<Column> columns;
+    absl::flat_hash_map<ColumnID, int> column_indexes;
+
+    // Filter over the prefixes of the keys in 'rows', if enabled.
+    KeyPrefixFilter prefix_filter;
+
+    // Estimated number of bytes held by the keys and cells in 'rows'.
+    int64_t byte_size = 0;
+
+    // Uniform random sample of the keys in 'rows', in insertion order, and
+    // the generator used to sample them.
+    std::vector<Key> key_sample;
+    absl::BitGen bitgen;
+
+    // Dictionaries of the STRING columns of the table, by column id.
+    absl::flat_hash_map<ColumnID, StringDictionary> dictionaries;
+
+    // Number of live rows of the table over time.
+    RowCounts row_counts;
+
+    // Splits of the table, starting with the one of the empty key.
+    Splits splits;
+  };
+  // Node-based, so that tables keep their addresses for their keyspaces and
+  // for the operations using them once the table lookup is done.
+  using Tables = absl::node_hash_map<TableID, Table>;
+
+  // Index of the _exists system column in the columns of every table.
+  static constexpr int kExistsColumnIndex = 0;
+
+  // Returns the indexes of the given columns in 'table', -1 for columns which
+  // were never written.
+  static std::vector<int> FindColumnIndexes(
+      const Table& table, const std::vector<ColumnID>& column_ids);
+
+  // Returns the index of the given column in 'table', adding it if needed.
+  static int FindOrAddColumnIndex(Table* table, const ColumnID& column_id);
 
   // Returns true if the given row is valid at the specified timestamp.
-  bool Exists(const Row& row, absl::Time timestamp) const
-      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  static bool Exists(const Table& table, const Row& row, absl::Time timestamp);
+
+  // Returns the value for given row and column index at the specified
+  // timestamp, or an invalid value if the column index is -1.
+  static zetasql::Value GetCellValueAtTimestamp(const Table& table,
+                                                  const Row& row,
+                                                  int column_index,
+                                                  absl::Time timestamp);
+
+  // Returns the estimated size of the version of the given cell written at
+  // exactly the specified timestamp, or 0 if there is none.
+  static int64_t VersionSizeInBytes(const Table& table, const Row& row,
+                                    int column_index, absl::Time timestamp);
+
+  // Writes the value of the given cell at the specified timestamp, moving the
+  // latest version of the cell to the row's history if it is older. Returns
+  // the timestamp of the version of the cell following the written one, or
+  // absl::InfiniteFuture() if the written version is the latest.
+  static absl::Time SetCellValue(Table* table, Row* row, int column_index,
+                                 absl::Time timestamp, zetasql::Value value);
+
+  // Appends the given columns of the rows in [begin, end) which exist at the
+  // specified timestamp to 'rows'.
+  static void MaterializeRows(const Table& table,
+                              OrderedRows::const_iterator begin,
+                              OrderedRows::const_iterator end,
+                              absl::Time timestamp,
+                              const std::vector<int>& column_indexes,
+                              std::vector<FixedRowStorageIterator::Row>* rows);
+
+  // Returns 'key' of a table with the given interleaving in the form ordered
+  // in the keyspace of its hierarchy: the key columns of each ancestor are
+  // followed by the tag of the next table on the path to the table, so that
+  // the rows of a table follow the row of their parent and precede its next
+  // sibling row, grouped by table.
+  static Key InterleavedKey(const Interleaving& interleaving, const Key& key);
+
+  // Returns the key of the keyspace of 'table' corresponding to 'key'.
+  static Key KeyspaceKey(const Table& table, const Key& key);
 
-  // Returns the value for given row and column_id at the specified timestamp.
-  zetasql::Value GetCellValueAtTimestamp(const Row& row,
-                                           const ColumnID& column_id,
-                                           absl::Time timestamp) const
+  // Returns the split of 'table' holding 'key'.
+  static Splits::iterator FindSplit(Table* table, const Key& key);
+
+  // Returns the given table, or nullptr if it does not exist.
+  const Table* FindTable(const TableID& table_id) const
+      ABSL_SHARED_LOCKS_REQUIRED(mu_);
+  Table* FindTable(const TableID& table_id) ABSL_SHARED_LOCKS_REQUIRED(mu_);
+
+  // Returns the given table, creating it if it does not exist.
+  Table* FindOrCreateTable(const TableID& table_id)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Creates the given table if it does not exist, so that it can then be found
+  // holding mu_ in shared mode.
+  void AddTableIfMissing(const TableID& table_id) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // The following functions require the lock of the given table to be held
+  // exclusively.
+
+  // Returns the value to store for the given column of 'table', interning it
+  // in the column's string dictionary if applicable.
+  static zetasql::Value EncodeValue(Table* table, const ColumnID& column_id,
+                                      const zetasql::Value& value);
+
+  // Adds 'key', which was just added to the rows of 'table', to the table's
+  // prefix filter, growing the filter if it is full.
+  void AddToPrefixFilter(Table* table, const Key& key) const;
+
+  // Adds 'key', which was just added to the rows of 'table', to the table's key
+  // sample.
+  static void AddToKeySample(Table* table, const Key& key);
+
+  // Adds 'delta' to the row count of 'table' from the specified timestamp
+  // until 'next_change_timestamp', the next change of the row's existence
+  // after it (absl::InfiniteFuture() if there is none).
+  static void AdjustRowCount(Table* table, absl::Time timestamp,
+                             absl::Time next_change_timestamp, int64_t delta);
+
+  // Divides the given split of 'table' at its middle row if it holds more than
+  // max_rows_per_split_ rows.
+  void DivideSplitIfFull(Table* table, Splits::iterator split_itr) const;
+
+  // Tracker for the bytes held by this storage, may be nullptr.
+  MemoryTracker* memory_tracker_;
+
+  // Maximum number of threads, including the reading thread, used to
+  // materialize a single read.
+  const int read_parallelism_;
+
+  // Whether tables keep prefix filters.
+  const bool enable_prefix_filters_;
+
+  // Whether interleaved tables share the keyspace of their root table.
+  const bool interleave_tables_;
+
+  // Maximum number of rows in a split of a table.
+  const int64_t max_rows_per_split_;
+
+  // Threads materializing the rows of large reads along with the reading
+  // threads.
+  mutable ThreadPool read_pool_;
+
+  // Guards the set of tables and their locks. Held in shared mode while a
+  // table is used, so that tables are only added or interleaved while no
+  // operation is in progress.
   mutable absl::Mutex mu_;
   Tables tables_ ABSL_GUARDED_BY(mu_);
+  // Last tag assigned to an interleaved table.
+  int64_t last_interleaving_tag_ ABSL_GUARDED_BY(mu_) = 0;
 };
 
 }  // namespace backend
@@ -16,12 +16,17 @@
 
 #include "backend/storage/in_memory_storage.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
 #include "tests/common/proto_matchers.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "backend/common/memory_tracker.h"
 #include "backend/datamodel/key_range.h"
 #include "backend/storage/iterator.h"
 #include "absl/status/status.h"
@@ -615,6 +620,43 @@ TEST_F(InMemoryStorageTest, SnapshotRead) {
   EXPECT_EQ(itr_->ColumnValue(0), String("value-10"));
 }
 
+TEST_F(InMemoryStorageTest, ReadsNarrowProjectionOfWideRowVersions) {
+  absl::Time t0 = absl::Now();
+  absl::Time t1 = t0 + absl::Seconds(1);
+  absl::Time t2 = t1 + absl::Seconds(1);
+  std::vector<ColumnID> column_ids;
+  std::vector<zetasql::Value> values;
+  for (int i = 0; i < 50; ++i) {
+    column_ids.push_back(absl::StrCat("test_column:", i));
+    values.push_back(Int64(i));
+  }
+
+  // Row 1 is written once, row 2 is updated at t2, and an older version of
+  // row 2 at t1 is written last.
+  ZETASQL_EXPECT_OK(
+      storage_.Write(t0, kTableId0, Key({Int64(1)}), column_ids, values));
+  ZETASQL_EXPECT_OK(
+      storage_.Write(t0, kTableId0, Key({Int64(2)}), column_ids, values));
+  ZETASQL_EXPECT_OK(storage_.Write(t2, kTableId0, Key({Int64(2)}),
+                           {column_ids[10]}, {Int64(200)}));
+  ZETASQL_EXPECT_OK(storage_.Write(t1, kTableId0, Key({Int64(2)}),
+                           {column_ids[10]}, {Int64(100)}));
+
+  auto read_column_10 = [&](absl::Time timestamp) {
+    std::vector<zetasql::Value> column_values;
+    ZETASQL_EXPECT_OK(storage_.Read(timestamp, kTableId0, kKeyRange0To5,
+                            {column_ids[10], column_ids[40]}, &itr_));
+    while (itr_->Next()) {
+      EXPECT_EQ(itr_->ColumnValue(1), Int64(40));
+      column_values.push_back(itr_->ColumnValue(0));
+    }
+    return column_values;
+  };
+  EXPECT_THAT(read_column_10(t0), testing::ElementsAre(Int64(10), Int64(10)));
+  EXPECT_THAT(read_column_10(t1), testing::ElementsAre(Int64(10), Int64(100)));
+  EXPECT_THAT(read_column_10(t2), testing::ElementsAre(Int64(10), Int64(200)));
+}
+
 TEST_F(InMemoryStorageTest, ReadUsingKeyRangeAll) {
   absl::Time write_ts = absl::Now();
   absl::Time read_ts = write_ts + absl::Seconds(1);
@@ -677,6 +719,75 @@ TEST_F(InMemoryStorageTest, ReadUsingPrefixKeyRange) {
   EXPECT_FALSE(itr_->Next());
 }
 
+TEST_F(InMemoryStorageTest, PrefixReadsDoNotDependOnPrefixFilters) {
+  InMemoryStorage unfiltered_storage(/*memory_tracker=*/nullptr,
+                                     /*read_parallelism=*/1,
+                                     /*enable_prefix_filters=*/false);
+  absl::Time t0 = absl::Now();
+  // Write enough keys for the prefix filter to be grown a few times.
+  for (int i = 0; i < 2000; i += 2) {
+    Key key({Int64(i / 10), Int64(i)});
+    ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, key, {kColumnID}, {Int64(i)}));
+    ZETASQL_EXPECT_OK(unfiltered_storage.Write(t0, kTableId0, key, {kColumnID},
+                                       {Int64(i)}));
+  }
+
+  auto count_rows = [&](const InMemoryStorage& storage, const Key& prefix) {
+    std::unique_ptr<StorageIterator> itr;
+    ZETASQL_EXPECT_OK(
+        storage.Read(t0, kTableId0, KeyRange::Prefix(prefix), {}, &itr));
+    int num_rows = 0;
+    while (itr->Next()) {
+      ++num_rows;
+    }
+    return num_rows;
+  };
+  for (int i = 0; i < 2000; ++i) {
+    Key full_key({Int64(i / 10), Int64(i)});
+    EXPECT_EQ(count_rows(storage_, full_key),
+              count_rows(unfiltered_storage, full_key));
+    EXPECT_EQ(count_rows(storage_, full_key), i % 2 == 0 ? 1 : 0);
+  }
+  for (int i = 0; i < 300; ++i) {
+    Key prefix({Int64(i)});
+    EXPECT_EQ(count_rows(storage_, prefix),
+              count_rows(unfiltered_storage, prefix));
+    EXPECT_EQ(count_rows(storage_, prefix), i < 200 ? 5 : 0);
+  }
+}
+
+TEST_F(InMemoryStorageTest, TableStatsTrackRowsBytesAndKeySample) {
+  TableStats stats;
+  ZETASQL_EXPECT_OK(storage_.GetTableStats(kTableId0, &stats));
+  EXPECT_EQ(stats.row_count, 0);
+  EXPECT_EQ(stats.byte_size, 0);
+  EXPECT_TRUE(stats.key_sample.empty());
+
+  absl::Time t0 = absl::Now();
+  for (int i = 0; i < 1000; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(i)}), {kColumnID},
+                             {Int64(i)}));
+  }
+  ZETASQL_EXPECT_OK(storage_.Delete(t0 + absl::Seconds(1), kTableId0,
+                            KeyRange::ClosedOpen(Key({Int64(0)}),
+                                                 Key({Int64(100)}))));
+
+  ZETASQL_EXPECT_OK(storage_.GetTableStats(kTableId0, &stats));
+  EXPECT_EQ(stats.row_count, 900);
+  EXPECT_GT(stats.byte_size, 0);
+  EXPECT_THAT(stats.key_sample, testing::SizeIs(128));
+  EXPECT_TRUE(
+      std::is_sorted(stats.key_sample.begin(), stats.key_sample.end()));
+  for (const Key& key : stats.key_sample) {
+    EXPECT_GE(key, Key({Int64(0)}));
+    EXPECT_LT(key, Key({Int64(1000)}));
+  }
+
+  // Statistics of other tables are unaffected.
+  ZETASQL_EXPECT_OK(storage_.GetTableStats(kTableId1, &stats));
+  EXPECT_EQ(stats.row_count, 0);
+}
+
 TEST_F(InMemoryStorageTest,
        ReadUsingInvalidKeyRangeEndpointsReturnsInternalError) {
   absl::Time t0 = absl::Now();
@@ -699,6 +810,363 @@ TEST_F(InMemoryStorageTest,
       zetasql_base::testing::StatusIs(absl::StatusCode::kInternal));
 }
 
+TEST_F(InMemoryStorageTest, EqualStringsShareStorage) {
+  absl::Time t0 = absl::Now();
+
+  ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(1)}), {kColumnID},
+                           {String("ACTIVE")}));
+  ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(2)}), {kColumnID},
+                           {String("ACTIVE")}));
+
+  std::vector<zetasql::Value> values1;
+  std::vector<zetasql::Value> values2;
+  ZETASQL_EXPECT_OK(
+      storage_.Lookup(t0, kTableId0, Key({Int64(1)}), {kColumnID}, &values1));
+  ZETASQL_EXPECT_OK(
+      storage_.Lookup(t0, kTableId0, Key({Int64(2)}), {kColumnID}, &values2));
+  EXPECT_THAT(values1, testing::ElementsAre(String("ACTIVE")));
+  EXPECT_THAT(values2, testing::ElementsAre(String("ACTIVE")));
+  EXPECT_EQ(values1[0].string_value().data(),
+            values2[0].string_value().data());
+}
+
+TEST_F(InMemoryStorageTest, BulkLoadSortsRows) {
+  absl::Time t0 = absl::Now();
+
+  std::vector<std::pair<Key, std::vector<zetasql::Value>>> rows;
+  for (int i : {3, 1, 4, 0, 2}) {
+    rows.emplace_back(Key({Int64(i)}),
+                      std::vector<zetasql::Value>{
+                          String(absl::StrCat("value-", i))});
+  }
+  ZETASQL_EXPECT_OK(storage_.BulkLoad(t0, kTableId0, {kColumnID}, std::move(rows)));
+
+  ZETASQL_EXPECT_OK(storage_.Read(t0, kTableId0, kKeyRange0To5, {kColumnID}, &itr_));
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(itr_->Next());
+    EXPECT_EQ(itr_->Key(), Key({Int64(i)}));
+    EXPECT_EQ(itr_->ColumnValue(0), String(absl::StrCat("value-", i)));
+  }
+  EXPECT_FALSE(itr_->Next());
+
+  // Rows are not visible before the load timestamp.
+  std::vector<zetasql::Value> values;
+  EXPECT_THAT(storage_.Lookup(t0 - absl::Nanoseconds(1), kTableId0,
+                              Key({Int64(1)}), {kColumnID}, &values),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST_F(InMemoryStorageTest, BulkLoadRequiresEmptyTable) {
+  absl::Time t0 = absl::Now();
+
+  ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(1)}), {kColumnID},
+                           {String("value-1")}));
+  EXPECT_THAT(storage_.BulkLoad(t0, kTableId0, {kColumnID}, {}),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kInternal));
+}
+
+TEST_F(InMemoryStorageTest, ParallelReadPreservesKeyOrder) {
+  InMemoryStorage storage(/*memory_tracker=*/nullptr, /*read_parallelism=*/4);
+  absl::Time t0 = absl::Now();
+  constexpr int kNumRows = 50000;
+
+  std::vector<std::pair<Key, std::vector<zetasql::Value>>> rows;
+  for (int i = 0; i < kNumRows; ++i) {
+    rows.emplace_back(Key({Int64(i)}), std::vector<zetasql::Value>{Int64(i)});
+  }
+  ZETASQL_EXPECT_OK(storage.BulkLoad(t0, kTableId0, {kColumnID}, std::move(rows)));
+
+  // Delete every other row so that each split skips non-existent rows.
+  absl::Time t1 = t0 + absl::Seconds(1);
+  for (int i = 1; i < kNumRows; i += 2) {
+    ZETASQL_EXPECT_OK(
+        storage.Delete(t1, kTableId0, KeyRange::Point(Key({Int64(i)}))));
+  }
+
+  ZETASQL_EXPECT_OK(storage.Read(t1, kTableId0, KeyRange::All(), {kColumnID}, &itr_));
+  for (int i = 0; i < kNumRows; i += 2) {
+    ASSERT_TRUE(itr_->Next());
+    EXPECT_EQ(itr_->Key(), Key({Int64(i)}));
+    EXPECT_EQ(itr_->ColumnValue(0), Int64(i));
+  }
+  EXPECT_FALSE(itr_->Next());
+}
+
+TEST_F(InMemoryStorageTest, InterleavedTablesReadOnlyTheirOwnRows) {
+  const TableID kChildTableId = "test_table:child";
+  const TableID kGrandchildTableId = "test_table:grandchild";
+  InMemoryStorage storage(/*memory_tracker=*/nullptr, /*read_parallelism=*/1,
+                          /*enable_prefix_filters=*/true,
+                          /*interleave_tables=*/true);
+  ZETASQL_EXPECT_OK(storage.InterleaveTable(kChildTableId, kTableId0,
+                                    /*parent_key_size=*/1));
+  ZETASQL_EXPECT_OK(storage.InterleaveTable(kGrandchildTableId, kChildTableId,
+                                    /*parent_key_size=*/2));
+  absl::Time t0 = absl::Now();
+  for (int p = 0; p < 3; ++p) {
+    ZETASQL_EXPECT_OK(
+        storage.Write(t0, kTableId0, Key({Int64(p)}), {kColumnID}, {Int64(p)}));
+    for (int c = 0; c < 3; ++c) {
+      ZETASQL_EXPECT_OK(storage.Write(t0, kChildTableId,
+                              Key({Int64(p), Int64(c)}), {kColumnID},
+                              {Int64(c)}));
+      ZETASQL_EXPECT_OK(storage.Write(t0, kGrandchildTableId,
+                              Key({Int64(p), Int64(c), Int64(0)}), {kColumnID},
+                              {Int64(c)}));
+    }
+  }
+
+  ZETASQL_EXPECT_OK(storage.Read(t0, kTableId0, KeyRange::All(), {kColumnID}, &itr_));
+  for (int p = 0; p < 3; ++p) {
+    ASSERT_TRUE(itr_->Next());
+    EXPECT_EQ(itr_->Key(), Key({Int64(p)}));
+  }
+  EXPECT_FALSE(itr_->Next());
+
+  ZETASQL_EXPECT_OK(storage.Read(t0, kChildTableId,
+                         KeyRange::Prefix(Key({Int64(1)})), {kColumnID},
+                         &itr_));
+  for (int c = 0; c < 3; ++c) {
+    ASSERT_TRUE(itr_->Next());
+    EXPECT_EQ(itr_->Key(), Key({Int64(1), Int64(c)}));
+    EXPECT_EQ(itr_->ColumnValue(0), Int64(c));
+  }
+  EXPECT_FALSE(itr_->Next());
+
+  ZETASQL_EXPECT_OK(storage.Read(
+      t0, kGrandchildTableId,
+      KeyRange::ClosedOpen(Key({Int64(0), Int64(2)}), Key({Int64(2)})), {},
+      &itr_));
+  for (const Key& key : {Key({Int64(0), Int64(2), Int64(0)}),
+                         Key({Int64(1), Int64(0), Int64(0)}),
+                         Key({Int64(1), Int64(1), Int64(0)}),
+                         Key({Int64(1), Int64(2), Int64(0)})}) {
+    ASSERT_TRUE(itr_->Next());
+    EXPECT_EQ(itr_->Key(), key);
+  }
+  EXPECT_FALSE(itr_->Next());
+}
+
+TEST_F(InMemoryStorageTest, DeleteFromInterleavedTableKeepsOtherTables) {
+  const TableID kChildTableId = "test_table:child";
+  InMemoryStorage storage(/*memory_tracker=*/nullptr, /*read_parallelism=*/1,
+                          /*enable_prefix_filters=*/true,
+                          /*interleave_tables=*/true);
+  ZETASQL_EXPECT_OK(storage.InterleaveTable(kChildTableId, kTableId0,
+                                    /*parent_key_size=*/1));
+  absl::Time t0 = absl::Now();
+  std::vector<std::pair<Key, std::vector<zetasql::Value>>> rows;
+  for (int p = 0; p < 2; ++p) {
+    ZETASQL_EXPECT_OK(
+        storage.Write(t0, kTableId0, Key({Int64(p)}), {kColumnID}, {Int64(p)}));
+    for (int c = 0; c < 2; ++c) {
+      rows.emplace_back(Key({Int64(p), Int64(c)}),
+                        std::vector<zetasql::Value>{Int64(c)});
+    }
+  }
+  ZETASQL_EXPECT_OK(
+      storage.BulkLoad(t0, kChildTableId, {kColumnID}, std::move(rows)));
+
+  absl::Time t1 = t0 + absl::Seconds(1);
+  ZETASQL_EXPECT_OK(
+      storage.Delete(t1, kChildTableId, KeyRange::Prefix(Key({Int64(0)}))));
+
+  int64_t count = -1;
+  ZETASQL_EXPECT_OK(storage.CountRows(t1, kTableId0, &count));
+  EXPECT_EQ(count, 2);
+  ZETASQL_EXPECT_OK(storage.CountRows(t1, kChildTableId, &count));
+  EXPECT_EQ(count, 2);
+  ZETASQL_EXPECT_OK(
+      storage.Read(t1, kChildTableId, KeyRange::All(), {kColumnID}, &itr_));
+  for (int c = 0; c < 2; ++c) {
+    ASSERT_TRUE(itr_->Next());
+    EXPECT_EQ(itr_->Key(), Key({Int64(1), Int64(c)}));
+  }
+  EXPECT_FALSE(itr_->Next());
+
+  // Tables can no longer be interleaved once they have rows.
+  ZETASQL_EXPECT_OK(storage.Write(t0, kTableId1, Key({Int64(0)}), {}, {}));
+  EXPECT_THAT(storage.InterleaveTable(kTableId1, kTableId0,
+                                      /*parent_key_size=*/1),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kInternal));
+}
+
+TEST_F(InMemoryStorageTest, OverwritesAtSameTimestampAccountOnlyTheDifference) {
+  MemoryTracker tracker("database", /*limit_bytes=*/0);
+  InMemoryStorage storage(&tracker);
+  absl::Time t0 = absl::Now();
+  ZETASQL_EXPECT_OK(storage.Write(t0, kTableId0, Key({Int64(1)}), {kColumnID},
+                          {String("abcd")}));
+  const int64_t bytes = tracker.bytes_used();
+  EXPECT_EQ(bytes, EstimateSizeInBytes(Key({Int64(1)}), {String("abcd")}));
+
+  // Overwriting the cell replaces its value.
+  ZETASQL_EXPECT_OK(storage.Write(t0, kTableId0, Key({Int64(1)}), {kColumnID},
+                          {String("ab")}));
+  EXPECT_EQ(tracker.bytes_used(), bytes - 2);
+
+  // Deleting the row at the same timestamp replaces its values too.
+  ZETASQL_EXPECT_OK(storage.Delete(t0, kTableId0, KeyRange::All()));
+  EXPECT_EQ(tracker.bytes_used(), EstimateSizeInBytes(Key({Int64(1)}), {}));
+
+  // Writes at later timestamps keep the older versions.
+  absl::Time t1 = t0 + absl::Seconds(1);
+  ZETASQL_EXPECT_OK(storage.Write(t1, kTableId0, Key({Int64(1)}), {kColumnID},
+                          {String("abcd")}));
+  EXPECT_EQ(tracker.bytes_used(), EstimateSizeInBytes(Key({Int64(1)}), {}) +
+                                      EstimateSizeInBytes(String("abcd")));
+}
+
+TEST_F(InMemoryStorageTest, DropTableDiscardsRowsAndReleasesMemory) {
+  const TableID kChildTableId = "test_table:child";
+  MemoryTracker tracker("database", /*limit_bytes=*/0);
+  InMemoryStorage storage(&tracker, /*read_parallelism=*/1,
+                          /*enable_prefix_filters=*/true,
+                          /*interleave_tables=*/true);
+  ZETASQL_EXPECT_OK(storage.InterleaveTable(kChildTableId, kTableId0,
+                                    /*parent_key_size=*/1));
+  absl::Time t0 = absl::Now();
+  for (int p = 0; p < 2; ++p) {
+    ZETASQL_EXPECT_OK(
+        storage.Write(t0, kTableId0, Key({Int64(p)}), {kColumnID}, {Int64(p)}));
+    ZETASQL_EXPECT_OK(storage.Write(t0, kChildTableId,
+                            Key({Int64(p), Int64(0)}), {kColumnID},
+                            {Int64(p)}));
+  }
+  const int64_t table_bytes =
+      2 * EstimateSizeInBytes(Key({Int64(0)}), {Int64(0)});
+  EXPECT_GT(tracker.bytes_used(), table_bytes);
+
+  // The parent table can only be dropped after its child table.
+  EXPECT_THAT(storage.DropTable(kTableId0),
+              zetasql_base::testing::StatusIs(absl::StatusCode::kInternal));
+  ZETASQL_EXPECT_OK(storage.DropTable(kChildTableId));
+  EXPECT_EQ(tracker.bytes_used(), table_bytes);
+  ZETASQL_EXPECT_OK(
+      storage.Read(t0, kChildTableId, KeyRange::All(), {kColumnID}, &itr_));
+  EXPECT_FALSE(itr_->Next());
+  ZETASQL_EXPECT_OK(
+      storage.Read(t0, kTableId0, KeyRange::All(), {kColumnID}, &itr_));
+  for (int p = 0; p < 2; ++p) {
+    ASSERT_TRUE(itr_->Next());
+    EXPECT_EQ(itr_->Key(), Key({Int64(p)}));
+  }
+  EXPECT_FALSE(itr_->Next());
+
+  ZETASQL_EXPECT_OK(storage.DropTable(kTableId0));
+  EXPECT_EQ(tracker.bytes_used(), 0);
+  ZETASQL_EXPECT_OK(storage.DropTable(kTableId0));
+}
+
+TEST_F(InMemoryStorageTest, TablesAreDividedIntoSplitsBySize) {
+  InMemoryStorage storage(/*memory_tracker=*/nullptr, /*read_parallelism=*/1,
+                          /*enable_prefix_filters=*/true,
+                          /*interleave_tables=*/false,
+                          /*max_rows_per_split=*/4);
+  std::vector<TableSplit> splits;
+  ZETASQL_EXPECT_OK(storage.GetTableSplits(kTableId0, &splits));
+  ASSERT_THAT(splits, testing::SizeIs(1));
+  EXPECT_EQ(splits[0].start_key, Key());
+
+  absl::Time t0 = absl::Now();
+  for (int i = 0; i < 10; ++i) {
+    ZETASQL_EXPECT_OK(
+        storage.Write(t0, kTableId0, Key({Int64(i)}), {kColumnID}, {Int64(i)}));
+  }
+  absl::Time t1 = t0 + absl::Seconds(1);
+  ZETASQL_EXPECT_OK(
+      storage.Delete(t1, kTableId0, KeyRange::Point(Key({Int64(0)}))));
+
+  // Keys are written in order, so each split is divided when its fifth row is
+  // written, leaving its first two rows behind.
+  ZETASQL_EXPECT_OK(storage.GetTableSplits(kTableId0, &splits));
+  ASSERT_THAT(splits, testing::SizeIs(4));
+  EXPECT_EQ(splits[0].start_key, Key());
+  EXPECT_EQ(splits[1].start_key, Key({Int64(2)}));
+  EXPECT_EQ(splits[2].start_key, Key({Int64(4)}));
+  EXPECT_EQ(splits[3].start_key, Key({Int64(6)}));
+  int64_t row_count = 0;
+  int64_t byte_size = 0;
+  for (const TableSplit& split : splits) {
+    EXPECT_GT(split.byte_size, 0);
+    row_count += split.row_count;
+    byte_size += split.byte_size;
+  }
+  EXPECT_EQ(splits[0].row_count, 1);
+  EXPECT_EQ(row_count, 9);
+  TableStats stats;
+  ZETASQL_EXPECT_OK(storage.GetTableStats(kTableId0, &stats));
+  EXPECT_EQ(byte_size, stats.byte_size);
+
+  // Splits do not change the results of reads.
+  ZETASQL_EXPECT_OK(storage.Read(t1, kTableId0,
+                         KeyRange::ClosedOpen(Key({Int64(1)}), Key({Int64(7)})),
+                         {kColumnID}, &itr_));
+  for (int i = 1; i < 7; ++i) {
+    ASSERT_TRUE(itr_->Next());
+    EXPECT_EQ(itr_->Key(), Key({Int64(i)}));
+    EXPECT_EQ(itr_->ColumnValue(0), Int64(i));
+  }
+  EXPECT_FALSE(itr_->Next());
+}
+
+TEST_F(InMemoryStorageTest, ParallelReadAlignedWithSplitsPreservesKeyOrder) {
+  InMemoryStorage storage(/*memory_tracker=*/nullptr, /*read_parallelism=*/4,
+                          /*enable_prefix_filters=*/true,
+                          /*interleave_tables=*/false,
+                          /*max_rows_per_split=*/10000);
+  absl::Time t0 = absl::Now();
+  constexpr int kNumRows = 50000;
+
+  std::vector<std::pair<Key, std::vector<zetasql::Value>>> rows;
+  for (int i = 0; i < kNumRows; ++i) {
+    rows.emplace_back(Key({Int64(i)}), std::vector<zetasql::Value>{Int64(i)});
+  }
+  ZETASQL_EXPECT_OK(storage.BulkLoad(t0, kTableId0, {kColumnID}, std::move(rows)));
+  std::vector<TableSplit> splits;
+  ZETASQL_EXPECT_OK(storage.GetTableSplits(kTableId0, &splits));
+  EXPECT_THAT(splits, testing::SizeIs(testing::Ge(5)));
+
+  ZETASQL_EXPECT_OK(storage.Read(t0, kTableId0, KeyRange::All(), {kColumnID}, &itr_));
+  for (int i = 0; i < kNumRows; ++i) {
+    ASSERT_TRUE(itr_->Next());
+    EXPECT_EQ(itr_->Key(), Key({Int64(i)}));
+  }
+  EXPECT_FALSE(itr_->Next());
+}
+
+TEST_F(InMemoryStorageTest, CountRowsAtTimestamp) {
+  absl::Time t0 = absl::Now();
+  absl::Time t1 = t0 + absl::Seconds(1);
+  absl::Time t2 = t0 + absl::Seconds(2);
+  int64_t count = -1;
+  ZETASQL_EXPECT_OK(storage_.CountRows(t0, kTableId0, &count));
+  EXPECT_EQ(count, 0);
+
+  ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(1)}), {kColumnID},
+                           {Int64(1)}));
+  ZETASQL_EXPECT_OK(storage_.Write(t0, kTableId0, Key({Int64(2)}), {kColumnID},
+                           {Int64(2)}));
+  // Overwriting an existing row does not change the count.
+  ZETASQL_EXPECT_OK(storage_.Write(t1, kTableId0, Key({Int64(1)}), {kColumnID},
+                           {Int64(3)}));
+  ZETASQL_EXPECT_OK(storage_.Delete(t2, kTableId0, KeyRange::All()));
+  // Rows written at earlier timestamps also update the counts after them.
+  ZETASQL_EXPECT_OK(storage_.Write(t1, kTableId0, Key({Int64(3)}), {kColumnID},
+                           {Int64(3)}));
+
+  ZETASQL_EXPECT_OK(storage_.CountRows(t0 - absl::Seconds(1), kTableId0, &count));
+  EXPECT_EQ(count, 0);
+  ZETASQL_EXPECT_OK(storage_.CountRows(t0, kTableId0, &count));
+  EXPECT_EQ(count, 2);
+  ZETASQL_EXPECT_OK(storage_.CountRows(t1, kTableId0, &count));
+  EXPECT_EQ(count, 3);
+  ZETASQL_EXPECT_OK(storage_.CountRows(t2, kTableId0, &count));
+  EXPECT_EQ(count, 1);
+  ZETASQL_EXPECT_OK(storage_.CountRows(t2, kTableId1, &count));
+  EXPECT_EQ(count, 0);
+}
+
 }  // namespace
 
 }  // namespace backend
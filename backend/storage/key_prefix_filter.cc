@@ -0,0 +1,93 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/storage/key_prefix_filter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include "zetasql/public/value.h"
+#include "absl/hash/hash.h"
+#include "backend/datamodel/key.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+// Number of filter bits per prefix and of bits probed per prefix, which
+// together give a false positive rate of about 1%.
+constexpr int64_t kBitsPerPrefix = 10;
+constexpr int kNumProbes = 7;
+
+// Returns the hash of the prefix of `key` with `num_columns` columns, given the
+// hash of its prefix with one column less. Keys are equal if their columns
+// are equal, which Value::HashCode is consistent with.
+uint64_t ExtendPrefixHash(uint64_t prefix_hash, const Key& key,
+                          int num_columns) {
+  return absl::Hash<std::pair<uint64_t, uint64_t>>()(
+      {prefix_hash, key.ColumnValue(num_columns - 1).HashCode()});
+}
+
+}  // namespace
+
+KeyPrefixFilter::KeyPrefixFilter(int64_t capacity)
+    : capacity_(std::max<int64_t>(capacity, 1)),
+      bits_((capacity_ * kBitsPerPrefix + 63) / 64) {}
+
+int64_t KeyPrefixFilter::BitIndex(uint64_t hash, int i) const {
+  // Derives the hash functions from two halves of a single hash.
+  const uint64_t h1 = hash & 0xffffffff;
+  const uint64_t h2 = (hash >> 32) | 1;
+  return (h1 + i * h2) % (bits_.size() * 64);
+}
+
+void KeyPrefixFilter::Add(const Key& key) {
+  uint64_t hash = 0;
+  for (int n = 1; n <= key.NumColumns(); ++n) {
+    hash = ExtendPrefixHash(hash, key, n);
+    for (int i = 0; i < kNumProbes; ++i) {
+      const int64_t bit = BitIndex(hash, i);
+      bits_[bit / 64] |= uint64_t{1} << (bit % 64);
+    }
+    ++num_prefixes_;
+  }
+}
+
+bool KeyPrefixFilter::MayContainPrefix(const Key& prefix) const {
+  if (prefix.NumColumns() == 0) {
+    return true;
+  }
+  uint64_t hash = 0;
+  for (int n = 1; n <= prefix.NumColumns(); ++n) {
+    hash = ExtendPrefixHash(hash, prefix, n);
+  }
+  for (int i = 0; i < kNumProbes; ++i) {
+    const int64_t bit = BitIndex(hash, i);
+    if ((bits_[bit / 64] & (uint64_t{1} << (bit % 64))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
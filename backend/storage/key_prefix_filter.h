@@ -0,0 +1,78 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_KEY_PREFIX_FILTER_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_KEY_PREFIX_FILTER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "backend/datamodel/key.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// KeyPrefixFilter is a bloom filter over every prefix of the keys of a table.
+//
+// Checks such as "does the parent row have children" or "is the referenced row
+// referenced" look for rows with a given key prefix, and usually find none.
+// The filter answers most of those negative checks without searching the
+// table: MayContainPrefix never returns false for a prefix of an added key,
+// and returns true for other prefixes with a probability of about 1% as long
+// as no more than `capacity` prefixes were added.
+//
+// Keys cannot be removed from the filter. Owners are expected to replace a full
+// filter by a larger one holding the same keys.
+//
+// This class is not thread-safe.
+class KeyPrefixFilter {
+ public:
+  // Default number of prefixes the filter is sized for.
+  static constexpr int64_t kDefaultCapacity = 1024;
+
+  explicit KeyPrefixFilter(int64_t capacity = kDefaultCapacity);
+
+  // Adds all non-empty prefixes of `key`, including `key` itself.
+  void Add(const Key& key);
+
+  // Returns false if `prefix` is definitely not a prefix of any added key.
+  // Always returns true for the empty prefix.
+  bool MayContainPrefix(const Key& prefix) const;
+
+  // Returns true if more prefixes were added than the filter is sized for, in
+  // which case its false positive rate is higher than intended.
+  bool IsFull() const { return num_prefixes_ > capacity_; }
+
+  // Returns the number of prefixes the filter is sized for.
+  int64_t capacity() const { return capacity_; }
+
+ private:
+  // Returns the bit probed by the i-th hash function for the given hash.
+  int64_t BitIndex(uint64_t hash, int i) const;
+
+  int64_t capacity_;
+  int64_t num_prefixes_ = 0;
+  std::vector<uint64_t> bits_;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_KEY_PREFIX_FILTER_H_
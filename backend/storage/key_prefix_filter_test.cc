@@ -0,0 +1,76 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/storage/key_prefix_filter.h"
+
+#include "zetasql/public/value.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "backend/datamodel/key.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using zetasql::values::Int64;
+using zetasql::values::String;
+
+TEST(KeyPrefixFilterTest, ContainsAllPrefixesOfAddedKeys) {
+  KeyPrefixFilter filter;
+  filter.Add(Key({String("parent"), Int64(1), Int64(2)}));
+
+  EXPECT_TRUE(filter.MayContainPrefix(Key()));
+  EXPECT_TRUE(filter.MayContainPrefix(Key({String("parent")})));
+  EXPECT_TRUE(filter.MayContainPrefix(Key({String("parent"), Int64(1)})));
+  EXPECT_TRUE(
+      filter.MayContainPrefix(Key({String("parent"), Int64(1), Int64(2)})));
+}
+
+TEST(KeyPrefixFilterTest, RejectsMostAbsentPrefixes) {
+  KeyPrefixFilter filter(/*capacity=*/2000);
+  for (int i = 0; i < 1000; ++i) {
+    filter.Add(Key({Int64(i), Int64(i)}));
+  }
+  EXPECT_FALSE(filter.IsFull());
+
+  int false_positives = 0;
+  for (int i = 1000; i < 2000; ++i) {
+    EXPECT_TRUE(filter.MayContainPrefix(Key({Int64(i - 1000)})));
+    if (filter.MayContainPrefix(Key({Int64(i)}))) {
+      ++false_positives;
+    }
+  }
+  // The expected false positive rate is about 1%.
+  EXPECT_LT(false_positives, 50);
+}
+
+TEST(KeyPrefixFilterTest, IsFullOnceCapacityIsExceeded) {
+  KeyPrefixFilter filter(/*capacity=*/4);
+  filter.Add(Key({Int64(1), Int64(1)}));
+  filter.Add(Key({Int64(1), Int64(2)}));
+  EXPECT_FALSE(filter.IsFull());
+
+  filter.Add(Key({Int64(2), Int64(1)}));
+  EXPECT_TRUE(filter.IsFull());
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
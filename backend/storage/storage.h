@@ -17,6 +17,10 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_STORAGE_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_STORAGE_H_
 
+#include <cstdint>
+#include <utility>
+#include <vector>
+
 #include "zetasql/public/value.h"
 #include "absl/time/time.h"
 #include "backend/common/ids.h"
@@ -30,11 +34,45 @@ namespace spanner {
 namespace emulator {
 namespace backend {
 
+// Statistics of the latest state of a table, maintained incrementally by
+// storage as rows are written.
+struct TableStats {
+  // Number of rows which currently exist.
+  int64_t row_count = 0;
+
+  // Estimated number of bytes held by the keys and all value versions of the
+  // table, including those of deleted rows.
+  int64_t byte_size = 0;
+
+  // Uniform random sample of the keys ever written to the table, in key order.
+  // Consecutive sample keys split the key space into ranges holding about the
+  // same number of rows, i.e. the sample is an equi-depth key histogram.
+  std::vector<Key> key_sample;
+};
+
+// A contiguous key range of a table, which storage manages as a unit. Splits
+// divide automatically as they grow, and do not affect the results of reads or
+// writes.
+struct TableSplit {
+  // First key of the split. The split extends to the start key of the next
+  // split, or to the end of the table for the last split. The start key of
+  // the first split is the empty key.
+  Key start_key;
+
+  // Number of rows of the split which currently exist.
+  int64_t row_count = 0;
+
+  // Estimated number of bytes held by the keys and all value versions of the
+  // rows of the split.
+  int64_t byte_size = 0;
+};
+
 // Storage defines the interface for a multi-version data store.
 //
 // There will be a Storage instance for each database created. The current
-// interface is grow-only, i.e. once data is added, it will not be deleted.
-// Storage is thread-safe.
+// interface is grow-only, i.e. once data is added, it will not be deleted,
+// except that dropping a table discards all of its data. Storage is
+// thread-safe.
 class Storage {
  public:
   virtual ~Storage() {}
@@ -58,6 +96,32 @@ class Storage {
                             const std::vector<ColumnID>& column_ids,
                             std::unique_ptr<StorageIterator>* itr) const = 0;
 
+  // Returns in 'count' the number of rows of the given table which exist at the
+  // specified timestamp, without reading any of their column values.
+  virtual absl::Status CountRows(absl::Time timestamp, const TableID& table_id,
+                                 int64_t* count) const = 0;
+
+  // Returns in 'stats' the statistics of the latest state of the given table.
+  // Tables which were never written have empty statistics.
+  virtual absl::Status GetTableStats(const TableID& table_id,
+                                     TableStats* stats) const = 0;
+
+  // Returns in 'splits' the splits of the given table in key order, which
+  // readers may align the partitioning of key ranges with. Tables which were
+  // never written have a single empty split.
+  virtual absl::Status GetTableSplits(
+      const TableID& table_id, std::vector<TableSplit>* splits) const = 0;
+
+  // Declares that the given child table is interleaved in the given parent
+  // table, whose keys have parent_key_size columns (which prefix the keys of
+  // the child table). Storage may use this to keep the rows of the child table
+  // close to those of their parent rows. Must be called before any rows are
+  // written to the child table and after the parent table itself was
+  // declared, and may be repeated.
+  virtual absl::Status InterleaveTable(const TableID& child_table_id,
+                                       const TableID& parent_table_id,
+                                       int parent_key_size) = 0;
+
   // Writes column values for given key at the specified timestamp. Column value
   // will be overwritten for non-unique <timestamp, table_id, key, column_id>
   // combination.
@@ -72,6 +136,21 @@ class Storage {
   // ranges will result in INVALID_ARGUMENT.
   virtual absl::Status Delete(absl::Time timestamp, const TableID& table_id,
                               const KeyRange& key_range) = 0;
+
+  // Loads rows into an empty table at the specified timestamp. Each row is a
+  // key and the values for column_ids. Rows need not be sorted but keys must be
+  // unique. This is equivalent to, but much faster than, calling Write for each
+  // row and is used to restore database snapshots.
+  virtual absl::Status BulkLoad(
+      absl::Time timestamp, const TableID& table_id,
+      const std::vector<ColumnID>& column_ids,
+      std::vector<std::pair<Key, std::vector<zetasql::Value>>> rows) = 0;
+
+  // Discards all the versions of all the rows of the given table, which reads
+  // at any timestamp then find empty. Tables interleaved in the given table
+  // must be dropped first. Dropping a table which was never written is a
+  // no-op.
+  virtual absl::Status DropTable(const TableID& table_id) = 0;
 };
 
 }  // namespace backend
@@ -0,0 +1,55 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/storage/string_dictionary.h"
+
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+zetasql::Value StringDictionary::Intern(const zetasql::Value& value) {
+  if (!enabled_ || !value.is_valid() || value.is_null() ||
+      value.type_kind() != zetasql::TYPE_STRING) {
+    return value;
+  }
+
+  auto itr = entries_.find(value.string_value());
+  if (itr != entries_.end()) {
+    return itr->second;
+  }
+
+  if (entries_.size() >= max_entries_) {
+    // The column has too many distinct values to benefit from dictionary
+    // encoding, stop tracking it.
+    enabled_ = false;
+    entries_.clear();
+    return value;
+  }
+
+  // The copy of the value stored in the map shares its string buffer with
+  // 'value', so the key can point into the buffer of either.
+  entries_.emplace(value.string_value(), value);
+  return value;
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,80 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_STRING_DICTIONARY_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_STRING_DICTIONARY_H_
+
+#include <cstdint>
+
+#include "zetasql/public/value.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// StringDictionary interns the STRING values written to a single column.
+//
+// zetasql::Value copies of a STRING share a reference-counted buffer. By
+// handing out a canonical copy for every distinct string seen in a column,
+// cells holding the same string share a single buffer instead of each owning
+// their own. This is a large memory saving for low-cardinality columns (e.g.
+// status codes, country names, enum-like tags) in large datasets.
+//
+// The encoding is chosen automatically from the observed cardinality: once the
+// number of distinct values exceeds max_entries, the column is considered high
+// cardinality, the dictionary is released and values are stored as-is from
+// then on. Values that were already interned keep sharing their buffers.
+//
+// This class is not thread-safe.
+class StringDictionary {
+ public:
+  // Default number of distinct values tracked before a column is considered
+  // high cardinality and dictionary encoding is abandoned.
+  static constexpr int64_t kDefaultMaxEntries = 1024;
+
+  explicit StringDictionary(int64_t max_entries = kDefaultMaxEntries)
+      : max_entries_(max_entries) {}
+
+  // Returns a value equal to `value` which shares its string buffer with all
+  // previously interned equal values. Non-STRING, NULL and invalid values, as
+  // well as all values once the dictionary is disabled, are returned as-is.
+  zetasql::Value Intern(const zetasql::Value& value);
+
+  // Returns true if the column is still dictionary encoded.
+  bool enabled() const { return enabled_; }
+
+  // Returns the number of distinct values currently in the dictionary.
+  int64_t size() const { return entries_.size(); }
+
+ private:
+  const int64_t max_entries_;
+  bool enabled_ = true;
+
+  // Interned values by their strings. The keys point into the string buffers
+  // of the values they map to, so that each string is stored once. The buffers
+  // are shared by all copies of a value and do not move when the map rehashes.
+  absl::flat_hash_map<absl::string_view, zetasql::Value> entries_;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_STORAGE_STRING_DICTIONARY_H_
@@ -0,0 +1,102 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/storage/string_dictionary.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
+#include "absl/strings/str_cat.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using zetasql::values::Int64;
+using zetasql::values::NullString;
+using zetasql::values::String;
+
+TEST(StringDictionaryTest, EqualStringsShareBuffers) {
+  StringDictionary dictionary;
+
+  zetasql::Value first = dictionary.Intern(String("ACTIVE"));
+  zetasql::Value second = dictionary.Intern(String("ACTIVE"));
+
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(first.string_value().data(), second.string_value().data());
+  EXPECT_EQ(dictionary.size(), 1);
+}
+
+TEST(StringDictionaryTest, DistinctStringsAreKeptApart) {
+  StringDictionary dictionary;
+
+  EXPECT_EQ(dictionary.Intern(String("ACTIVE")), String("ACTIVE"));
+  EXPECT_EQ(dictionary.Intern(String("INACTIVE")), String("INACTIVE"));
+  EXPECT_EQ(dictionary.size(), 2);
+}
+
+TEST(StringDictionaryTest, EntriesOutliveTheInternedValues) {
+  StringDictionary dictionary;
+  // Enough distinct values to rehash the dictionary several times. Only the
+  // dictionary keeps them.
+  for (int i = 0; i < 100; ++i) {
+    dictionary.Intern(String(absl::StrCat("value-", i)));
+  }
+
+  for (int i = 0; i < 100; ++i) {
+    const std::string string = absl::StrCat("value-", i);
+    zetasql::Value first = dictionary.Intern(String(string));
+    zetasql::Value second = dictionary.Intern(String(string));
+    EXPECT_EQ(first, String(string));
+    EXPECT_EQ(first.string_value().data(), second.string_value().data());
+  }
+  EXPECT_EQ(dictionary.size(), 100);
+}
+
+TEST(StringDictionaryTest, NonStringValuesArePassedThrough) {
+  StringDictionary dictionary;
+
+  EXPECT_EQ(dictionary.Intern(Int64(1)), Int64(1));
+  EXPECT_TRUE(dictionary.Intern(NullString()).is_null());
+  EXPECT_FALSE(dictionary.Intern(zetasql::Value()).is_valid());
+  EXPECT_EQ(dictionary.size(), 0);
+}
+
+TEST(StringDictionaryTest, HighCardinalityDisablesDictionary) {
+  StringDictionary dictionary(/*max_entries=*/2);
+
+  dictionary.Intern(String("a"));
+  dictionary.Intern(String("b"));
+  EXPECT_TRUE(dictionary.enabled());
+
+  EXPECT_EQ(dictionary.Intern(String("c")), String("c"));
+  EXPECT_FALSE(dictionary.enabled());
+  EXPECT_EQ(dictionary.size(), 0);
+
+  // Values are still returned unchanged once the dictionary is disabled.
+  EXPECT_EQ(dictionary.Intern(String("a")), String("a"));
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
@@ -0,0 +1,219 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Measures how InMemoryStorage indexes the rows of a table by key (a hash map
+// owning the rows, and a B-tree of pointers to them in key order) against a
+// std::map from keys to rows (one node per row): loading rows in key order
+// (BulkLoad), writing them in random order (Write), looking rows up by key
+// (Lookup) and scanning key ranges (Read).
+//
+// Each table has an INT64 key column and an INT64 value column. With the
+// default of 10 million rows, the benchmark needs about 4.5 GiB of memory.
+//
+// Usage:
+//   bazel run -c opt //backend/storage:table_index_benchmark -- --num_rows=N
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "zetasql/public/value.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "backend/common/ids.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/storage/in_memory_storage.h"
+#include "backend/storage/iterator.h"
+
+ABSL_FLAG(int64_t, num_rows, 10000000, "Number of rows of the table.");
+
+ABSL_FLAG(int64_t, scan_length, 100, "Number of rows read by each range scan.");
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+const TableID kTableId = "table";
+const std::vector<ColumnID> kColumnIds = {"value"};
+
+// Keeps the results of the benchmarked loops from being optimized away.
+volatile int64_t sink = 0;
+
+Key MakeKey(int64_t i) {
+  return Key(std::vector<zetasql::Value>{zetasql::values::Int64(i)});
+}
+
+std::vector<zetasql::Value> MakeValues(int64_t i) {
+  return {zetasql::values::Int64(i)};
+}
+
+// Prints the average duration of the `num_ops` operations which took
+// `elapsed` in total.
+void Report(absl::string_view index_name, absl::string_view operation,
+            absl::Duration elapsed, int64_t num_ops) {
+  absl::PrintF("%-16s %-10s %10.1f ns/op\n", index_name, operation,
+               absl::ToDoubleNanoseconds(elapsed) / num_ops);
+}
+
+// Runs the benchmarks against InMemoryStorage. `order` holds the row numbers
+// in random order.
+void RunStorageBenchmarks(const std::vector<int64_t>& order) {
+  const int64_t num_rows = order.size();
+  const absl::Time timestamp = absl::Now();
+  {
+    std::vector<std::pair<Key, std::vector<zetasql::Value>>> rows;
+    rows.reserve(num_rows);
+    for (int64_t i = 0; i < num_rows; ++i) {
+      rows.emplace_back(MakeKey(i), MakeValues(i));
+    }
+    InMemoryStorage storage;
+    const absl::Time start = absl::Now();
+    if (!storage.BulkLoad(timestamp, kTableId, kColumnIds, std::move(rows))
+             .ok()) {
+      absl::PrintF("BulkLoad failed\n");
+      return;
+    }
+    Report("InMemoryStorage", "bulk_load", absl::Now() - start, num_rows);
+  }
+
+  InMemoryStorage storage;
+  absl::Time start = absl::Now();
+  for (int64_t i : order) {
+    if (!storage.Write(timestamp, kTableId, MakeKey(i), kColumnIds,
+                       MakeValues(i))
+             .ok()) {
+      absl::PrintF("Write failed\n");
+      return;
+    }
+  }
+  Report("InMemoryStorage", "write", absl::Now() - start, num_rows);
+
+  int64_t checksum = 0;
+  std::vector<zetasql::Value> values;
+  start = absl::Now();
+  for (int64_t i : order) {
+    if (!storage.Lookup(timestamp, kTableId, MakeKey(i), kColumnIds, &values)
+             .ok()) {
+      absl::PrintF("Lookup failed\n");
+      return;
+    }
+    checksum += values[0].int64_value();
+  }
+  Report("InMemoryStorage", "lookup", absl::Now() - start, num_rows);
+
+  // Scans start at random keys, and are reported per row read.
+  const int64_t scan_length = absl::GetFlag(FLAGS_scan_length);
+  const int64_t num_scans = std::max<int64_t>(1, num_rows / scan_length);
+  int64_t num_scanned_rows = 0;
+  start = absl::Now();
+  for (int64_t i = 0; i < num_scans; ++i) {
+    std::unique_ptr<StorageIterator> itr;
+    if (!storage
+             .Read(timestamp, kTableId,
+                   KeyRange::ClosedOpen(MakeKey(order[i]),
+                                        MakeKey(order[i] + scan_length)),
+                   kColumnIds, &itr)
+             .ok()) {
+      absl::PrintF("Read failed\n");
+      return;
+    }
+    while (itr->Next()) {
+      checksum += itr->ColumnValue(0).int64_value();
+      ++num_scanned_rows;
+    }
+  }
+  Report("InMemoryStorage", "scan", absl::Now() - start, num_scanned_rows);
+  sink = checksum;
+}
+
+// Runs the same benchmarks against a std::map holding the values of each row.
+void RunMapBenchmarks(const std::vector<int64_t>& order) {
+  using Map = std::map<Key, std::vector<zetasql::Value>>;
+  const int64_t num_rows = order.size();
+  {
+    Map map;
+    const absl::Time start = absl::Now();
+    for (int64_t i = 0; i < num_rows; ++i) {
+      map.emplace_hint(map.end(), MakeKey(i), MakeValues(i));
+    }
+    Report("std::map", "bulk_load", absl::Now() - start, num_rows);
+  }
+
+  Map map;
+  absl::Time start = absl::Now();
+  for (int64_t i : order) {
+    map.insert_or_assign(MakeKey(i), MakeValues(i));
+  }
+  Report("std::map", "write", absl::Now() - start, num_rows);
+
+  int64_t checksum = 0;
+  std::vector<zetasql::Value> values;
+  start = absl::Now();
+  for (int64_t i : order) {
+    values = map.find(MakeKey(i))->second;
+    checksum += values[0].int64_value();
+  }
+  Report("std::map", "lookup", absl::Now() - start, num_rows);
+
+  const int64_t scan_length = absl::GetFlag(FLAGS_scan_length);
+  const int64_t num_scans = std::max<int64_t>(1, num_rows / scan_length);
+  int64_t num_scanned_rows = 0;
+  start = absl::Now();
+  for (int64_t i = 0; i < num_scans; ++i) {
+    const Key limit_key = MakeKey(order[i] + scan_length);
+    for (auto itr = map.lower_bound(MakeKey(order[i]));
+         itr != map.end() && itr->first < limit_key; ++itr) {
+      values = itr->second;
+      checksum += values[0].int64_value();
+      ++num_scanned_rows;
+    }
+  }
+  Report("std::map", "scan", absl::Now() - start, num_scanned_rows);
+  sink = checksum;
+}
+
+}  // namespace
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+int main(int argc, char** argv) {
+  namespace backend = ::google::spanner::emulator::backend;
+  absl::ParseCommandLine(argc, argv);
+
+  std::vector<int64_t> order(absl::GetFlag(FLAGS_num_rows));
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), std::mt19937_64(/*seed=*/0));
+
+  backend::RunStorageBenchmarks(order);
+  backend::RunMapBenchmarks(order);
+  return 0;
+}
@@ -0,0 +1,80 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/transaction/change_log.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "common/errors.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+void ChangeLog::Append(std::vector<ChangeRecord> records) {
+  if (!enabled() || records.empty()) {
+    return;
+  }
+  absl::MutexLock lock(&mu_);
+  std::move(records.begin(), records.end(), std::back_inserter(records_));
+  while (records_.size() > capacity_) {
+    evicted_through_ = records_.front().commit_timestamp;
+    records_.pop_front();
+  }
+}
+
+zetasql_base::StatusOr<std::vector<ChangeRecord>> ChangeLog::Read(
+    absl::Time start, absl::Time deadline, int64_t max_records) {
+  absl::MutexLock lock(&mu_);
+  if (start <= evicted_through_) {
+    return error::ChangeLogTruncated(start, evicted_through_);
+  }
+  auto has_records = [&]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return !records_.empty() && records_.back().commit_timestamp >= start;
+  };
+  mu_.AwaitWithDeadline(absl::Condition(&has_records), deadline);
+  // Records may have been evicted while waiting.
+  if (start <= evicted_through_) {
+    return error::ChangeLogTruncated(start, evicted_through_);
+  }
+
+  auto itr = std::lower_bound(records_.begin(), records_.end(), start,
+                              [](const ChangeRecord& record, absl::Time time) {
+                                return record.commit_timestamp < time;
+                              });
+  std::vector<ChangeRecord> records;
+  for (; itr != records_.end(); ++itr) {
+    // Only stop at commit boundaries so that callers can resume reading from
+    // the next commit timestamp.
+    if (records.size() >= max_records &&
+        itr->commit_timestamp != records.back().commit_timestamp) {
+      break;
+    }
+    records.push_back(*itr);
+  }
+  return records;
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
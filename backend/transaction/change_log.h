@@ -0,0 +1,103 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_CHANGE_LOG_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_CHANGE_LOG_H_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/value.h"
+#include "zetasql/base/statusor.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// ChangeRecord describes a single row change committed to a user table.
+struct ChangeRecord {
+  enum class Type { kInsert, kUpdate, kDelete };
+
+  absl::Time commit_timestamp;
+  Type type;
+
+  // Name of the changed table.
+  std::string table;
+
+  // Primary key of the changed row.
+  Key key;
+
+  // Columns written by the change and their new values. Empty for deletes.
+  std::vector<std::string> columns;
+  ValueList values;
+};
+
+// ChangeLog retains the most recent row changes committed to a database in a
+// fixed capacity ring buffer, so that they can be tailed by change consumers.
+//
+// Records are appended by the committing transaction in commit timestamp order.
+// This class is thread-safe.
+class ChangeLog {
+ public:
+  // Creates a log retaining up to `capacity` records. A capacity of zero
+  // disables the log.
+  explicit ChangeLog(int64_t capacity) : capacity_(capacity) {}
+
+  // Returns true if the log retains any records.
+  bool enabled() const { return capacity_ > 0; }
+
+  // Appends the changes made by a single commit, evicting the oldest records
+  // beyond the capacity of the log.
+  void Append(std::vector<ChangeRecord> records) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns records committed at or after `start`, oldest first. Stops at the
+  // first commit boundary after `max_records` records, so that the changes of a
+  // commit are never split across calls. If there are none, waits until
+  // `deadline` for one to be committed and returns an empty list if none is.
+  // Returns an error if records committed at or after `start` have already been
+  // evicted from the log.
+  zetasql_base::StatusOr<std::vector<ChangeRecord>> Read(absl::Time start,
+                                                 absl::Time deadline,
+                                                 int64_t max_records)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // Maximum number of records retained.
+  const int64_t capacity_;
+
+  // Mutex to guard state below.
+  mutable absl::Mutex mu_;
+
+  // Retained records, in commit timestamp order.
+  std::deque<ChangeRecord> records_ ABSL_GUARDED_BY(mu_);
+
+  // Commit timestamp of the most recently evicted record.
+  absl::Time evicted_through_ ABSL_GUARDED_BY(mu_) = absl::InfinitePast();
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_CHANGE_LOG_H_
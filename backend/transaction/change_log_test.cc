@@ -0,0 +1,122 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/transaction/change_log.h"
+
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "zetasql/public/value.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "backend/datamodel/key.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+using zetasql::values::Int64;
+using zetasql_base::testing::StatusIs;
+
+ChangeRecord Insert(absl::Time commit_timestamp, int64_t key) {
+  return ChangeRecord{.commit_timestamp = commit_timestamp,
+                      .type = ChangeRecord::Type::kInsert,
+                      .table = "T",
+                      .key = Key({Int64(key)}),
+                      .columns = {"k"},
+                      .values = {Int64(key)}};
+}
+
+std::vector<Key> Keys(const std::vector<ChangeRecord>& records) {
+  std::vector<Key> keys;
+  for (const ChangeRecord& record : records) {
+    keys.push_back(record.key);
+  }
+  return keys;
+}
+
+TEST(ChangeLogTest, ReadsRecordsCommittedSinceStart) {
+  absl::Time t0 = absl::Now();
+  ChangeLog change_log(/*capacity=*/10);
+  change_log.Append({Insert(t0, 1), Insert(t0, 2)});
+  change_log.Append({Insert(t0 + absl::Seconds(1), 3)});
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::vector<ChangeRecord> records,
+                       change_log.Read(t0 + absl::Seconds(1), absl::Now(),
+                                       /*max_records=*/10));
+  EXPECT_THAT(Keys(records), testing::ElementsAre(Key({Int64(3)})));
+
+  // Reads stop at commit boundaries.
+  ZETASQL_ASSERT_OK_AND_ASSIGN(records,
+                       change_log.Read(t0, absl::Now(), /*max_records=*/1));
+  EXPECT_THAT(Keys(records),
+              testing::ElementsAre(Key({Int64(1)}), Key({Int64(2)})));
+}
+
+TEST(ChangeLogTest, ReadTimesOutWithoutNewRecords) {
+  absl::Time t0 = absl::Now();
+  ChangeLog change_log(/*capacity=*/10);
+  change_log.Append({Insert(t0, 1)});
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::vector<ChangeRecord> records,
+      change_log.Read(t0 + absl::Seconds(1),
+                      absl::Now() + absl::Milliseconds(10), 10));
+  EXPECT_TRUE(records.empty());
+}
+
+TEST(ChangeLogTest, ReadWaitsForNewRecords) {
+  absl::Time t0 = absl::Now();
+  ChangeLog change_log(/*capacity=*/10);
+  std::thread writer([&]() {
+    absl::SleepFor(absl::Milliseconds(10));
+    change_log.Append({Insert(t0, 1)});
+  });
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::vector<ChangeRecord> records,
+      change_log.Read(t0, absl::Now() + absl::Seconds(30), 10));
+  EXPECT_THAT(Keys(records), testing::ElementsAre(Key({Int64(1)})));
+  writer.join();
+}
+
+TEST(ChangeLogTest, EvictedRecordsCannotBeRead) {
+  absl::Time t0 = absl::Now();
+  ChangeLog change_log(/*capacity=*/2);
+  change_log.Append({Insert(t0, 1)});
+  change_log.Append({Insert(t0 + absl::Seconds(1), 2)});
+  change_log.Append({Insert(t0 + absl::Seconds(2), 3)});
+
+  EXPECT_THAT(change_log.Read(t0, absl::Now(), 10),
+              StatusIs(absl::StatusCode::kOutOfRange));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::vector<ChangeRecord> records,
+      change_log.Read(t0 + absl::Seconds(1), absl::Now(), 10));
+  EXPECT_THAT(Keys(records),
+              testing::ElementsAre(Key({Int64(2)}), Key({Int64(3)})));
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
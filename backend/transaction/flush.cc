@@ -16,8 +16,13 @@
 
 #include "backend/transaction/flush.h"
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "backend/common/variant.h"
 #include "backend/transaction/commit_timestamp.h"
+#include "zetasql/base/status_macros.h"
 
 namespace google {
 namespace spanner {
@@ -26,8 +31,31 @@ namespace backend {
 
 namespace {
 
+// Records a change to `table` in `changes`, unless `changes` is null or the
+// table backs an index.
+void MaybeRecordChange(ChangeRecord::Type type, const Table* table,
+                       const Key& key,
+                       const std::vector<const Column*>& columns,
+                       const ValueList& values, absl::Time commit_timestamp,
+                       std::vector<ChangeRecord>* changes) {
+  if (changes == nullptr || table->owner_index() != nullptr) {
+    return;
+  }
+  ChangeRecord change{.commit_timestamp = commit_timestamp,
+                      .type = type,
+                      .table = table->Name(),
+                      .key = key,
+                      .values = values};
+  change.columns.reserve(columns.size());
+  for (const Column* column : columns) {
+    change.columns.push_back(column->Name());
+  }
+  changes->push_back(std::move(change));
+}
+
 absl::Status FlushInsert(const InsertOp& insert_op, Storage* base_storage,
-                         absl::Time commit_timestamp) {
+                         absl::Time commit_timestamp,
+                         std::vector<ChangeRecord>* changes) {
   const Table* table = insert_op.table;
   const Key key = MaybeSetCommitTimestamp(table->primary_key(), insert_op.key,
                                           commit_timestamp);
@@ -38,12 +66,16 @@ absl::Status FlushInsert(const InsertOp& insert_op, Storage* base_storage,
     column_values.push_back(MaybeSetCommitTimestamp(
         insert_op.columns[i], insert_op.values[i], commit_timestamp));
   }
-  return base_storage->Write(commit_timestamp, table->id(), key, column_ids,
-                             column_values);
+  ZETASQL_RETURN_IF_ERROR(base_storage->Write(commit_timestamp, table->id(), key,
+                                      column_ids, column_values));
+  MaybeRecordChange(ChangeRecord::Type::kInsert, table, key, insert_op.columns,
+                    column_values, commit_timestamp, changes);
+  return absl::OkStatus();
 }
 
 absl::Status FlushUpdate(const UpdateOp& update_op, Storage* base_storage,
-                         absl::Time commit_timestamp) {
+                         absl::Time commit_timestamp,
+                         std::vector<ChangeRecord>* changes) {
   const Table* table = update_op.table;
   const Key key = MaybeSetCommitTimestamp(table->primary_key(), update_op.key,
                                           commit_timestamp);
@@ -54,35 +86,67 @@ absl::Status FlushUpdate(const UpdateOp& update_op, Storage* base_storage,
     column_values.push_back(MaybeSetCommitTimestamp(
         update_op.columns[i], update_op.values[i], commit_timestamp));
   }
-  return base_storage->Write(commit_timestamp, table->id(), key, column_ids,
-                             column_values);
+  ZETASQL_RETURN_IF_ERROR(base_storage->Write(commit_timestamp, table->id(), key,
+                                      column_ids, column_values));
+  MaybeRecordChange(ChangeRecord::Type::kUpdate, table, key, update_op.columns,
+                    column_values, commit_timestamp, changes);
+  return absl::OkStatus();
 }
 
 absl::Status FlushDelete(const DeleteOp& delete_op, Storage* base_storage,
-                         absl::Time commit_timestamp) {
-  return base_storage->Delete(commit_timestamp, delete_op.table->id(),
-                              KeyRange::Point(delete_op.key));
+                         absl::Time commit_timestamp,
+                         std::vector<ChangeRecord>* changes) {
+  const Table* table = delete_op.table;
+  ZETASQL_RETURN_IF_ERROR(base_storage->Delete(commit_timestamp, table->id(),
+                                       KeyRange::Point(delete_op.key)));
+  MaybeRecordChange(ChangeRecord::Type::kDelete, table, delete_op.key, {}, {},
+                    commit_timestamp, changes);
+  return absl::OkStatus();
 }
 
 }  // namespace
 
 absl::Status FlushWriteOpsToStorage(const std::vector<WriteOp>& write_ops,
                                     Storage* base_storage,
-                                    absl::Time commit_timestamp) {
-  for (const auto& write_op : write_ops) {
-    ZETASQL_RETURN_IF_ERROR(std::visit(
+                                    absl::Time commit_timestamp,
+                                    ChangeLog* change_log) {
+  return FlushWriteOpStreamToStorage(
+      [&](const WriteOpVisitor& visit) -> absl::Status {
+        for (const auto& write_op : write_ops) {
+          ZETASQL_RETURN_IF_ERROR(visit(write_op));
+        }
+        return absl::OkStatus();
+      },
+      base_storage, commit_timestamp, change_log);
+}
+
+absl::Status FlushWriteOpStreamToStorage(
+    const std::function<absl::Status(const WriteOpVisitor&)>& for_each_op,
+    Storage* base_storage, absl::Time commit_timestamp,
+    ChangeLog* change_log) {
+  std::vector<ChangeRecord> changes;
+  std::vector<ChangeRecord>* changes_ptr =
+      change_log != nullptr && change_log->enabled() ? &changes : nullptr;
+  ZETASQL_RETURN_IF_ERROR(for_each_op([&](const WriteOp& write_op) {
+    return std::visit(
         overloaded{
             [&](const InsertOp& insert_op) {
-              return FlushInsert(insert_op, base_storage, commit_timestamp);
+              return FlushInsert(insert_op, base_storage, commit_timestamp,
+                                 changes_ptr);
             },
             [&](const UpdateOp& update_op) {
-              return FlushUpdate(update_op, base_storage, commit_timestamp);
+              return FlushUpdate(update_op, base_storage, commit_timestamp,
+                                 changes_ptr);
             },
             [&](const DeleteOp& delete_op) {
-              return FlushDelete(delete_op, base_storage, commit_timestamp);
+              return FlushDelete(delete_op, base_storage, commit_timestamp,
+                                 changes_ptr);
             },
         },
-        write_op));
+        write_op);
+  }));
+  if (changes_ptr != nullptr) {
+    change_log->Append(std::move(changes));
   }
   return absl::OkStatus();
 }
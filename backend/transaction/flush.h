@@ -17,7 +17,13 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_FLUSH_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_FLUSH_H_
 
+#include <functional>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
 #include "backend/actions/ops.h"
+#include "backend/transaction/change_log.h"
 
 namespace google {
 namespace spanner {
@@ -30,9 +36,24 @@ namespace backend {
 // Flushes each of the write ops to base storage at the given timestamp. Note
 // that calling this function isn't thread safe and appropriate database locks
 // should be acquired.
+//
+// If `change_log` is not null, the changes made to user tables are appended to
+// it once all ops have been flushed.
 absl::Status FlushWriteOpsToStorage(const std::vector<WriteOp>& write_ops,
                                     Storage* base_storage,
-                                    absl::Time commit_timestamp);
+                                    absl::Time commit_timestamp,
+                                    ChangeLog* change_log = nullptr);
+
+// Visits write ops one at a time, stopping at the first error.
+using WriteOpVisitor = std::function<absl::Status(const WriteOp&)>;
+
+// Same as FlushWriteOpsToStorage, but the write ops are produced by
+// `for_each_op`, which calls the given visitor on each of them in turn. This
+// lets callers flush ops that are not held in memory all at once.
+absl::Status FlushWriteOpStreamToStorage(
+    const std::function<absl::Status(const WriteOpVisitor&)>& for_each_op,
+    Storage* base_storage, absl::Time commit_timestamp,
+    ChangeLog* change_log = nullptr);
 
 }  // namespace backend
 }  // namespace emulator
@@ -24,6 +24,7 @@
 #include "absl/time/time.h"
 #include "backend/actions/ops.h"
 #include "backend/storage/in_memory_storage.h"
+#include "backend/transaction/change_log.h"
 #include "tests/common/schema_constructor.h"
 
 namespace google {
@@ -129,6 +130,31 @@ TEST_F(FlushTest, CanFlushWriteOpsToStorage) {
                                              {Int64(3), String("value")}}));
 }
 
+TEST_F(FlushTest, AppendsFlushedChangesToChangeLog) {
+  absl::Time t0 = absl::Now();
+  ZETASQL_ASSERT_OK(Write(t0, Key({Int64(1)}), {Int64(1), String("value")}));
+
+  absl::Time t1 = t0 + absl::Seconds(1);
+  ChangeLog change_log(/*capacity=*/10);
+  UpdateOp update_op{
+      table_, Key({Int64(1)}), {string_col_}, {String("new-value")}};
+  DeleteOp delete_op{table_, Key({Int64(2)})};
+  ZETASQL_ASSERT_OK(FlushWriteOpsToStorage({update_op, delete_op}, storage_.get(),
+                                   t1, &change_log));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::vector<ChangeRecord> changes,
+                       change_log.Read(t0, absl::Now(), /*max_records=*/10));
+  ASSERT_EQ(changes.size(), 2);
+  EXPECT_EQ(changes[0].commit_timestamp, t1);
+  EXPECT_EQ(changes[0].type, ChangeRecord::Type::kUpdate);
+  EXPECT_EQ(changes[0].table, "TestTable");
+  EXPECT_EQ(changes[0].key, Key({Int64(1)}));
+  EXPECT_THAT(changes[0].columns, testing::ElementsAre("StringCol"));
+  EXPECT_THAT(changes[0].values, testing::ElementsAre(String("new-value")));
+  EXPECT_EQ(changes[1].type, ChangeRecord::Type::kDelete);
+  EXPECT_EQ(changes[1].key, Key({Int64(2)}));
+}
+
 }  // namespace
 }  // namespace backend
 }  // namespace emulator
@@ -17,13 +17,17 @@
 #include "backend/transaction/read_only_transaction.h"
 
 #include <memory>
+#include <vector>
 
 #include "absl/random/random.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
+#include "absl/types/optional.h"
 #include "backend/access/read.h"
 #include "backend/common/ids.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
 #include "backend/datamodel/key_set.h"
 #include "backend/locking/manager.h"
 #include "backend/storage/in_memory_iterator.h"
@@ -43,6 +47,13 @@ namespace {
 
 absl::Duration kMaxStaleReadDuration = absl::Hours(1);
 
+// Returns true if the given canonicalized key ranges span all keys of a table.
+bool SpansAllKeys(const std::vector<KeyRange>& key_ranges) {
+  return key_ranges.size() == 1 &&
+         key_ranges[0].start_key() == Key::Empty() &&
+         key_ranges[0].limit_key() == Key::Infinity();
+}
+
 }  // namespace
 
 ReadOnlyTransaction::ReadOnlyTransaction(
@@ -72,6 +83,17 @@ absl::Status ReadOnlyTransaction::Read(const ReadArg& read_arg,
   ZETASQL_ASSIGN_OR_RETURN(const ResolvedReadArg resolved_read_arg,
                    ResolveReadArg(read_arg, schema()));
 
+  // Reads of all rows without any columns, e.g. for COUNT(*) or emptiness
+  // checks, only need the number of rows which storage keeps track of.
+  if (resolved_read_arg.columns.empty() &&
+      SpansAllKeys(resolved_read_arg.key_ranges)) {
+    int64_t num_rows = 0;
+    ZETASQL_RETURN_IF_ERROR(base_storage_->CountRows(
+        read_timestamp_, resolved_read_arg.table->id(), &num_rows));
+    *cursor = absl::make_unique<CountedRowCursor>(num_rows);
+    return absl::OkStatus();
+  }
+
   std::vector<std::unique_ptr<StorageIterator>> iterators;
   for (const auto& key_range : resolved_read_arg.key_ranges) {
     std::unique_ptr<StorageIterator> itr;
@@ -92,6 +114,19 @@ const Schema* ReadOnlyTransaction::schema() const {
   return versioned_catalog_->GetSchema(read_timestamp_);
 }
 
+absl::optional<absl::Time> ReadOnlyTransaction::SnapshotTimestamp() const {
+  // Once reads at the read timestamp are safe, no more commits can happen at or
+  // before it. The snapshot is then the one written by the last commit, unless
+  // that commit happened after the read timestamp.
+  lock_handle_->WaitForSafeRead(read_timestamp_);
+  if (clock_->Now() - read_timestamp_ >= kMaxStaleReadDuration) {
+    return absl::nullopt;
+  }
+  absl::Time last_commit_timestamp = lock_manager_->LastCommitTimestamp();
+  return last_commit_timestamp <= read_timestamp_ ? last_commit_timestamp
+                                                  : read_timestamp_;
+}
+
 absl::Time ReadOnlyTransaction::PickReadTimestamp() {
   auto get_random_stale_timestamp =
       [this](absl::Time min_timestamp) -> absl::Time {
@@ -22,6 +22,7 @@
 #include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
+#include "absl/types/optional.h"
 #include "backend/access/read.h"
 #include "backend/access/write.h"
 #include "backend/common/ids.h"
@@ -60,6 +61,12 @@ class ReadOnlyTransaction : public RowReader {
   // Returns the schema used by this transaction.
   const Schema* schema() const;
 
+  // Returns the timestamp identifying the snapshot read by this transaction:
+  // the timestamp of the last commit before the read timestamp, such that
+  // transactions reading the same snapshot at different read timestamps share
+  // it. Returns nullopt if the read timestamp is past the version GC limit.
+  absl::optional<absl::Time> SnapshotTimestamp() const;
+
   // Returns the ID of this transaction.
   const TransactionID id() const { return id_; }
 
@@ -19,6 +19,7 @@
 #include <ctime>
 
 #include "zetasql/public/type.h"
+#include "zetasql/public/value.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "zetasql/base/testing/status_matchers.h"
@@ -26,7 +27,11 @@
 #include "absl/status/status.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "backend/access/read.h"
 #include "backend/common/ids.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/datamodel/key_set.h"
 #include "backend/schema/catalog/schema.h"
 #include "backend/schema/catalog/versioned_catalog.h"
 #include "backend/storage/in_memory_storage.h"
@@ -40,6 +45,8 @@ namespace emulator {
 namespace backend {
 namespace {
 
+using zetasql::values::Int64;
+
 class ReadOnlyTransactionTest : public testing::Test {
  protected:
   TransactionID txn_id_ = 1;
@@ -153,6 +160,40 @@ TEST_F(ReadOnlyTransactionTest, WaitsForFutureReadTime) {
   EXPECT_GE(clock_.Now(), opts.timestamp);
 }
 
+TEST_F(ReadOnlyTransactionTest, CountsRowsForReadWithoutColumns) {
+  VersionedCatalog catalog;
+  zetasql::TypeFactory type_factory{};
+  ZETASQL_EXPECT_OK(
+      catalog.AddSchema(t0_, test::CreateSchemaWithOneTable(&type_factory)));
+  const Table* table = catalog.GetLatestSchema()->FindTable("test_table");
+  ASSERT_NE(table, nullptr);
+  const ColumnID column_id = table->FindColumn("int64_col")->id();
+  for (int i = 0; i < 3; ++i) {
+    ZETASQL_EXPECT_OK(storage_.Write(t0_, table->id(), Key({Int64(i)}), {column_id},
+                             {Int64(i)}));
+  }
+  ZETASQL_EXPECT_OK(storage_.Delete(t0_ + absl::Microseconds(1), table->id(),
+                            KeyRange::Point(Key({Int64(0)}))));
+
+  ReadOnlyOptions opts;
+  opts.bound = TimestampBound::kStrongRead;
+  ReadOnlyTransaction txn(opts, txn_id_, &clock_, &storage_, &lock_manager_,
+                          &catalog);
+  ReadArg read_arg;
+  read_arg.table = "test_table";
+  read_arg.key_set = KeySet::All();
+  std::unique_ptr<RowCursor> cursor;
+  ZETASQL_ASSERT_OK(txn.Read(read_arg, &cursor));
+
+  EXPECT_EQ(cursor->NumColumns(), 0);
+  int num_rows = 0;
+  while (cursor->Next()) {
+    ++num_rows;
+  }
+  ZETASQL_EXPECT_OK(cursor->Status());
+  EXPECT_EQ(num_rows, 2);
+}
+
 }  // namespace
 }  // namespace backend
 }  // namespace emulator
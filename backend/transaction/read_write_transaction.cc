@@ -148,17 +148,20 @@ ReadWriteTransaction::ReadWriteTransaction(
     const ReadWriteOptions& options, const RetryState& retry_state,
     TransactionID transaction_id, Clock* clock, Storage* storage,
     LockManager* lock_manager, const VersionedCatalog* const versioned_catalog,
-    ActionManager* action_manager)
+    ActionManager* action_manager, MemoryTracker* memory_tracker,
+    ChangeLog* change_log)
     : options_(options),
       retry_state_(MakeRetryState(retry_state, clock)),
       id_(transaction_id),
       clock_(clock),
       base_storage_(storage),
+      change_log_(change_log),
       versioned_catalog_(versioned_catalog),
       lock_handle_(
           lock_manager->CreateHandle(transaction_id, retry_state_.priority)),
       transaction_store_(absl::make_unique<TransactionStore>(
-          base_storage_, lock_handle_.get())),
+          base_storage_, lock_handle_.get(), memory_tracker,
+          config::transaction_spill_threshold_bytes())),
       action_manager_(action_manager),
       action_context_(absl::make_unique<ActionContext>(
           absl::make_unique<TransactionReadOnlyStore>(transaction_store_.get()),
@@ -208,11 +211,9 @@ absl::Status ReadWriteTransaction::ApplyEffectors(const WriteOp& op) {
 }
 
 absl::Status ReadWriteTransaction::ApplyStatementVerifiers() {
-  for (const auto& write_op : transaction_store_->GetBufferedOps()) {
-    ZETASQL_RETURN_IF_ERROR(
-        action_registry_->ExecuteVerifiers(action_context_.get(), write_op));
-  }
-  return absl::OkStatus();
+  return transaction_store_->ForEachBufferedOp([&](const WriteOp& write_op) {
+    return action_registry_->ExecuteVerifiers(action_context_.get(), write_op);
+  });
 }
 
 const Schema* ReadWriteTransaction::schema() const {
@@ -315,35 +316,53 @@ absl::Status ReadWriteTransaction::ProcessWriteOps(
   return absl::OkStatus();
 }
 
+absl::Status ReadWriteTransaction::ApplyMutation(const Mutation& mutation) {
+  for (const MutationOp& mutation_op : mutation.ops()) {
+    ZETASQL_ASSIGN_OR_RETURN(ResolvedMutationOp resolved_mutation_op,
+                     ResolveMutationOp(mutation_op, schema_, clock_->Now()));
+    // Process Delete.
+    if (resolved_mutation_op.type == MutationOpType::kDelete) {
+      ZETASQL_ASSIGN_OR_RETURN(std::vector<WriteOp> write_ops,
+                       FlattenDeleteOp(resolved_mutation_op.table,
+                                       resolved_mutation_op.key_ranges,
+                                       transaction_store_.get()));
+
+      ZETASQL_RETURN_IF_ERROR(ProcessWriteOps(write_ops));
+    } else {
+      // Process Insert, Update, Replace and InsertOrUpdate.
+      for (int i = 0; i < resolved_mutation_op.rows.size(); i++) {
+        ZETASQL_ASSIGN_OR_RETURN(
+            std::vector<WriteOp> write_ops,
+            FlattenNonDeleteOpRow(
+                resolved_mutation_op.type, resolved_mutation_op.table,
+                resolved_mutation_op.columns, resolved_mutation_op.keys[i],
+                resolved_mutation_op.rows[i], transaction_store_.get()));
+
+        ZETASQL_RETURN_IF_ERROR(ProcessWriteOps(write_ops));
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::Status ReadWriteTransaction::Write(const Mutation& mutation) {
   return GuardedCall(OpType::kWrite, [&]() -> absl::Status {
     mu_.AssertHeld();
+    ZETASQL_RETURN_IF_ERROR(ApplyMutation(mutation));
+    return ApplyStatementVerifiers();
+  });
+}
 
-    for (const MutationOp& mutation_op : mutation.ops()) {
-      ZETASQL_ASSIGN_OR_RETURN(ResolvedMutationOp resolved_mutation_op,
-                       ResolveMutationOp(mutation_op, schema_, clock_->Now()));
-      // Process Delete.
-      if (resolved_mutation_op.type == MutationOpType::kDelete) {
-        ZETASQL_ASSIGN_OR_RETURN(std::vector<WriteOp> write_ops,
-                         FlattenDeleteOp(resolved_mutation_op.table,
-                                         resolved_mutation_op.key_ranges,
-                                         transaction_store_.get()));
+absl::Status ReadWriteTransaction::WritePartial(const Mutation& mutation) {
+  return GuardedCall(OpType::kWrite, [&]() -> absl::Status {
+    mu_.AssertHeld();
+    return ApplyMutation(mutation);
+  });
+}
 
-        ZETASQL_RETURN_IF_ERROR(ProcessWriteOps(write_ops));
-      } else {
-        // Process Insert, Update, Replace and InsertOrUpdate.
-        for (int i = 0; i < resolved_mutation_op.rows.size(); i++) {
-          ZETASQL_ASSIGN_OR_RETURN(
-              std::vector<WriteOp> write_ops,
-              FlattenNonDeleteOpRow(
-                  resolved_mutation_op.type, resolved_mutation_op.table,
-                  resolved_mutation_op.columns, resolved_mutation_op.keys[i],
-                  resolved_mutation_op.rows[i], transaction_store_.get()));
-
-          ZETASQL_RETURN_IF_ERROR(ProcessWriteOps(write_ops));
-        }
-      }
-    }
+absl::Status ReadWriteTransaction::FinishStatement() {
+  return GuardedCall(OpType::kWrite, [&]() -> absl::Status {
+    mu_.AssertHeld();
     return ApplyStatementVerifiers();
   });
 }
@@ -356,12 +375,20 @@ absl::Status ReadWriteTransaction::Commit() {
       return error::AbortReadWriteTransactionOnFirstCommit(id_);
     }
 
+    // Check that the spilled mutations can be read back before picking a
+    // commit timestamp, so that the flush below does not fail part way through
+    // after some of the mutations were written to the base storage.
+    ZETASQL_RETURN_IF_ERROR(transaction_store_->VerifySpilledOps());
+
     // Pick a commit timestamp.
     ZETASQL_ASSIGN_OR_RETURN(commit_timestamp_, lock_handle_->ReserveCommitTimestamp());
 
     // Write the mutations to the base storage.
-    absl::Status flush_status = FlushWriteOpsToStorage(
-        transaction_store_->GetBufferedOps(), base_storage_, commit_timestamp_);
+    absl::Status flush_status = FlushWriteOpStreamToStorage(
+        [&](const WriteOpVisitor& visit) {
+          return transaction_store_->ForEachBufferedOp(visit);
+        },
+        base_storage_, commit_timestamp_, change_log_);
     ZETASQL_RETURN_IF_ERROR(lock_handle_->MarkCommitted());
     if (!flush_status.ok()) {
       return flush_status;
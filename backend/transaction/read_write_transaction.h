@@ -29,6 +29,7 @@
 #include "backend/actions/context.h"
 #include "backend/actions/manager.h"
 #include "backend/common/ids.h"
+#include "backend/common/memory_tracker.h"
 #include "backend/datamodel/key.h"
 #include "backend/locking/handle.h"
 #include "backend/locking/manager.h"
@@ -37,6 +38,7 @@
 #include "backend/schema/catalog/versioned_catalog.h"
 #include "backend/storage/storage.h"
 #include "backend/transaction/actions.h"
+#include "backend/transaction/change_log.h"
 #include "backend/transaction/options.h"
 #include "backend/transaction/transaction_store.h"
 #include "common/clock.h"
@@ -77,7 +79,9 @@ class ReadWriteTransaction : public RowReader, public RowWriter {
                        TransactionID transaction_id, Clock* clock,
                        Storage* storage, LockManager* lock_manager,
                        const VersionedCatalog* const versioned_catalog,
-                       ActionManager* action_manager);
+                       ActionManager* action_manager,
+                       MemoryTracker* memory_tracker = nullptr,
+                       ChangeLog* change_log = nullptr);
 
   absl::Status Read(const ReadArg& read_arg,
                     std::unique_ptr<RowCursor>* cursor) override
@@ -86,6 +90,11 @@ class ReadWriteTransaction : public RowReader, public RowWriter {
   absl::Status Write(const Mutation& mutation) override
       ABSL_LOCKS_EXCLUDED(mu_);
 
+  absl::Status WritePartial(const Mutation& mutation) override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  absl::Status FinishStatement() override ABSL_LOCKS_EXCLUDED(mu_);
+
   absl::Status Commit() ABSL_LOCKS_EXCLUDED(mu_);
 
   absl::Status Rollback() ABSL_LOCKS_EXCLUDED(mu_);
@@ -127,6 +136,11 @@ class ReadWriteTransaction : public RowReader, public RowWriter {
       ABSL_LOCKS_EXCLUDED(mu_);
   absl::Status ProcessWriteOps(const std::vector<WriteOp>& write_ops);
 
+  // Resolves the mutation and buffers its writes, without running the
+  // statement verifiers.
+  absl::Status ApplyMutation(const Mutation& mutation)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Resets the transaction and marks it Active.
   void Reset();
 
@@ -156,6 +170,9 @@ class ReadWriteTransaction : public RowReader, public RowWriter {
   // Underlying storage of the database.
   Storage* base_storage_;
 
+  // Log of the changes committed to the database. May be null.
+  ChangeLog* change_log_;
+
   // Catalog of schemas.
   const VersionedCatalog* const versioned_catalog_;
 
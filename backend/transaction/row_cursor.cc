@@ -66,6 +66,28 @@ const zetasql::Type* StorageIteratorRowCursor::ColumnType(int i) const {
   return columns_.at(i)->GetType();
 }
 
+bool CountedRowCursor::Next() {
+  if (num_rows_ <= 0) {
+    return false;
+  }
+  --num_rows_;
+  return true;
+}
+
+absl::Status CountedRowCursor::Status() const { return absl::OkStatus(); }
+
+int CountedRowCursor::NumColumns() const { return 0; }
+
+const std::string CountedRowCursor::ColumnName(int i) const { return ""; }
+
+const zetasql::Value CountedRowCursor::ColumnValue(int i) const {
+  return zetasql::Value();
+}
+
+const zetasql::Type* CountedRowCursor::ColumnType(int i) const {
+  return nullptr;
+}
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
@@ -55,6 +55,27 @@ class StorageIteratorRowCursor : public RowCursor {
   const std::vector<const Column*> columns_;
 };
 
+// CountedRowCursor is an implementation of RowCursor that returns the given
+// number of rows without any columns, e.g. for rows counted by storage.
+//
+// This class is not thread-safe.
+class CountedRowCursor : public RowCursor {
+ public:
+  explicit CountedRowCursor(int64_t num_rows) : num_rows_(num_rows) {}
+
+  // Implementation of the RowCursor interface
+  bool Next() override;
+  absl::Status Status() const override;
+  int NumColumns() const override;
+  const std::string ColumnName(int i) const override;
+  const zetasql::Value ColumnValue(int i) const override;
+  const zetasql::Type* ColumnType(int i) const override;
+
+ private:
+  // Number of rows not yet returned by Next().
+  int64_t num_rows_;
+};
+
 }  // namespace backend
 }  // namespace emulator
 }  // namespace spanner
@@ -0,0 +1,327 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/transaction/spill_file.h"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include "zetasql/public/value.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "common/errors.h"
+#include "absl/status/status.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+namespace {
+
+// Number of bytes of the length prefix of each encoded mutation.
+constexpr int64_t kLengthSize = 4;
+
+std::string TemporaryDirectory() {
+  const char* directory = getenv("TMPDIR");
+  return directory != nullptr && directory[0] != '\0' ? directory : "/tmp";
+}
+
+SpilledRowOp::Type ToProtoType(RowOpType type) {
+  switch (type) {
+    case RowOpType::kInsert:
+      return SpilledRowOp::INSERT;
+    case RowOpType::kUpdate:
+      return SpilledRowOp::UPDATE;
+    case RowOpType::kDelete:
+      return SpilledRowOp::DELETE;
+  }
+}
+
+RowOpType FromProtoType(SpilledRowOp::Type type) {
+  switch (type) {
+    case SpilledRowOp::INSERT:
+      return RowOpType::kInsert;
+    case SpilledRowOp::UPDATE:
+      return RowOpType::kUpdate;
+    case SpilledRowOp::DELETE:
+      return RowOpType::kDelete;
+  }
+}
+
+}  // namespace
+
+zetasql_base::StatusOr<std::unique_ptr<SpillFile>> SpillFile::Create(
+    const std::string& directory) {
+  std::string path = absl::StrCat(
+      directory.empty() ? TemporaryDirectory() : directory,
+      "/spanner_emulator_transaction_XXXXXX");
+  const int fd = mkstemp(path.data());
+  if (fd < 0) {
+    return error::Internal(absl::StrCat("Failed to create spill file ", path,
+                                        ": ", strerror(errno)));
+  }
+  close(fd);
+  std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary |
+                              std::ios::trunc);
+  if (!file) {
+    std::remove(path.c_str());
+    return error::Internal(absl::StrCat("Failed to open spill file ", path));
+  }
+  return absl::WrapUnique(new SpillFile(std::move(path), std::move(file)));
+}
+
+SpillFile::SpillFile(std::string path, std::fstream file)
+    : path_(std::move(path)), file_(std::move(file)) {}
+
+SpillFile::~SpillFile() {
+  file_.close();
+  std::remove(path_.c_str());
+}
+
+absl::Status SpillFile::AddRun(const RowOps& ops) {
+  // The run is only recorded once fully written, so that a failed run is
+  // overwritten by the next one.
+  file_.clear();
+  int64_t offset = size_bytes_;
+  Run run;
+  for (const auto& [table, table_ops] : ops) {
+    if (table_ops.empty()) {
+      continue;
+    }
+    absl::flat_hash_map<const Column*, int> column_indexes;
+    for (int i = 0; i < table->columns().size(); ++i) {
+      column_indexes[table->columns()[i]] = i;
+    }
+    TableRun& table_run = run[table];
+    int64_t num_ops = 0;
+    for (const auto& [key, op] : table_ops) {
+      if (num_ops++ % kIndexInterval == 0) {
+        table_run.index.emplace_back(key, offset);
+      }
+      ZETASQL_RETURN_IF_ERROR(WriteOp(table, key, op, column_indexes, &offset));
+    }
+    table_run.end_offset = offset;
+  }
+  if (!file_.flush()) {
+    return error::Internal(absl::StrCat("Failed to write spill file ", path_));
+  }
+  size_bytes_ = offset;
+  runs_.push_back(std::move(run));
+  return absl::OkStatus();
+}
+
+absl::Status SpillFile::WriteOp(
+    const Table* table, const Key& key, const RowOp& op,
+    const absl::flat_hash_map<const Column*, int>& column_indexes,
+    int64_t* offset) {
+  SpilledRowOp proto;
+  proto.set_type(ToProtoType(op.first));
+  for (int i = 0; i < key.NumColumns(); ++i) {
+    ZETASQL_RETURN_IF_ERROR(key.ColumnValue(i).Serialize(proto.add_key()));
+    proto.add_key_descending(key.IsColumnDescending(i));
+  }
+  for (const auto& [column, value] : op.second) {
+    auto index_itr = column_indexes.find(column);
+    if (index_itr == column_indexes.end()) {
+      return error::Internal(absl::StrCat("Cannot spill mutation of column ",
+                                          column->Name(), " of table ",
+                                          table->Name()));
+    }
+    proto.add_column_index(index_itr->second);
+    ZETASQL_RETURN_IF_ERROR(value.Serialize(proto.add_value()));
+  }
+
+  std::string bytes;
+  if (!proto.SerializeToString(&bytes)) {
+    return error::Internal("Failed to encode spilled mutation");
+  }
+  const uint32_t length = bytes.size();
+  char length_bytes[kLengthSize];
+  for (int i = 0; i < kLengthSize; ++i) {
+    length_bytes[i] = static_cast<char>((length >> (8 * i)) & 0xff);
+  }
+  file_.seekp(*offset);
+  file_.write(length_bytes, kLengthSize);
+  file_.write(bytes.data(), bytes.size());
+  if (!file_) {
+    return error::Internal(absl::StrCat("Failed to write spill file ", path_));
+  }
+  *offset += kLengthSize + bytes.size();
+  return absl::OkStatus();
+}
+
+absl::Status SpillFile::ReadOp(const Table* table, int64_t* offset, Key* key,
+                               RowOp* op) const {
+  file_.clear();
+  file_.seekg(*offset);
+  char length_bytes[kLengthSize];
+  file_.read(length_bytes, kLengthSize);
+  uint32_t length = 0;
+  for (int i = 0; i < kLengthSize; ++i) {
+    length |= static_cast<uint32_t>(static_cast<unsigned char>(length_bytes[i]))
+              << (8 * i);
+  }
+  std::string bytes(length, '\0');
+  file_.read(&bytes[0], length);
+  SpilledRowOp proto;
+  if (!file_ || !proto.ParseFromString(bytes)) {
+    return error::Internal(absl::StrCat("Failed to read spill file ", path_));
+  }
+  *offset += kLengthSize + length;
+
+  const auto primary_key = table->primary_key();
+  if (static_cast<size_t>(proto.key_size()) > primary_key.size() ||
+      proto.key_descending_size() != proto.key_size() ||
+      proto.column_index_size() != proto.value_size()) {
+    return error::Internal(absl::StrCat("Corrupt spill file ", path_));
+  }
+  *key = Key();
+  for (int i = 0; i < proto.key_size(); ++i) {
+    ZETASQL_ASSIGN_OR_RETURN(
+        zetasql::Value value,
+        zetasql::Value::Deserialize(proto.key(i),
+                                      primary_key[i]->column()->GetType()));
+    key->AddColumn(std::move(value), proto.key_descending(i));
+  }
+  op->first = FromProtoType(proto.type());
+  op->second.clear();
+  for (int i = 0; i < proto.column_index_size(); ++i) {
+    if (proto.column_index(i) < 0 ||
+        static_cast<size_t>(proto.column_index(i)) >=
+            table->columns().size()) {
+      return error::Internal(absl::StrCat("Corrupt spill file ", path_));
+    }
+    const Column* column = table->columns()[proto.column_index(i)];
+    ZETASQL_ASSIGN_OR_RETURN(
+        zetasql::Value value,
+        zetasql::Value::Deserialize(proto.value(i), column->GetType()));
+    op->second.emplace(column, std::move(value));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SpillFile::ForEachOp(
+    const Table* table, const KeyRange& key_range,
+    const std::function<absl::Status(const Key&, const RowOp&)>& fn) const {
+  const KeyRange range = key_range.ToClosedOpen();
+
+  // Reads the mutations of the table in a run from 'offset' to 'end_offset',
+  // positioned on the current one while 'valid'. Cursors keep their own
+  // offsets, so that 'fn' may itself read the file.
+  struct Cursor {
+    int64_t offset = 0;
+    int64_t end_offset = 0;
+    bool valid = false;
+    Key key;
+    RowOp op;
+  };
+  // Moves the cursor to the next mutation in the key range, if any.
+  auto advance = [&](Cursor* cursor) -> absl::Status {
+    cursor->valid = false;
+    while (cursor->offset < cursor->end_offset) {
+      ZETASQL_RETURN_IF_ERROR(
+          ReadOp(table, &cursor->offset, &cursor->key, &cursor->op));
+      if (cursor->key >= range.limit_key()) {
+        break;
+      }
+      if (cursor->key >= range.start_key()) {
+        cursor->valid = true;
+        break;
+      }
+    }
+    return absl::OkStatus();
+  };
+
+  // Position a cursor in each run at its last indexed mutation preceding the
+  // key range, in run order.
+  std::vector<Cursor> cursors;
+  for (const Run& run : runs_) {
+    auto table_itr = run.find(table);
+    if (table_itr == run.end()) {
+      continue;
+    }
+    const TableRun& table_run = table_itr->second;
+    auto index_itr = std::upper_bound(
+        table_run.index.begin(), table_run.index.end(), range.start_key(),
+        [](const Key& key, const std::pair<Key, int64_t>& entry) {
+          return key < entry.first;
+        });
+    if (index_itr != table_run.index.begin()) {
+      --index_itr;
+    }
+    cursors.emplace_back();
+    cursors.back().offset = index_itr->second;
+    cursors.back().end_offset = table_run.end_offset;
+    ZETASQL_RETURN_IF_ERROR(advance(&cursors.back()));
+  }
+
+  // Merge the runs, taking the mutation of the latest run for each key.
+  while (true) {
+    const Cursor* next = nullptr;
+    for (const Cursor& cursor : cursors) {
+      if (cursor.valid && (next == nullptr || cursor.key <= next->key)) {
+        next = &cursor;
+      }
+    }
+    if (next == nullptr) {
+      return absl::OkStatus();
+    }
+    const Key key = next->key;
+    ZETASQL_RETURN_IF_ERROR(fn(key, next->op));
+    for (Cursor& cursor : cursors) {
+      if (cursor.valid && cursor.key == key) {
+        ZETASQL_RETURN_IF_ERROR(advance(&cursor));
+      }
+    }
+  }
+}
+
+absl::Status SpillFile::Verify() const {
+  Key key;
+  RowOp op;
+  for (const Run& run : runs_) {
+    for (const auto& [table, table_run] : run) {
+      int64_t offset = table_run.index.front().second;
+      while (offset < table_run.end_offset) {
+        ZETASQL_RETURN_IF_ERROR(ReadOp(table, &offset, &key, &op));
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+std::vector<const Table*> SpillFile::tables() const {
+  absl::flat_hash_set<const Table*> tables;
+  for (const Run& run : runs_) {
+    for (const auto& [table, table_run] : run) {
+      tables.insert(table);
+    }
+  }
+  return std::vector<const Table*>(tables.begin(), tables.end());
+}
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
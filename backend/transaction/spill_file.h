@@ -0,0 +1,141 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_SPILL_FILE_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_SPILL_FILE_H_
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "zetasql/base/statusor.h"
+#include "backend/common/rows.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/schema/catalog/column.h"
+#include "backend/schema/catalog/table.h"
+#include "backend/transaction/spilled_row_op.pb.h"
+#include "absl/status/status.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+
+// Types of buffered row mutations.
+enum class RowOpType {
+  kInsert,
+  kUpdate,
+  kDelete,
+};
+
+// A buffered row mutation: its type and the values of the cells it writes.
+using RowOp = std::pair<RowOpType, Row>;
+
+// Buffered row mutations by table and key.
+using RowOps = absl::flat_hash_map<const Table*, std::map<Key, RowOp>>;
+
+// SpillFile holds the row mutations which a read-write transaction buffered
+// beyond its in-memory limit, in a file on local disk.
+//
+// Each spill appends a run to the file: the mutations of each table in key
+// order, encoded as length-prefixed SpilledRowOp protos. Only a sparse index
+// of every kIndexInterval-th key of each table of a run is kept in memory, so
+// reading a key range reads the few runs' blocks covering it, and merges them
+// with the mutations of later runs superseding those of earlier ones.
+//
+// The file is removed when the SpillFile is destroyed. Column pointers are
+// encoded as indexes in the columns of their tables, so a SpillFile must not
+// outlive the schema of the mutations it holds.
+//
+// This class is not thread-safe.
+class SpillFile {
+ public:
+  // Number of mutations of a table in a run per sparse index entry.
+  static constexpr int64_t kIndexInterval = 64;
+
+  // Creates an empty spill file in the given directory, or in the system's
+  // temporary directory if `directory` is empty.
+  static zetasql_base::StatusOr<std::unique_ptr<SpillFile>> Create(
+      const std::string& directory);
+
+  ~SpillFile();
+
+  // Appends a run holding `ops`. Mutations of a row in later runs supersede
+  // those in earlier runs.
+  absl::Status AddRun(const RowOps& ops);
+
+  // Calls `fn` in key order with the latest spilled mutation of each row of
+  // `table` in `key_range`, stopping at the first error.
+  absl::Status ForEachOp(
+      const Table* table, const KeyRange& key_range,
+      const std::function<absl::Status(const Key&, const RowOp&)>& fn) const;
+
+  // Reads back every mutation in the file, returning an error if any of them
+  // cannot be read or decoded.
+  absl::Status Verify() const;
+
+  // Returns the tables which have spilled mutations.
+  std::vector<const Table*> tables() const;
+
+  // Returns the number of runs in the file.
+  int64_t num_runs() const { return runs_.size(); }
+
+  // Returns the size of the file in bytes.
+  int64_t size_bytes() const { return size_bytes_; }
+
+ private:
+  // The mutations of a table in a run, which span [index[0].second,
+  // end_offset) in the file.
+  struct TableRun {
+    // Key and file offset of every kIndexInterval-th mutation.
+    std::vector<std::pair<Key, int64_t>> index;
+    int64_t end_offset = 0;
+  };
+  using Run = absl::flat_hash_map<const Table*, TableRun>;
+
+  SpillFile(std::string path, std::fstream file);
+
+  // Writes the mutation of `key` at `*offset` in the file, and advances
+  // `*offset` past it. Columns are encoded by their `column_indexes`.
+  absl::Status WriteOp(
+      const Table* table, const Key& key, const RowOp& op,
+      const absl::flat_hash_map<const Column*, int>& column_indexes,
+      int64_t* offset);
+
+  // Reads the mutation at `*offset` in the file, and advances `*offset` past
+  // it.
+  absl::Status ReadOp(const Table* table, int64_t* offset, Key* key,
+                      RowOp* op) const;
+
+  std::string path_;
+  mutable std::fstream file_;
+  int64_t size_bytes_ = 0;
+  std::vector<Run> runs_;
+};
+
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_SPILL_FILE_H_
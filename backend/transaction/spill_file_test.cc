@@ -0,0 +1,144 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "backend/transaction/spill_file.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "tests/common/proto_matchers.h"
+#include "zetasql/public/value.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "backend/common/rows.h"
+#include "backend/datamodel/key.h"
+#include "backend/datamodel/key_range.h"
+#include "backend/schema/catalog/schema.h"
+#include "tests/common/schema_constructor.h"
+
+using zetasql::values::Int64;
+using zetasql::values::String;
+using testing::ElementsAre;
+using testing::Pair;
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace backend {
+namespace {
+
+class SpillFileTest : public testing::Test {
+ public:
+  SpillFileTest()
+      : type_factory_(absl::make_unique<zetasql::TypeFactory>()),
+        schema_(test::CreateSchemaFromDDL(
+                    {
+                        R"(
+                          CREATE TABLE TestTable (
+                            Int64Col    INT64 NOT NULL,
+                            StringCol   STRING(MAX),
+                          ) PRIMARY KEY (Int64Col)
+                        )"},
+                    type_factory_.get())
+                    .ValueOrDie()),
+        table_(schema_->FindTable("TestTable")),
+        int64_col_(table_->FindColumn("Int64Col")),
+        string_col_(table_->FindColumn("StringCol")) {}
+
+ protected:
+  void SetUp() override {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(spill_file_, SpillFile::Create(""));
+  }
+
+  RowOp Insert(int64_t key, const std::string& value) {
+    return {RowOpType::kInsert,
+            Row{{int64_col_, Int64(key)}, {string_col_, String(value)}}};
+  }
+
+  // Returns the keys and string values of the spilled ops in `key_range`.
+  std::vector<std::pair<Key, zetasql::Value>> Read(const KeyRange& key_range) {
+    std::vector<std::pair<Key, zetasql::Value>> ops;
+    ZETASQL_EXPECT_OK(spill_file_->ForEachOp(
+        table_, key_range, [&](const Key& key, const RowOp& op) {
+          ops.emplace_back(key, op.second.at(string_col_));
+          return absl::OkStatus();
+        }));
+    return ops;
+  }
+
+  std::unique_ptr<zetasql::TypeFactory> type_factory_;
+  std::unique_ptr<const Schema> schema_;
+  const Table* table_;
+  const Column* int64_col_;
+  const Column* string_col_;
+  std::unique_ptr<SpillFile> spill_file_;
+};
+
+TEST_F(SpillFileTest, LaterRunsSupersedeEarlierOnes) {
+  RowOps first_run;
+  first_run[table_][Key({Int64(1)})] = Insert(1, "a");
+  first_run[table_][Key({Int64(2)})] = Insert(2, "b");
+  ZETASQL_EXPECT_OK(spill_file_->AddRun(first_run));
+
+  RowOps second_run;
+  second_run[table_][Key({Int64(2)})] = Insert(2, "c");
+  second_run[table_][Key({Int64(3)})] = Insert(3, "d");
+  ZETASQL_EXPECT_OK(spill_file_->AddRun(second_run));
+
+  EXPECT_EQ(spill_file_->num_runs(), 2);
+  EXPECT_THAT(spill_file_->tables(), ElementsAre(table_));
+  EXPECT_THAT(Read(KeyRange::All()),
+              ElementsAre(Pair(Key({Int64(1)}), String("a")),
+                          Pair(Key({Int64(2)}), String("c")),
+                          Pair(Key({Int64(3)}), String("d"))));
+  EXPECT_THAT(Read(KeyRange::Point(Key({Int64(2)}))),
+              ElementsAre(Pair(Key({Int64(2)}), String("c"))));
+  ZETASQL_EXPECT_OK(spill_file_->Verify());
+}
+
+TEST_F(SpillFileTest, ReadsKeyRangesUsingSparseIndex) {
+  // Spill enough mutations for the run to have several index entries.
+  const int64_t num_ops = 3 * SpillFile::kIndexInterval + 5;
+  RowOps run;
+  for (int64_t i = 0; i < num_ops; ++i) {
+    run[table_][Key({Int64(i)})] = Insert(i, absl::StrCat("value-", i));
+  }
+  ZETASQL_EXPECT_OK(spill_file_->AddRun(run));
+
+  EXPECT_THAT(Read(KeyRange::All()), testing::SizeIs(num_ops));
+  const int64_t start = SpillFile::kIndexInterval + 3;
+  EXPECT_THAT(
+      Read(KeyRange::ClosedOpen(Key({Int64(start)}), Key({Int64(start + 2)}))),
+      ElementsAre(
+          Pair(Key({Int64(start)}), String(absl::StrCat("value-", start))),
+          Pair(Key({Int64(start + 1)}),
+               String(absl::StrCat("value-", start + 1)))));
+  EXPECT_THAT(Read(KeyRange::ClosedOpen(Key({Int64(num_ops)}),
+                                        Key({Int64(num_ops + 10)}))),
+              testing::IsEmpty());
+}
+
+}  // namespace
+}  // namespace backend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
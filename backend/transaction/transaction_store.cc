@@ -16,13 +16,17 @@
 
 #include "backend/transaction/transaction_store.h"
 
+#include <functional>
+#include <map>
 #include <vector>
 
 #include "zetasql/public/value.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "zetasql/base/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
+#include "backend/common/memory_tracker.h"
 #include "backend/common/rows.h"
 #include "backend/datamodel/key_range.h"
 #include "backend/locking/request.h"
@@ -30,8 +34,10 @@
 #include "backend/schema/catalog/table.h"
 #include "backend/storage/iterator.h"
 #include "backend/transaction/commit_timestamp.h"
+#include "common/config.h"
 #include "common/errors.h"
 #include "absl/status/status.h"
+#include "zetasql/base/status_macros.h"
 
 namespace google {
 namespace spanner {
@@ -40,11 +46,6 @@ namespace backend {
 
 namespace {
 
-bool SortByKey(const FixedRowStorageIterator::Row& a,
-               const FixedRowStorageIterator::Row& b) {
-  return a.first < b.first;
-}
-
 void ResetInvalidValuesToNull(absl::Span<const Column* const> columns,
                               ValueList* values) {
   if (!values) {
@@ -60,8 +61,87 @@ void ResetInvalidValuesToNull(absl::Span<const Column* const> columns,
   }
 }
 
+int64_t RowSizeInBytes(const Key& key, const Row& row) {
+  int64_t size = key.LogicalSizeInBytes();
+  for (const auto& [column, value] : row) {
+    size += EstimateSizeInBytes(value);
+  }
+  return size;
+}
+
+WriteOp ToWriteOp(const Table* table, const Key& key, const RowOp& row_op) {
+  std::vector<const Column*> columns;
+  ValueList values;
+  for (const auto& cell : row_op.second) {
+    columns.emplace_back(cell.first);
+    values.emplace_back(cell.second);
+  }
+  switch (row_op.first) {
+    case RowOpType::kInsert:
+      return InsertOp{table, key, columns, values};
+    case RowOpType::kUpdate:
+      return UpdateOp{table, key, columns, values};
+    case RowOpType::kDelete:
+      return DeleteOp{table, key};
+  }
+}
+
 }  // namespace
 
+TransactionStore::TransactionStore(Storage* base_storage,
+                                   LockHandle* lock_handle,
+                                   MemoryTracker* database_memory_tracker,
+                                   int64_t spill_threshold_bytes)
+    : base_storage_(base_storage),
+      lock_handle_(lock_handle),
+      memory_tracker_("transaction", config::max_transaction_memory_bytes(),
+                      database_memory_tracker),
+      spill_threshold_bytes_(spill_threshold_bytes) {}
+
+void TransactionStore::Clear() {
+  buffered_ops_.clear();
+  spill_file_.reset();
+  memory_tracker_.Release(memory_tracker_.bytes_used());
+}
+
+absl::Status TransactionStore::SpillBufferedOps() {
+  if (spill_file_ == nullptr) {
+    ZETASQL_ASSIGN_OR_RETURN(spill_file_, SpillFile::Create(
+                                      config::transaction_spill_directory()));
+  }
+  ZETASQL_RETURN_IF_ERROR(spill_file_->AddRun(buffered_ops_));
+  buffered_ops_.clear();
+  memory_tracker_.Release(memory_tracker_.bytes_used());
+  return absl::OkStatus();
+}
+
+absl::Status TransactionStore::BufferRowOp(const Table* table, const Key& key,
+                                           RowOp row_op) {
+  int64_t new_size = RowSizeInBytes(key, row_op.second);
+  int64_t old_size = 0;
+  auto table_itr = buffered_ops_.find(table);
+  if (table_itr != buffered_ops_.end()) {
+    auto itr = table_itr->second.find(key);
+    if (itr != table_itr->second.end()) {
+      old_size = RowSizeInBytes(key, itr->second.second);
+    }
+  }
+  if (spill_threshold_bytes_ > 0 && memory_tracker_.bytes_used() > 0 &&
+      memory_tracker_.bytes_used() - old_size + new_size >
+          spill_threshold_bytes_) {
+    ZETASQL_RETURN_IF_ERROR(SpillBufferedOps());
+    old_size = 0;
+  }
+  std::map<Key, RowOp>& table_ops = buffered_ops_[table];
+  if (new_size > old_size) {
+    ZETASQL_RETURN_IF_ERROR(memory_tracker_.TryAllocate(new_size - old_size));
+  } else {
+    memory_tracker_.Release(old_size - new_size);
+  }
+  table_ops[key] = std::move(row_op);
+  return absl::OkStatus();
+}
+
 absl::Status TransactionStore::AcquireReadLock(
     const Table* table, const KeyRange& key_range,
     absl::Span<const Column* const> columns) const {
@@ -85,7 +165,7 @@ absl::Status TransactionStore::BufferInsert(
   ZETASQL_RETURN_IF_ERROR(AcquireWriteLock(table, KeyRange::Point(key), columns));
 
   RowOp row_op;
-  bool row_exists = RowExistsInBuffer(table, key, &row_op);
+  ZETASQL_ASSIGN_OR_RETURN(bool row_exists, RowExistsInBuffer(table, key, &row_op));
   Row row_values;
   if (row_exists) {
     // There is an existing delete on this row. Normalize this insert
@@ -97,7 +177,8 @@ absl::Status TransactionStore::BufferInsert(
   for (int i = 0; i < columns.size(); ++i) {
     row_values[columns[i]] = values[i];
   }
-  buffered_ops_[table][key] = std::make_pair(OpType::kInsert, row_values);
+  ZETASQL_RETURN_IF_ERROR(BufferRowOp(table, key,
+                              std::make_pair(OpType::kInsert, row_values)));
 
   TrackColumnsForCommitTimestamp(columns, values);
   TrackTableForCommitTimestamp(table, key);
@@ -111,7 +192,7 @@ absl::Status TransactionStore::BufferUpdate(
   ZETASQL_RETURN_IF_ERROR(AcquireWriteLock(table, KeyRange::Point(key), columns));
 
   RowOp row_op;
-  bool row_exists = RowExistsInBuffer(table, key, &row_op);
+  ZETASQL_ASSIGN_OR_RETURN(bool row_exists, RowExistsInBuffer(table, key, &row_op));
 
   // Buffer the update mutation with the cell values to be updated.
   OpType op_type;
@@ -130,7 +211,8 @@ absl::Status TransactionStore::BufferUpdate(
   for (int i = 0; i < columns.size(); ++i) {
     row_values[columns[i]] = values[i];
   }
-  buffered_ops_[table][key] = std::make_pair(op_type, row_values);
+  ZETASQL_RETURN_IF_ERROR(
+      BufferRowOp(table, key, std::make_pair(op_type, row_values)));
 
   TrackColumnsForCommitTimestamp(columns, values);
   TrackTableForCommitTimestamp(table, key);
@@ -147,7 +229,8 @@ absl::Status TransactionStore::BufferDelete(const Table* table,
   for (auto column : table->columns()) {
     row_values[column] = zetasql::values::Null(column->GetType());
   }
-  buffered_ops_[table][key] = std::make_pair(OpType::kDelete, row_values);
+  ZETASQL_RETURN_IF_ERROR(BufferRowOp(table, key,
+                              std::make_pair(OpType::kDelete, row_values)));
 
   TrackTableForCommitTimestamp(table, key);
   return absl::OkStatus();
@@ -183,77 +266,82 @@ absl::Status TransactionStore::Read(
   // Acquire locks to prevent another transaction to modify this entity.
   ZETASQL_RETURN_IF_ERROR(AcquireReadLock(table, key_range, columns));
 
-  // Read rows buffered within transaction store.
-  // Table lookup.
-  std::vector<FixedRowStorageIterator::Row> rows;
-  auto table_itr = buffered_ops_.find(table);
-  if (table_itr != buffered_ops_.end()) {
-    auto table = table_itr->second;
-    // Key range lookup.
-    auto begin_itr = table.lower_bound(key_range.start_key());
-    auto end_itr = table.lower_bound(key_range.limit_key());
-
-    for (auto itr = begin_itr; itr != end_itr; ++itr) {
-      if (itr->second.first == OpType::kInsert) {
-        // Add inserts into the StorageIterator.
-        Row row_values = itr->second.second;
-        ValueList values;
-        values.reserve(columns.size());
-        for (const Column* column : columns) {
-          if (row_values.find(column) == row_values.end()) {
-            values.emplace_back(zetasql::values::Null(column->GetType()));
-          } else {
-            values.emplace_back(row_values[column]);
-          }
-        }
-        rows.emplace_back(std::make_pair(itr->first, values));
-      }
-    }
-  }
-
-  // Read from the base storage and apply the changes buffered in transaction
-  // store.
+  // Read from the base storage and merge its rows, in key order, with the
+  // mutations buffered for the key range, which are streamed rather than
+  // collected, so that spilled mutations are not all read back into memory.
   std::unique_ptr<StorageIterator> base_itr;
   ZETASQL_RETURN_IF_ERROR(base_storage_->Read(absl::InfiniteFuture(), table->id(),
                                       key_range, GetColumnIDs(columns),
                                       &base_itr));
-  while (base_itr->Next()) {
+  std::vector<FixedRowStorageIterator::Row> rows;
+  bool base_valid = base_itr->Next();
+  // Copies the base storage column values of the current base row, which has
+  // no buffered mutation.
+  auto add_base_row = [&]() {
     ValueList values;
     values.reserve(columns.size());
-
-    RowOp row_op;
-    // Merge column values from transaction store & base storage.
-    if (RowExistsInBuffer(table, base_itr->Key(), &row_op)) {
-      if (row_op.first == OpType::kDelete || row_op.first == OpType::kInsert) {
-        // Omit the deletes from the output. The buffered inserts have already
-        // been added to the output.
-        continue;
+    for (int i = 0; i < columns.size(); i++) {
+      if (base_itr->ColumnValue(i).is_valid()) {
+        values.emplace_back(base_itr->ColumnValue(i));
+      } else {
+        values.emplace_back(zetasql::values::Null(columns[i]->GetType()));
       }
-      if (row_op.first == OpType::kUpdate) {
-        // Update the column values to reflect the changes in transaction store.
-        for (int i = 0; i < columns.size(); i++) {
-          if (row_op.second.find(columns[i]) != row_op.second.end()) {
-            values.emplace_back(row_op.second[columns[i]]);
-          } else if (base_itr->ColumnValue(i).is_valid()) {
-            values.emplace_back(base_itr->ColumnValue(i));
+    }
+    rows.emplace_back(base_itr->Key(), std::move(values));
+  };
+  auto apply_buffered_op = [&](const Key& key,
+                               const RowOp& row_op) -> absl::Status {
+    for (; base_valid && base_itr->Key() < key; base_valid = base_itr->Next()) {
+      add_base_row();
+    }
+    const bool in_base = base_valid && base_itr->Key() == key;
+    ValueList values;
+    values.reserve(columns.size());
+    switch (row_op.first) {
+      case OpType::kInsert:
+        // Inserts replace any base storage row.
+        for (const Column* column : columns) {
+          auto value_itr = row_op.second.find(column);
+          if (value_itr == row_op.second.end()) {
+            values.emplace_back(zetasql::values::Null(column->GetType()));
           } else {
-            values.emplace_back(zetasql::values::Null(columns[i]->GetType()));
+            values.emplace_back(value_itr->second);
           }
         }
-      }
-    } else {
-      // Copy the base storage column values since this row does not exists in
-      // transaction store.
-      for (int i = 0; i < columns.size(); i++) {
-        if (base_itr->ColumnValue(i).is_valid()) {
-          values.emplace_back(base_itr->ColumnValue(i));
-        } else {
-          values.emplace_back(zetasql::values::Null(columns[i]->GetType()));
+        rows.emplace_back(key, std::move(values));
+        break;
+      case OpType::kUpdate:
+        // Updates are applied over the base storage row.
+        if (in_base) {
+          for (int i = 0; i < columns.size(); i++) {
+            auto value_itr = row_op.second.find(columns[i]);
+            if (value_itr != row_op.second.end()) {
+              values.emplace_back(value_itr->second);
+            } else if (base_itr->ColumnValue(i).is_valid()) {
+              values.emplace_back(base_itr->ColumnValue(i));
+            } else {
+              values.emplace_back(
+                  zetasql::values::Null(columns[i]->GetType()));
+            }
+          }
+          rows.emplace_back(key, std::move(values));
         }
-      }
+        break;
+      case OpType::kDelete:
+        // Deletes omit the base storage row.
+        break;
+    }
+    if (in_base) {
+      base_valid = base_itr->Next();
     }
-    rows.emplace_back(std::make_pair(base_itr->Key(), values));
+    return absl::OkStatus();
+  };
+  ZETASQL_RETURN_IF_ERROR(
+      ForEachBufferedRowOp(table, key_range, apply_buffered_op));
+  for (; base_valid; base_valid = base_itr->Next()) {
+    add_base_row();
   }
+  ZETASQL_RETURN_IF_ERROR(base_itr->Status());
 
   // Pending commit timestamp values in buffer cannot be returned to
   // clients.
@@ -272,28 +360,32 @@ absl::Status TransactionStore::Read(
     }
   }
 
-  // Sort the keys to provide iterating in order.
-  // Note: this can be optimized by iterating the base_store_iterator and
-  // transaction_store_ietrator in parallel and comparing the keys.
-  sort(rows.begin(), rows.end(), SortByKey);
   *storage_itr = absl::make_unique<FixedRowStorageIterator>(std::move(rows));
   return absl::OkStatus();
 }
 
-bool TransactionStore::RowExistsInBuffer(const Table* table, const Key& key,
-                                         RowOp* row_op) const {
+zetasql_base::StatusOr<bool> TransactionStore::RowExistsInBuffer(
+    const Table* table, const Key& key, RowOp* row_op) const {
+  // Mutations held in memory supersede the spilled ones.
   const auto table_itr = buffered_ops_.find(table);
-  if (table_itr == buffered_ops_.end()) {
-    // Table does not exist. This can happen if the table is empty.
-    return false;
+  if (table_itr != buffered_ops_.end()) {
+    const auto row_op_itr = table_itr->second.find(key);
+    if (row_op_itr != table_itr->second.end()) {
+      *row_op = row_op_itr->second;
+      return true;
+    }
   }
-  const auto row_op_itr = table_itr->second.find(key);
-  if (row_op_itr == table_itr->second.end()) {
-    // Key does not exist.
+  if (spill_file_ == nullptr) {
     return false;
   }
-  *row_op = row_op_itr->second;
-  return true;
+  bool found = false;
+  ZETASQL_RETURN_IF_ERROR(spill_file_->ForEachOp(
+      table, KeyRange::Point(key), [&](const Key&, const RowOp& spilled_op) {
+        *row_op = spilled_op;
+        found = true;
+        return absl::OkStatus();
+      }));
+  return found;
 }
 
 void TransactionStore::TrackColumnsForCommitTimestamp(
@@ -328,7 +420,8 @@ zetasql_base::StatusOr<ValueList> TransactionStore::Lookup(
 
   // Check if row exists within the buffer.
   RowOp row_op;
-  if (RowExistsInBuffer(table, key, &row_op)) {
+  ZETASQL_ASSIGN_OR_RETURN(bool row_exists, RowExistsInBuffer(table, key, &row_op));
+  if (row_exists) {
     switch (row_op.first) {
       case OpType::kInsert: {
         // Fetch the latest value from the cell.
@@ -372,36 +465,65 @@ zetasql_base::StatusOr<ValueList> TransactionStore::Lookup(
   return values;
 }
 
-std::vector<WriteOp> TransactionStore::GetBufferedOps() const {
-  std::vector<WriteOp> buffered_ops;
-  for (const auto& entry : buffered_ops_) {
-    const Table* table = entry.first;
-    for (const auto& row : entry.second) {
-      const Key& key = row.first;
-      const RowOp& row_op = row.second;
-      std::vector<const Column*> columns;
-      ValueList values;
-      for (const auto& cell : row_op.second) {
-        columns.emplace_back(cell.first);
-        values.emplace_back(cell.second);
-      }
-      switch (row_op.first) {
-        case OpType::kInsert: {
-          buffered_ops.emplace_back(InsertOp{table, key, columns, values});
-          break;
-        }
-        case OpType::kUpdate: {
-          buffered_ops.emplace_back(UpdateOp{table, key, columns, values});
-          break;
-        }
-        case OpType::kDelete: {
-          buffered_ops.emplace_back(DeleteOp{table, key});
-          break;
+absl::Status TransactionStore::ForEachBufferedRowOp(
+    const Table* table, const KeyRange& key_range,
+    const std::function<absl::Status(const Key&, const RowOp&)>& fn) const {
+  const std::map<Key, RowOp> no_ops;
+  auto table_itr = buffered_ops_.find(table);
+  const std::map<Key, RowOp>& table_ops =
+      table_itr == buffered_ops_.end() ? no_ops : table_itr->second;
+  const KeyRange range = key_range.ToClosedOpen();
+  auto itr = table_ops.lower_bound(range.start_key());
+  auto end_itr = table_ops.lower_bound(range.limit_key());
+
+  // Merge the spilled mutations with those in memory, which supersede them.
+  if (spill_file_ != nullptr) {
+    auto visit_spilled_op = [&](const Key& key,
+                                const RowOp& row_op) -> absl::Status {
+      for (; itr != end_itr && itr->first <= key; ++itr) {
+        ZETASQL_RETURN_IF_ERROR(fn(itr->first, itr->second));
+        if (itr->first == key) {
+          ++itr;
+          return absl::OkStatus();
         }
       }
+      return fn(key, row_op);
+    };
+    ZETASQL_RETURN_IF_ERROR(
+        spill_file_->ForEachOp(table, range, visit_spilled_op));
+  }
+  for (; itr != end_itr; ++itr) {
+    ZETASQL_RETURN_IF_ERROR(fn(itr->first, itr->second));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status TransactionStore::ForEachBufferedOp(
+    const std::function<absl::Status(const WriteOp&)>& fn) const {
+  absl::flat_hash_set<const Table*> tables;
+  for (const auto& [table, table_ops] : buffered_ops_) {
+    tables.insert(table);
+  }
+  if (spill_file_ != nullptr) {
+    for (const Table* table : spill_file_->tables()) {
+      tables.insert(table);
     }
   }
-  return buffered_ops;
+  for (const Table* table : tables) {
+    ZETASQL_RETURN_IF_ERROR(ForEachBufferedRowOp(
+        table, KeyRange::All(),
+        [&](const Key& key, const RowOp& row_op) -> absl::Status {
+          return fn(ToWriteOp(table, key, row_op));
+        }));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status TransactionStore::VerifySpilledOps() const {
+  if (spill_file_ == nullptr) {
+    return absl::OkStatus();
+  }
+  return spill_file_->Verify();
 }
 
 }  // namespace backend
@@ -17,13 +17,17 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_TRANSACTION_STORE_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_BACKEND_TRANSACTION_TRANSACTION_STORE_H_
 
+#include <functional>
+#include <map>
 #include <memory>
+#include <vector>
 
 #include "zetasql/public/value.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "backend/actions/ops.h"
 #include "backend/common/ids.h"
+#include "backend/common/memory_tracker.h"
 #include "backend/datamodel/key.h"
 #include "backend/datamodel/value.h"
 #include "backend/locking/handle.h"
@@ -32,7 +36,9 @@
 #include "backend/schema/catalog/table.h"
 #include "backend/storage/in_memory_iterator.h"
 #include "backend/storage/storage.h"
+#include "backend/transaction/spill_file.h"
 #include "absl/status/status.h"
+#include "zetasql/base/statusor.h"
 
 namespace google {
 namespace spanner {
@@ -59,11 +65,23 @@ namespace backend {
 // At commit time, the read-write transaction which owns this store flushes all
 // buffered mutations to the underlying database storage in an atomic fashion.
 //
+// The estimated size of the buffered mutations is accounted against the
+// per-transaction memory limit and, if a database MemoryTracker is provided,
+// against the database's memory limit. Buffering a mutation which would exceed
+// either limit fails with RESOURCE_EXHAUSTED.
+//
+// If a spill threshold is set, the buffered mutations are instead moved to a
+// SpillFile on local disk whenever buffering a mutation would take them past
+// the threshold, so that only up to the threshold is held in memory. Reads
+// and flushes merge the spilled mutations with those in memory, which
+// supersede them.
+//
 // This class is not thread safe.
 class TransactionStore {
  public:
-  explicit TransactionStore(Storage* base_storage, LockHandle* lock_handle)
-      : base_storage_(base_storage), lock_handle_(lock_handle) {}
+  TransactionStore(Storage* base_storage, LockHandle* lock_handle,
+                   MemoryTracker* database_memory_tracker = nullptr,
+                   int64_t spill_threshold_bytes = 0);
 
   // Buffers a write operation. Acquires write locks.
   absl::Status BufferWriteOp(const WriteOp& op);
@@ -85,21 +103,28 @@ class TransactionStore {
                     std::unique_ptr<StorageIterator>* storage_itr,
                     bool allow_pending_commit_timestamps_in_read = true) const;
 
-  // Returns the buffered mutations.
-  std::vector<WriteOp> GetBufferedOps() const;
+  // Calls `fn` with each buffered mutation, in key order within each table,
+  // stopping at the first error. Spilled mutations are read back one at a
+  // time rather than all at once.
+  absl::Status ForEachBufferedOp(
+      const std::function<absl::Status(const WriteOp&)>& fn) const;
+
+  // Reads back all the spilled mutations, returning an error if any of them
+  // cannot be read. Committing transactions check this before writing any
+  // mutation to the base storage.
+  absl::Status VerifySpilledOps() const;
 
   // Clears the buffered mutations.
-  void Clear() { buffered_ops_.clear(); }
+  void Clear();
 
- private:
-  // Types of mutations.
-  enum class OpType {
-    kInsert,
-    kUpdate,
-    kDelete,
-  };
+  // Returns the tracker accounting the bytes buffered by this store.
+  const MemoryTracker& memory_tracker() const { return memory_tracker_; }
+
+  // Returns the file holding the spilled mutations, nullptr if none were.
+  const SpillFile* spill_file() const { return spill_file_.get(); }
 
-  using RowOp = std::pair<OpType, Row>;
+ private:
+  using OpType = RowOpType;
 
   // Acquires read locks for the specified column ranges.
   absl::Status AcquireReadLock(const Table* table, const KeyRange& key_range,
@@ -122,8 +147,23 @@ class TransactionStore {
   // Buffers a delete mutation. Acquires write locks.
   absl::Status BufferDelete(const Table* table, const Key& key);
 
+  // Replaces the buffered mutation for 'key', accounting for the change in
+  // buffered bytes. Returns RESOURCE_EXHAUSTED if a memory limit is exceeded.
+  absl::Status BufferRowOp(const Table* table, const Key& key, RowOp row_op);
+
+  // Moves the mutations buffered in memory to the spill file.
+  absl::Status SpillBufferedOps();
+
+  // Calls `fn` in key order with the buffered mutation of each row of 'table'
+  // in 'key_range', merging the spilled mutations with those in memory, which
+  // supersede them. Stops at the first error.
+  absl::Status ForEachBufferedRowOp(
+      const Table* table, const KeyRange& key_range,
+      const std::function<absl::Status(const Key&, const RowOp&)>& fn) const;
+
   // Returns true if a mutation has been buffered for 'key' and fills 'row'.
-  bool RowExistsInBuffer(const Table* table, const Key& key, RowOp* row) const;
+  zetasql_base::StatusOr<bool> RowExistsInBuffer(const Table* table,
+                                         const Key& key, RowOp* row) const;
 
   // Mark a given column non-readable if one or more values being written to it
   // in the mutation contain pending commit timestamp.
@@ -140,8 +180,18 @@ class TransactionStore {
   // Handle for the lock manager.
   LockHandle* lock_handle_;
 
-  // Map that stores the buffered mutations.
-  absl::flat_hash_map<const Table*, std::map<Key, RowOp>> buffered_ops_;
+  // Tracks the bytes held by the buffered mutations.
+  MemoryTracker memory_tracker_;
+
+  // Number of bytes of buffered mutations past which they are spilled, or 0 if
+  // they are never spilled.
+  const int64_t spill_threshold_bytes_;
+
+  // Map that stores the buffered mutations held in memory.
+  RowOps buffered_ops_;
+
+  // File holding the mutations spilled out of memory, created on first spill.
+  std::unique_ptr<SpillFile> spill_file_;
 
   // Set of non-key columns which have mutation with pending commit timestamp
   // and are thus marked as non-readable in read-your-writes transactions.
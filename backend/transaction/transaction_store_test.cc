@@ -17,6 +17,9 @@
 #include "backend/transaction/transaction_store.h"
 
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -25,7 +28,9 @@
 #include "zetasql/base/statusor.h"
 #include "absl/time/time.h"
 #include "backend/actions/ops.h"
+#include "backend/common/memory_tracker.h"
 #include "backend/common/rows.h"
+#include "backend/common/variant.h"
 #include "backend/datamodel/key_range.h"
 #include "backend/datamodel/value.h"
 #include "backend/locking/manager.h"
@@ -38,6 +43,7 @@ using zetasql::values::Int64;
 using zetasql::values::Null;
 using zetasql::values::String;
 using testing::ElementsAre;
+using testing::Pair;
 using zetasql_base::testing::StatusIs;
 
 namespace google {
@@ -368,6 +374,114 @@ TEST_F(TransactionStoreTest, ReadsClosedOpenRange) {
               IsOkAndHoldsRows({}));
 }
 
+TEST_F(TransactionStoreTest, BufferedBytesCountTowardsDatabaseLimit) {
+  MemoryTracker database_memory("database", /*limit_bytes=*/32);
+  TransactionStore store(base_storage_.get(), lock_handle_.get(),
+                         &database_memory);
+
+  // Key (8 bytes) + Int64Col (8 bytes) + StringCol (1 byte).
+  ZETASQL_EXPECT_OK(store.BufferWriteOp(InsertOp{table_,
+                                         Key({Int64(1)}),
+                                         {int64_col_, string_col_},
+                                         {Int64(1), String("a")}}));
+  EXPECT_EQ(store.memory_tracker().bytes_used(), 17);
+  EXPECT_EQ(database_memory.bytes_used(), 17);
+
+  EXPECT_THAT(store.BufferWriteOp(InsertOp{table_,
+                                           Key({Int64(2)}),
+                                           {int64_col_, string_col_},
+                                           {Int64(2), String("b")}}),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+
+  store.Clear();
+  EXPECT_EQ(database_memory.bytes_used(), 0);
+}
+
+TEST_F(TransactionStoreTest, SpillsBufferedWritesPastThreshold) {
+  absl::Time t0 = absl::Now();
+  ZETASQL_EXPECT_OK(Write(t0, Key({Int64(5)}), {Int64(5), String("base-5")}));
+  ZETASQL_EXPECT_OK(Write(t0, Key({Int64(6)}), {Int64(6), String("base-6")}));
+
+  // Each insert holds 17 bytes, so every mutation spills the previous ones.
+  TransactionStore store(base_storage_.get(), lock_handle_.get(),
+                         /*database_memory_tracker=*/nullptr,
+                         /*spill_threshold_bytes=*/20);
+  ZETASQL_EXPECT_OK(store.BufferWriteOp(InsertOp{table_,
+                                         Key({Int64(1)}),
+                                         {int64_col_, string_col_},
+                                         {Int64(1), String("a")}}));
+  ZETASQL_EXPECT_OK(store.BufferWriteOp(InsertOp{table_,
+                                         Key({Int64(2)}),
+                                         {int64_col_, string_col_},
+                                         {Int64(2), String("b")}}));
+  ZETASQL_EXPECT_OK(store.BufferWriteOp(
+      UpdateOp{table_, Key({Int64(1)}), {string_col_}, {String("c")}}));
+  ZETASQL_EXPECT_OK(store.BufferWriteOp(DeleteOp{table_, Key({Int64(2)})}));
+  ZETASQL_EXPECT_OK(store.BufferWriteOp(
+      UpdateOp{table_, Key({Int64(5)}), {string_col_}, {String("new-5")}}));
+  ZETASQL_EXPECT_OK(store.BufferWriteOp(DeleteOp{table_, Key({Int64(6)})}));
+  ASSERT_NE(store.spill_file(), nullptr);
+  EXPECT_GT(store.spill_file()->num_runs(), 1);
+  EXPECT_LE(store.memory_tracker().bytes_used(), 20);
+
+  // Reads merge the spilled mutations with those in memory and base storage.
+  EXPECT_THAT(store.Lookup(table_, Key({Int64(1)}), {int64_col_, string_col_}),
+              IsOkAndHoldsRow({Int64(1), String("c")}));
+  EXPECT_THAT(store.Lookup(table_, Key({Int64(2)}), {int64_col_, string_col_}),
+              StatusIs(absl::StatusCode::kNotFound));
+  std::unique_ptr<StorageIterator> itr;
+  ZETASQL_ASSERT_OK(store.Read(table_, KeyRange::All(), {int64_col_, string_col_},
+                       &itr));
+  std::vector<ValueList> rows;
+  while (itr->Next()) {
+    rows.push_back({itr->ColumnValue(0), itr->ColumnValue(1)});
+  }
+  EXPECT_THAT(rows, ElementsAre(ValueList{Int64(1), String("c")},
+                                ValueList{Int64(5), String("new-5")}));
+
+  // Reads of a key range merge only the mutations in the range, in key order.
+  ZETASQL_EXPECT_OK(store.BufferWriteOp(InsertOp{table_,
+                                         Key({Int64(4)}),
+                                         {int64_col_, string_col_},
+                                         {Int64(4), String("d")}}));
+  ZETASQL_ASSERT_OK(store.Read(table_,
+                       KeyRange::ClosedOpen(Key({Int64(2)}), Key({Int64(6)})),
+                       {int64_col_, string_col_}, &itr));
+  rows.clear();
+  while (itr->Next()) {
+    rows.push_back({itr->ColumnValue(0), itr->ColumnValue(1)});
+  }
+  EXPECT_THAT(rows, ElementsAre(ValueList{Int64(4), String("d")},
+                                ValueList{Int64(5), String("new-5")}));
+  ZETASQL_EXPECT_OK(store.VerifySpilledOps());
+
+  // The latest mutation of each row is visited once, in key order.
+  std::vector<std::pair<std::string, Key>> ops;
+  ZETASQL_EXPECT_OK(store.ForEachBufferedOp([&](const WriteOp& op) {
+    std::visit(overloaded{
+                   [&](const InsertOp& op) {
+                     ops.emplace_back("insert", op.key);
+                   },
+                   [&](const UpdateOp& op) {
+                     ops.emplace_back("update", op.key);
+                   },
+                   [&](const DeleteOp& op) {
+                     ops.emplace_back("delete", op.key);
+                   },
+               },
+               op);
+    return absl::OkStatus();
+  }));
+  EXPECT_THAT(ops, ElementsAre(Pair("insert", Key({Int64(1)})),
+                               Pair("delete", Key({Int64(2)})),
+                               Pair("insert", Key({Int64(4)})),
+                               Pair("update", Key({Int64(5)})),
+                               Pair("delete", Key({Int64(6)}))));
+
+  store.Clear();
+  EXPECT_EQ(store.spill_file(), nullptr);
+}
+
 }  // namespace
 }  // namespace backend
 }  // namespace emulator
@@ -14,28 +14,69 @@
 // limitations under the License.
 //
 
+#include <pthread.h>
+#include <signal.h>
+
 #include <algorithm>
 #include <memory>
+#include <string>
+#include <thread>  // NOLINT
 
 #include "absl/flags/parse.h"
+#include "absl/status/status.h"
 #include "zetasql/base/logging.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/notification.h"
 #include "common/config.h"
 #include "frontend/server/server.h"
+#include "frontend/server/snapshot.h"
 
+namespace config = ::google::spanner::emulator::config;
+namespace frontend = ::google::spanner::emulator::frontend;
 using Server = ::google::spanner::emulator::frontend::Server;
 
 int main(int argc, char** argv) {
   // Start the emulator gRPC server.
   absl::ParseCommandLine(argc, argv);
+
+  // When saving a snapshot, SIGINT and SIGTERM shut the server down gracefully
+  // instead of terminating the process. They are blocked before any other
+  // thread starts so that only the thread below receives them.
+  const std::string save_snapshot_path = config::save_snapshot_path();
+  sigset_t shutdown_signals;
+  sigemptyset(&shutdown_signals);
+  sigaddset(&shutdown_signals, SIGINT);
+  sigaddset(&shutdown_signals, SIGTERM);
+  if (!save_snapshot_path.empty()) {
+    pthread_sigmask(SIG_BLOCK, &shutdown_signals, nullptr);
+  }
+
+  // The snapshot, if any, is restored before the server starts listening.
   Server::Options options;
-  options.server_address = google::spanner::emulator::config::grpc_host_port();
+  options.server_address = config::grpc_host_port();
+  options.load_snapshot_path = config::load_snapshot_path();
   std::unique_ptr<Server> server = Server::Create(options);
   if (!server) {
     LOG(ERROR) << "Failed to start gRPC server.";
     return EXIT_FAILURE;
   }
 
+  // The signal thread is joined before the server is destroyed. Signals which
+  // arrive after it exits stay blocked and pending.
+  absl::Notification server_stopped;
+  std::thread signal_thread;
+  if (!save_snapshot_path.empty()) {
+    signal_thread = std::thread([&server, &server_stopped, shutdown_signals]() {
+      int signal;
+      sigwait(&shutdown_signals, &signal);
+      if (server_stopped.HasBeenNotified()) {
+        return;
+      }
+      LOG(INFO) << "Received signal " << signal << ", shutting down.";
+      server->Shutdown();
+    });
+  }
+
   LOG(INFO) << "Cloud Spanner Emulator running.";
   LOG(INFO) << "Server address: "
             << absl::StrCat(server->host(), ":", server->port());
@@ -43,5 +84,22 @@ int main(int argc, char** argv) {
   // Block forever until the server is terminated.
   server->WaitForShutdown();
 
+  if (signal_thread.joinable()) {
+    // Wake the signal thread in case the server stopped without a signal.
+    server_stopped.Notify();
+    pthread_kill(signal_thread.native_handle(), SIGTERM);
+    signal_thread.join();
+  }
+
+  if (!save_snapshot_path.empty()) {
+    absl::Status status =
+        frontend::SaveSnapshot(server->env(), save_snapshot_path);
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to save snapshot: " << status;
+      return EXIT_FAILURE;
+    }
+    LOG(INFO) << "Saved snapshot to " << save_snapshot_path;
+  }
+
   return EXIT_SUCCESS;
 }
@@ -16,7 +16,11 @@
 
 #include "common/config.h"
 
+#include <algorithm>
+#include <thread>  // NOLINT(build/c++11)
+
 #include "absl/flags/flag.h"
+#include "absl/time/time.h"
 
 ABSL_FLAG(std::string, host_port, "localhost:10007",
           "Emulator host IP and port that serves Cloud Spanner gRPC requests.");
@@ -31,6 +35,93 @@ ABSL_FLAG(
     "error handling behavior. For instance, transaction Commits may be aborted "
     "to facilitate application abort-retry testing.");
 
+ABSL_FLAG(int64_t, max_database_memory_bytes, 0,
+          "Maximum number of bytes a single database may hold across its "
+          "storage, transaction buffers and query results. Requests which "
+          "would exceed it fail with RESOURCE_EXHAUSTED. Zero means "
+          "unlimited.");
+
+ABSL_FLAG(int64_t, max_transaction_memory_bytes, 0,
+          "Maximum number of bytes of mutations a single read-write "
+          "transaction may buffer before failing with RESOURCE_EXHAUSTED. "
+          "Zero means unlimited.");
+
+ABSL_FLAG(int64_t, transaction_spill_threshold_bytes, 0,
+          "Number of bytes of mutations a read-write transaction holds in "
+          "memory before spilling them to a file on local disk. Zero disables "
+          "spilling.");
+
+ABSL_FLAG(std::string, transaction_spill_directory, "",
+          "Directory in which read-write transactions spill their mutations. "
+          "Defaults to $TMPDIR, or /tmp if unset.");
+
+ABSL_FLAG(int64_t, max_query_memory_bytes, 0,
+          "Maximum number of bytes a single query may hold in evaluator "
+          "state (e.g. sorts and aggregations) and materialized results "
+          "before failing with RESOURCE_EXHAUSTED. Can be overridden per "
+          "query with the @{spanner_emulator.max_query_memory_bytes=<n>} "
+          "hint. Zero means unlimited.");
+
+ABSL_FLAG(int64_t, query_result_cache_bytes, 0,
+          "Maximum number of bytes of query results each database caches "
+          "for reuse by identical queries in read-only transactions reading "
+          "the same snapshot. Zero disables the cache.");
+
+ABSL_FLAG(int64_t, max_concurrent_requests_per_database, 0,
+          "Maximum number of data requests (reads, queries, DML, commits) "
+          "concurrently executing against a single database. Requests beyond "
+          "it are queued. Zero means unlimited.");
+
+ABSL_FLAG(int64_t, max_concurrent_requests_per_session, 0,
+          "Maximum number of data requests concurrently executing against a "
+          "single session. Requests beyond it are queued. Zero means "
+          "unlimited.");
+
+ABSL_FLAG(int64_t, max_queued_requests, 100,
+          "Maximum number of requests queued against a single database or "
+          "session. Requests arriving to a full queue fail with "
+          "RESOURCE_EXHAUSTED.");
+
+ABSL_FLAG(absl::Duration, max_request_queue_time, absl::Seconds(30),
+          "Maximum time a queued request waits to execute before failing with "
+          "UNAVAILABLE.");
+
+ABSL_FLAG(int64_t, change_log_capacity, 10000,
+          "Number of most recently committed row changes retained per "
+          "database for change feed consumers. Zero disables the change "
+          "log.");
+
+ABSL_FLAG(int, read_parallelism, 0,
+          "Number of threads, including the reading thread, used to "
+          "materialize the rows of a large storage read. Each database keeps "
+          "a pool of this many threads less one, shared by its concurrent "
+          "reads. Zero uses the number of available cores.");
+
+ABSL_FLAG(bool, enable_prefix_filters, true,
+          "If true, storage keeps a bloom filter over the key prefixes of each "
+          "table to answer reads of absent key prefixes (e.g. checks for "
+          "child rows) without searching the table. Disabling it can be used "
+          "to verify that results do not depend on the filters.");
+
+ABSL_FLAG(bool, interleave_storage_tables, false,
+          "If true, storage keeps the rows of interleaved tables in a single "
+          "ordered keyspace with the rows of their root table, with each "
+          "child row placed after its parent row, so that reads of a parent "
+          "and its children scan contiguous rows.");
+
+ABSL_FLAG(int64_t, max_rows_per_storage_split, 16384,
+          "Maximum number of rows in a key-range split of a storage table. "
+          "Splits which grow past it are divided at their middle row.");
+
+ABSL_FLAG(std::string, load_snapshot, "",
+          "If set, the emulator restores the instances, databases, schemas and "
+          "data in the given snapshot file at startup.");
+
+ABSL_FLAG(std::string, save_snapshot, "",
+          "If set, the emulator writes the instances, databases, schemas and "
+          "data it holds to the given snapshot file when it is shut down with "
+          "SIGINT or SIGTERM.");
+
 namespace google {
 namespace spanner {
 namespace emulator {
@@ -44,6 +135,74 @@ bool fault_injection_enabled() {
   return absl::GetFlag(FLAGS_enable_fault_injection);
 }
 
+int64_t max_database_memory_bytes() {
+  return absl::GetFlag(FLAGS_max_database_memory_bytes);
+}
+
+int64_t max_transaction_memory_bytes() {
+  return absl::GetFlag(FLAGS_max_transaction_memory_bytes);
+}
+
+int64_t transaction_spill_threshold_bytes() {
+  return absl::GetFlag(FLAGS_transaction_spill_threshold_bytes);
+}
+
+std::string transaction_spill_directory() {
+  return absl::GetFlag(FLAGS_transaction_spill_directory);
+}
+
+int64_t max_query_memory_bytes() {
+  return absl::GetFlag(FLAGS_max_query_memory_bytes);
+}
+
+int64_t query_result_cache_bytes() {
+  return absl::GetFlag(FLAGS_query_result_cache_bytes);
+}
+
+int64_t max_concurrent_requests_per_database() {
+  return absl::GetFlag(FLAGS_max_concurrent_requests_per_database);
+}
+
+int64_t max_concurrent_requests_per_session() {
+  return absl::GetFlag(FLAGS_max_concurrent_requests_per_session);
+}
+
+int64_t max_queued_requests() {
+  return absl::GetFlag(FLAGS_max_queued_requests);
+}
+
+absl::Duration max_request_queue_time() {
+  return absl::GetFlag(FLAGS_max_request_queue_time);
+}
+
+int64_t change_log_capacity() {
+  return absl::GetFlag(FLAGS_change_log_capacity);
+}
+
+int read_parallelism() {
+  const int parallelism = absl::GetFlag(FLAGS_read_parallelism);
+  if (parallelism > 0) {
+    return parallelism;
+  }
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool enable_prefix_filters() {
+  return absl::GetFlag(FLAGS_enable_prefix_filters);
+}
+
+bool interleave_storage_tables() {
+  return absl::GetFlag(FLAGS_interleave_storage_tables);
+}
+
+int64_t max_rows_per_storage_split() {
+  return absl::GetFlag(FLAGS_max_rows_per_storage_split);
+}
+
+std::string load_snapshot_path() { return absl::GetFlag(FLAGS_load_snapshot); }
+
+std::string save_snapshot_path() { return absl::GetFlag(FLAGS_save_snapshot); }
+
 }  // namespace config
 }  // namespace emulator
 }  // namespace spanner
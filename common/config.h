@@ -17,8 +17,11 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_COMMON_CONFIG_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_COMMON_CONFIG_H_
 
+#include <cstdint>
 #include <string>
 
+#include "absl/time/time.h"
+
 namespace google {
 namespace spanner {
 namespace emulator {
@@ -33,6 +36,68 @@ bool should_log_requests();
 // Returns true if fault injection is enabled.
 bool fault_injection_enabled();
 
+// Maximum number of bytes a database may hold across its storage, transaction
+// buffers and query results. Zero means unlimited.
+int64_t max_database_memory_bytes();
+
+// Maximum number of bytes a single read-write transaction may buffer. Zero
+// means unlimited.
+int64_t max_transaction_memory_bytes();
+
+// Number of bytes of mutations a single read-write transaction holds in memory
+// before spilling them to local disk. Zero disables spilling.
+int64_t transaction_spill_threshold_bytes();
+
+// Directory in which transactions spill their mutations. Empty for the
+// system's temporary directory.
+std::string transaction_spill_directory();
+
+// Maximum number of bytes a single query may hold, unless overridden by a
+// query hint. Zero means unlimited.
+int64_t max_query_memory_bytes();
+
+// Maximum number of bytes of query results cached by each database. Zero
+// disables the cache.
+int64_t query_result_cache_bytes();
+
+// Maximum number of requests concurrently executing against a single database.
+// Zero means unlimited.
+int64_t max_concurrent_requests_per_database();
+
+// Maximum number of requests concurrently executing against a single session.
+// Zero means unlimited.
+int64_t max_concurrent_requests_per_session();
+
+// Maximum number of requests waiting to execute against a single database or
+// session before new requests are rejected.
+int64_t max_queued_requests();
+
+// Maximum time a request waits to execute before it is rejected.
+absl::Duration max_request_queue_time();
+
+// Number of committed row changes retained per database for change feeds.
+int64_t change_log_capacity();
+
+// Number of threads, including the reading thread, used to materialize a
+// large storage read.
+int read_parallelism();
+
+// Returns true if storage keeps bloom filters over the key prefixes of tables.
+bool enable_prefix_filters();
+
+// Returns true if storage co-locates the rows of interleaved tables with those
+// of their parents.
+bool interleave_storage_tables();
+
+// Maximum number of rows in a key-range split of a storage table.
+int64_t max_rows_per_storage_split();
+
+// Path of the snapshot to restore at startup. Empty if none.
+std::string load_snapshot_path();
+
+// Path to write a snapshot to on shutdown. Empty if none.
+std::string save_snapshot_path();
+
 }  // namespace config
 }  // namespace emulator
 }  // namespace spanner
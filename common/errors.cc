@@ -1902,6 +1902,63 @@ absl::Status InvalidPartitionedQueryMode() {
       "with partitioned queries.");
 }
 
+absl::Status MemoryLimitExceeded(absl::string_view resource,
+                                 int64_t limit_bytes) {
+  return absl::Status(
+      absl::StatusCode::kResourceExhausted,
+      absl::Substitute("Memory limit of $0 bytes exceeded for $1.",
+                       limit_bytes, resource));
+}
+
+absl::Status TooManyConcurrentRequests(absl::string_view resource) {
+  return absl::Status(
+      absl::StatusCode::kResourceExhausted,
+      absl::StrCat("Too many concurrent requests for ", resource,
+                   ". Retry the request later."));
+}
+
+absl::Status RequestQueueTimeout(absl::string_view resource) {
+  return absl::Status(
+      absl::StatusCode::kUnavailable,
+      absl::StrCat("Timed out waiting for other requests on ", resource,
+                   " to complete. Retry the request later."));
+}
+
+absl::Status CannotReadSnapshot(absl::string_view path) {
+  return absl::Status(
+      absl::StatusCode::kInvalidArgument,
+      absl::StrCat("Failed to read a snapshot from ", path, "."));
+}
+
+absl::Status CannotWriteSnapshot(absl::string_view path) {
+  return absl::Status(absl::StatusCode::kInternal,
+                      absl::StrCat("Failed to write a snapshot to ", path, "."));
+}
+
+absl::Status InvalidSnapshot(absl::string_view database_uri,
+                             absl::string_view message) {
+  return absl::Status(
+      absl::StatusCode::kInvalidArgument,
+      absl::StrCat("Invalid snapshot for database ", database_uri, ": ",
+                   message));
+}
+
+absl::Status ChangeLogDisabled() {
+  return absl::Status(absl::StatusCode::kFailedPrecondition,
+                      "The change log is disabled. Start the emulator with "
+                      "--change_log_capacity greater than zero to tail "
+                      "changes.");
+}
+
+absl::Status ChangeLogTruncated(absl::Time start, absl::Time evicted_through) {
+  return absl::Status(
+      absl::StatusCode::kOutOfRange,
+      absl::StrCat("Changes committed at or after ", absl::FormatTime(start),
+                   " are no longer retained. The oldest retained changes "
+                   "were committed after ",
+                   absl::FormatTime(evicted_through), "."));
+}
+
 }  // namespace error
 }  // namespace emulator
 }  // namespace spanner
@@ -470,6 +470,22 @@ absl::Status ReadFromDifferentTransaction();
 absl::Status ReadFromDifferentParameters();
 absl::Status InvalidPartitionedQueryMode();
 
+// Resource limit errors.
+absl::Status MemoryLimitExceeded(absl::string_view resource,
+                                 int64_t limit_bytes);
+absl::Status TooManyConcurrentRequests(absl::string_view resource);
+absl::Status RequestQueueTimeout(absl::string_view resource);
+
+// Snapshot errors.
+absl::Status CannotReadSnapshot(absl::string_view path);
+absl::Status CannotWriteSnapshot(absl::string_view path);
+absl::Status InvalidSnapshot(absl::string_view database_uri,
+                             absl::string_view message);
+
+// Change feed errors.
+absl::Status ChangeLogDisabled();
+absl::Status ChangeLogTruncated(absl::Time start, absl::Time evicted_through);
+
 }  // namespace error
 }  // namespace emulator
 }  // namespace spanner
@@ -16,6 +16,7 @@
 
 #include "frontend/collections/database_manager.h"
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <string>
@@ -126,6 +127,32 @@ DatabaseManager::ListDatabases(const std::string& instance_uri) const {
   return GetDatabasesByInstance(database_map_, instance_uri);
 }
 
+zetasql_base::StatusOr<std::vector<std::shared_ptr<Database>>>
+DatabaseManager::ListDatabases(const std::string& instance_uri,
+                               const std::string& page_token,
+                               int32_t page_size,
+                               std::string* next_page_token) const {
+  absl::MutexLock lock(&mu_);
+  std::string database_uri_prefix = absl::StrCat(instance_uri, "/");
+  std::vector<std::shared_ptr<Database>> databases;
+  // Seek directly to the first database of the page instead of skipping over
+  // the databases of earlier pages. The page token is read before the next page
+  // token is reset, as callers may pass the same string for both.
+  auto itr =
+      database_map_.lower_bound(std::max(database_uri_prefix, page_token));
+  next_page_token->clear();
+  for (; itr != database_map_.end() &&
+         absl::StartsWith(itr->first, database_uri_prefix);
+       ++itr) {
+    if (databases.size() >= static_cast<size_t>(page_size)) {
+      *next_page_token = itr->first;
+      break;
+    }
+    databases.push_back(itr->second);
+  }
+  return databases;
+}
+
 }  // namespace frontend
 }  // namespace emulator
 }  // namespace spanner
@@ -17,6 +17,7 @@
 #ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_DATABASE_MANAGER_H_
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_DATABASE_MANAGER_H_
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -56,6 +57,16 @@ class DatabaseManager {
   zetasql_base::StatusOr<std::vector<std::shared_ptr<Database>>> ListDatabases(
       const std::string& instance_uri) const ABSL_LOCKS_EXCLUDED(mu_);
 
+  // Lists at most `page_size` databases associated with the given instance URI,
+  // starting at the first one whose URI is not less than `page_token`. Sets
+  // `next_page_token` to the URI of the first database after the page, or to
+  // the empty string if there is none. Only the databases on the page are
+  // visited.
+  zetasql_base::StatusOr<std::vector<std::shared_ptr<Database>>> ListDatabases(
+      const std::string& instance_uri, const std::string& page_token,
+      int32_t page_size, std::string* next_page_token) const
+      ABSL_LOCKS_EXCLUDED(mu_);
+
  private:
   // System-wide clock.
   Clock* clock_;
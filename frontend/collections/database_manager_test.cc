@@ -100,6 +100,37 @@ TEST_F(DatabaseManagerTest, ListDatabase) {
   }
 }
 
+TEST_F(DatabaseManagerTest, ListDatabaseByPage) {
+  std::string instance_uri = "projects/test-p/instances/test-i";
+  for (int i = 0; i < 5; i++) {
+    ZETASQL_ASSERT_OK(database_manager_.CreateDatabase(
+        absl::StrCat(instance_uri, "/databases/database-", i), empty_schema_));
+  }
+  ZETASQL_ASSERT_OK(database_manager_.CreateDatabase(
+      "projects/test-p/instances/test-j/databases/database-0", empty_schema_));
+
+  std::string next_page_token;
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::vector<std::shared_ptr<Database>> databases,
+                       database_manager_.ListDatabases(
+                           instance_uri, /*page_token=*/"", /*page_size=*/2,
+                           &next_page_token));
+  ASSERT_EQ(databases.size(), 2);
+  EXPECT_EQ(databases[0]->database_uri(),
+            absl::StrCat(instance_uri, "/databases/database-0"));
+  EXPECT_EQ(next_page_token,
+            absl::StrCat(instance_uri, "/databases/database-2"));
+
+  ZETASQL_ASSERT_OK_AND_ASSIGN(databases, database_manager_.ListDatabases(
+                                      instance_uri, next_page_token,
+                                      /*page_size=*/3, &next_page_token));
+  ASSERT_EQ(databases.size(), 3);
+  EXPECT_EQ(databases[0]->database_uri(),
+            absl::StrCat(instance_uri, "/databases/database-2"));
+  EXPECT_EQ(databases[2]->database_uri(),
+            absl::StrCat(instance_uri, "/databases/database-4"));
+  EXPECT_EQ(next_page_token, "");
+}
+
 TEST_F(DatabaseManagerTest, ListDatabaseWithSimilarInstanceUri) {
   std::string similar_database_uri = absl::StrCat(
       "projects/test-p/instances/test-instances/databases/database");
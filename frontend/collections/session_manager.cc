@@ -16,6 +16,7 @@
 
 #include "frontend/collections/session_manager.h"
 
+#include <algorithm>
 #include <map>
 #include <string>
 
@@ -82,6 +83,31 @@ SessionManager::ListSessions(const std::string& database_uri) const {
   return sessions;
 }
 
+zetasql_base::StatusOr<std::vector<std::shared_ptr<Session>>>
+SessionManager::ListSessions(const std::string& database_uri,
+                             const std::string& page_token, int32_t page_size,
+                             std::string* next_page_token) const {
+  absl::MutexLock lock(&mu_);
+  std::string session_uri_prefix = absl::StrCat(database_uri, "/");
+  std::vector<std::shared_ptr<Session>> sessions;
+  // Seek directly to the first session of the page instead of skipping over
+  // the sessions of earlier pages. The page token is read before the next page
+  // token is reset, as callers may pass the same string for both.
+  auto itr =
+      session_map_.lower_bound(std::max(session_uri_prefix, page_token));
+  next_page_token->clear();
+  for (; itr != session_map_.end() &&
+         absl::StartsWith(itr->first, session_uri_prefix);
+       ++itr) {
+    if (sessions.size() >= static_cast<size_t>(page_size)) {
+      *next_page_token = itr->first;
+      break;
+    }
+    sessions.push_back(itr->second);
+  }
+  return sessions;
+}
+
 absl::Status SessionManager::DeleteSession(const std::string& session_uri) {
   absl::MutexLock lock(&mu_);
   session_map_.erase(session_uri);
@@ -51,6 +51,15 @@ class SessionManager {
   zetasql_base::StatusOr<std::vector<std::shared_ptr<Session>>> ListSessions(
       const std::string& database_uri) const ABSL_LOCKS_EXCLUDED(mu_);
 
+  // Lists at most `page_size` sessions attached to the given database URI,
+  // starting at the first one whose URI is not less than `page_token`. Sets
+  // `next_page_token` to the URI of the first session after the page, or to the
+  // empty string if there is none. Only the sessions on the page are visited.
+  zetasql_base::StatusOr<std::vector<std::shared_ptr<Session>>> ListSessions(
+      const std::string& database_uri, const std::string& page_token,
+      int32_t page_size, std::string* next_page_token) const
+      ABSL_LOCKS_EXCLUDED(mu_);
+
  private:
   // System-wide clock.
   Clock* clock_;
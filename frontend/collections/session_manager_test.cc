@@ -136,6 +136,39 @@ TEST_F(SessionManagerTest, ListSessionsWithSimilarPrefix) {
   }
 }
 
+TEST_F(SessionManagerTest, ListSessionsByPage) {
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<Database> other_database,
+      database_manager_.CreateDatabase(
+          "projects/test-p/instances/test-i/databases/test-other", {}));
+  for (int i = 0; i < 5; i++) {
+    ZETASQL_ASSERT_OK(session_manager_.CreateSession(test_labels_, database_));
+    ZETASQL_ASSERT_OK(
+        session_manager_.CreateSession(test_labels_, other_database));
+  }
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::shared_ptr<Session>> all_sessions,
+      session_manager_.ListSessions(database_->database_uri()));
+
+  std::vector<std::string> listed_session_uris;
+  std::string page_token;
+  do {
+    ZETASQL_ASSERT_OK_AND_ASSIGN(
+        std::vector<std::shared_ptr<Session>> page,
+        session_manager_.ListSessions(database_->database_uri(), page_token,
+                                      /*page_size=*/2, &page_token));
+    EXPECT_LE(page.size(), 2);
+    for (const auto& session : page) {
+      listed_session_uris.push_back(session->session_uri());
+    }
+  } while (!page_token.empty());
+
+  ASSERT_EQ(listed_session_uris.size(), all_sessions.size());
+  for (int i = 0; i < all_sessions.size(); i++) {
+    EXPECT_EQ(listed_session_uris[i], all_sessions[i]->session_uri());
+  }
+}
+
 }  // namespace frontend
 }  // namespace emulator
 }  // namespace spanner
@@ -49,6 +49,11 @@ class Database {
   // Returns the handle to the backend database.
   backend::Database* backend() const { return backend_.get(); }
 
+  // Returns the controller bounding the requests executing on this database.
+  backend::AdmissionController* admission_controller() {
+    return backend_->admission_controller();
+  }
+
   // Converts this database object to its proto representation.
   absl::Status ToProto(admin::database::v1::Database* database);
 
@@ -90,6 +90,15 @@ absl::Status ValidateSingleUseTransactionOptions(
 
 }  // namespace
 
+zetasql_base::StatusOr<backend::AdmissionTicket> Session::AdmitRequest() {
+  // Wait on the session before the database, so that requests queued behind
+  // a busy session do not hold database capacity needed by other sessions.
+  backend::AdmissionTicket ticket;
+  ZETASQL_RETURN_IF_ERROR(ticket.Acquire(&admission_controller_));
+  ZETASQL_RETURN_IF_ERROR(ticket.Acquire(database_->admission_controller()));
+  return ticket;
+}
+
 absl::Status Session::ToProto(spanner_api::Session* session,
                               bool include_labels) {
   absl::ReaderMutexLock lock(&mu_);
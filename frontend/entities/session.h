@@ -26,7 +26,10 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
+#include "absl/strings/str_cat.h"
+#include "backend/common/admission_controller.h"
 #include "backend/common/ids.h"
+#include "common/config.h"
 #include "frontend/common/labels.h"
 #include "frontend/entities/database.h"
 #include "frontend/entities/transaction.h"
@@ -69,7 +72,12 @@ class Session {
       : session_uri_(session_uri),
         labels_(labels),
         create_time_(create_time),
-        database_(database) {}
+        database_(database),
+        admission_controller_(
+            absl::StrCat("session ", session_uri),
+            {.max_in_flight = config::max_concurrent_requests_per_session(),
+             .max_queued = config::max_queued_requests(),
+             .max_queue_time = config::max_request_queue_time()}) {}
 
   // Returns the URI for this session.
   const std::string& session_uri() const { return session_uri_; }
@@ -93,6 +101,17 @@ class Session {
     approximate_last_use_time_ = approximate_last_use_time;
   }
 
+  // Admits a data request (read, query, DML, commit) on this session and its
+  // database. The request may execute while the returned ticket is alive.
+  // Returns RESOURCE_EXHAUSTED or UNAVAILABLE if the request is rejected
+  // because too many requests are already executing or queued.
+  zetasql_base::StatusOr<backend::AdmissionTicket> AdmitRequest();
+
+  // Returns the controller bounding the requests executing on this session.
+  const backend::AdmissionController& admission_controller() const {
+    return admission_controller_;
+  }
+
   // Converts this session to its proto representation.
   absl::Status ToProto(google::spanner::v1::Session* session,
                        bool include_labels = true);
@@ -148,6 +167,9 @@ class Session {
   // The database to which this session is attached.
   std::shared_ptr<Database> database_;
 
+  // Bounds the number of requests concurrently executing on this session.
+  backend::AdmissionController admission_controller_;
+
   // Mutex to guard the state below.
   mutable absl::Mutex mu_;
 
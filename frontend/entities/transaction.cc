@@ -19,6 +19,7 @@
 #include <cstddef>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "google/spanner/v1/spanner.pb.h"
 #include "zetasql/public/value.h"
@@ -203,7 +204,10 @@ zetasql_base::StatusOr<backend::QueryResult> Transaction::ExecuteSql(
       return query_engine_->ExecuteSql(
           query,
           backend::QueryContext{
-              .schema = schema(), .reader = read_only(), .writer = nullptr});
+              .schema = schema(),
+              .reader = read_only(),
+              .writer = nullptr,
+              .snapshot_timestamp = read_only()->SnapshotTimestamp()});
     }
     case kReadWrite: {
       return query_engine_->ExecuteSql(
@@ -224,6 +228,25 @@ zetasql_base::StatusOr<backend::QueryResult> Transaction::ExecuteSql(
   }
 }
 
+absl::Status Transaction::ExecuteBatchDml(
+    const std::vector<backend::Query>& queries,
+    std::vector<backend::QueryResult>* results) {
+  mu_.AssertHeld();
+  if (type_ == kReadWrite) {
+    return query_engine_->ExecuteBatchDml(
+        queries,
+        backend::QueryContext{.schema = schema(),
+                              .reader = read_write(),
+                              .writer = read_write()},
+        results);
+  }
+  for (const backend::Query& query : queries) {
+    ZETASQL_ASSIGN_OR_RETURN(backend::QueryResult result, ExecuteSql(query));
+    results->push_back(std::move(result));
+  }
+  return absl::OkStatus();
+}
+
 absl::Status Transaction::Write(const backend::Mutation& mutation) {
   mu_.AssertHeld();
   if (type_ == kReadWrite) {
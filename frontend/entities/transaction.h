@@ -18,6 +18,7 @@
 #define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_ENTITIES_TRANSACTIONS_H_
 
 #include <memory>
+#include <vector>
 
 #include "google/protobuf/empty.pb.h"
 #include "google/spanner/v1/result_set.pb.h"
@@ -135,6 +136,11 @@ class Transaction {
   // Calls ExecuteSql using the backend transaction and query engine.
   zetasql_base::StatusOr<backend::QueryResult> ExecuteSql(const backend::Query& query);
 
+  // Calls ExecuteBatchDml using the backend transaction and query engine. The
+  // queries must share the same SQL text and parameter types.
+  absl::Status ExecuteBatchDml(const std::vector<backend::Query>& queries,
+                               std::vector<backend::QueryResult>* results);
+
   // Calls Write using the backend transaction.
   absl::Status Write(const backend::Mutation& mutation);
 
@@ -0,0 +1,128 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <memory>
+#include <vector>
+
+#include "google/protobuf/struct.pb.h"
+#include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "backend/transaction/change_log.h"
+#include "common/errors.h"
+#include "frontend/converters/time.h"
+#include "frontend/converters/values.h"
+#include "frontend/entities/database.h"
+#include "frontend/proto/change_feed.pb.h"
+#include "frontend/server/handler.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+namespace {
+
+// Maximum time to wait for new changes before checking whether the request was
+// cancelled.
+constexpr absl::Duration kChangeFeedPollInterval = absl::Seconds(1);
+
+// Number of changes after which a response is sent.
+constexpr int64_t kMaxChangesPerResponse = 1000;
+
+absl::Status ChangeToProto(const backend::ChangeRecord& change,
+                           DataChange* change_pb) {
+  ZETASQL_ASSIGN_OR_RETURN(*change_pb->mutable_commit_timestamp(),
+                   TimestampToProto(change.commit_timestamp));
+  change_pb->set_table(change.table);
+  switch (change.type) {
+    case backend::ChangeRecord::Type::kInsert:
+      change_pb->set_mod_type(DataChange::INSERT);
+      break;
+    case backend::ChangeRecord::Type::kUpdate:
+      change_pb->set_mod_type(DataChange::UPDATE);
+      break;
+    case backend::ChangeRecord::Type::kDelete:
+      change_pb->set_mod_type(DataChange::DELETE);
+      break;
+  }
+  for (int i = 0; i < change.key.NumColumns(); ++i) {
+    ZETASQL_ASSIGN_OR_RETURN(*change_pb->mutable_key()->add_values(),
+                     ValueToProto(change.key.ColumnValue(i)));
+  }
+  for (int i = 0; i < change.columns.size(); ++i) {
+    change_pb->add_columns(change.columns[i]);
+    ZETASQL_ASSIGN_OR_RETURN(*change_pb->mutable_values()->add_values(),
+                     ValueToProto(change.values[i]));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+// Streams the row changes committed to a database.
+absl::Status TailChanges(RequestContext* ctx,
+                         const TailChangesRequest* request,
+                         ServerStream<TailChangesResponse>* stream) {
+  ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Database> database,
+                   GetDatabase(ctx, request->database()));
+  backend::ChangeLog* change_log = database->backend()->change_log();
+  if (!change_log->enabled()) {
+    return error::ChangeLogDisabled();
+  }
+
+  absl::Time start = ctx->env()->clock()->Now();
+  if (request->has_start_timestamp()) {
+    ZETASQL_ASSIGN_OR_RETURN(start, TimestampFromProto(request->start_timestamp()));
+  }
+  absl::Time end = absl::InfiniteFuture();
+  if (request->has_end_timestamp()) {
+    ZETASQL_ASSIGN_OR_RETURN(end, TimestampFromProto(request->end_timestamp()));
+  }
+
+  while (!ctx->grpc()->IsCancelled()) {
+    // Changes committed after this point have a later commit timestamp.
+    absl::Time now = ctx->env()->clock()->Now();
+    ZETASQL_ASSIGN_OR_RETURN(std::vector<backend::ChangeRecord> changes,
+                     change_log->Read(start,
+                                      absl::Now() + kChangeFeedPollInterval,
+                                      kMaxChangesPerResponse));
+    TailChangesResponse response;
+    for (const backend::ChangeRecord& change : changes) {
+      if (change.commit_timestamp > end) {
+        break;
+      }
+      ZETASQL_RETURN_IF_ERROR(ChangeToProto(change, response.add_changes()));
+    }
+    if (response.changes_size() > 0) {
+      stream->Send(response);
+    }
+    if (!changes.empty()) {
+      start = changes.back().commit_timestamp + absl::Nanoseconds(1);
+    }
+    if (start > end || (changes.empty() && now > end)) {
+      break;
+    }
+  }
+  return absl::OkStatus();
+}
+REGISTER_GRPC_HANDLER(ChangeFeed, TailChanges);
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
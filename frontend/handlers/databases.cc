@@ -59,27 +59,23 @@ absl::Status ListDatabases(RequestContext* ctx,
                                      &instance_id, &database_id));
   }
 
-  ZETASQL_ASSIGN_OR_RETURN(
-      std::vector<std::shared_ptr<Database>> databases,
-      ctx->env()->database_manager()->ListDatabases(request->parent()));
-
   int32_t page_size = request->page_size();
   static const int32_t kMaxPageSize = 1000;
   if (page_size <= 0 || page_size > kMaxPageSize) {
     page_size = kMaxPageSize;
   }
 
-  // Databases returned from database manager are sorted by database_uri and
-  // thus we use database uri of first database in next page as next_page_token.
+  // Databases are listed in order of database_uri, so the database uri of the
+  // first database in the next page is used as next_page_token.
+  std::string next_page_token;
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<std::shared_ptr<Database>> databases,
+                   ctx->env()->database_manager()->ListDatabases(
+                       request->parent(), request->page_token(), page_size,
+                       &next_page_token));
   for (const auto& database : databases) {
-    if (response->databases_size() >= page_size) {
-      response->set_next_page_token(database->database_uri());
-      break;
-    }
-    if (database->database_uri() >= request->page_token()) {
-      ZETASQL_RETURN_IF_ERROR(database->ToProto(response->add_databases()));
-    }
+    ZETASQL_RETURN_IF_ERROR(database->ToProto(response->add_databases()));
   }
+  response->set_next_page_token(next_page_token);
   return absl::OkStatus();
 }
 REGISTER_GRPC_HANDLER(DatabaseAdmin, ListDatabases);
@@ -20,6 +20,7 @@
 #include "google/spanner/v1/transaction.pb.h"
 #include "google/spanner/v1/type.pb.h"
 #include "zetasql/base/statusor.h"
+#include "backend/common/admission_controller.h"
 #include "backend/query/query_engine.h"
 #include "common/config.h"
 #include "common/errors.h"
@@ -124,6 +125,10 @@ absl::Status PartitionRead(RequestContext* ctx,
   ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Session> session,
                    GetSession(ctx, request->session()));
 
+  // Admit the request against the session and database limits.
+  ZETASQL_ASSIGN_OR_RETURN(backend::AdmissionTicket admission,
+                   session->AdmitRequest());
+
   // Get underlying transaction.
   ZETASQL_RETURN_IF_ERROR(
       ValidateTransactionSelectorForPartitionRead(request->transaction()));
@@ -173,6 +178,10 @@ absl::Status PartitionQuery(RequestContext* ctx,
   ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Session> session,
                    GetSession(ctx, request->session()));
 
+  // Admit the request against the session and database limits.
+  ZETASQL_ASSIGN_OR_RETURN(backend::AdmissionTicket admission,
+                   session->AdmitRequest());
+
   // Get underlying transaction.
   ZETASQL_RETURN_IF_ERROR(
       ValidateTransactionSelectorForPartitionRead(request->transaction()));
@@ -16,6 +16,7 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "google/protobuf/struct.pb.h"
 #include "google/spanner/v1/result_set.pb.h"
@@ -26,6 +27,7 @@
 #include "absl/types/optional.h"
 #include "absl/types/variant.h"
 #include "backend/access/read.h"
+#include "backend/common/admission_controller.h"
 #include "backend/query/query_engine.h"
 #include "common/constants.h"
 #include "common/errors.h"
@@ -144,14 +146,56 @@ void AddQueryStatsFromQueryResult(const backend::QueryResult& result,
       absl::FormatDuration(result.elapsed_time));
 }
 
-zetasql_base::StatusOr<backend::QueryResult> ExecuteQuery(
-    const spanner_api::ExecuteBatchDmlRequest_Statement& statement,
-    std::shared_ptr<Transaction> txn) {
-  ZETASQL_ASSIGN_OR_RETURN(const backend::Query query,
-                   QueryFromProto(statement.sql(), statement.params(),
-                                  statement.param_types(),
-                                  txn->query_engine()->type_factory()));
-  return txn->ExecuteSql(query);
+// Returns true if the two batch DML statements have the same SQL text and
+// parameters of the same types, so that they can share one prepared statement.
+bool HaveSameShape(const spanner_api::ExecuteBatchDmlRequest_Statement& lhs,
+                   const spanner_api::ExecuteBatchDmlRequest_Statement& rhs) {
+  if (lhs.sql() != rhs.sql() ||
+      lhs.params().fields_size() != rhs.params().fields_size() ||
+      lhs.param_types_size() != rhs.param_types_size()) {
+    return false;
+  }
+  for (const auto& [name, value] : lhs.params().fields()) {
+    if (rhs.params().fields().count(name) == 0) {
+      return false;
+    }
+  }
+  for (const auto& [name, type] : lhs.param_types()) {
+    auto it = rhs.param_types().find(name);
+    if (it == rhs.param_types().end() ||
+        it->second.SerializeAsString() != type.SerializeAsString()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Executes the batch DML statements in [begin, end), which all have the same
+// shape, as a single prepared statement. The results of the statements that
+// succeeded are appended to 'results', and the error of the first statement
+// that failed is returned.
+absl::Status ExecuteQueries(const spanner_api::ExecuteBatchDmlRequest* request,
+                            int begin, int end,
+                            std::shared_ptr<Transaction> txn,
+                            std::vector<backend::QueryResult>* results) {
+  std::vector<backend::Query> queries;
+  queries.reserve(end - begin);
+  absl::Status conversion_status;
+  for (int index = begin; index < end; ++index) {
+    const auto& statement = request->statements(index);
+    auto maybe_query = QueryFromProto(statement.sql(), statement.params(),
+                                      statement.param_types(),
+                                      txn->query_engine()->type_factory());
+    if (!maybe_query.ok()) {
+      conversion_status = maybe_query.status();
+      break;
+    }
+    queries.push_back(std::move(maybe_query).ValueOrDie());
+  }
+  if (!queries.empty()) {
+    ZETASQL_RETURN_IF_ERROR(txn->ExecuteBatchDml(queries, results));
+  }
+  return conversion_status;
 }
 
 template <typename Request>
@@ -199,6 +243,10 @@ absl::Status ExecuteSql(RequestContext* ctx,
   ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Session> session,
                    GetSession(ctx, request->session()));
 
+  // Admit the request against the session and database limits.
+  ZETASQL_ASSIGN_OR_RETURN(backend::AdmissionTicket admission,
+                   session->AdmitRequest());
+
   // Get underlying transaction.
   bool is_dml_query = backend::IsDMLQuery(request->sql());
   ZETASQL_RETURN_IF_ERROR(ValidateTransactionSelectorForQuery(request->transaction(),
@@ -337,6 +385,10 @@ absl::Status ExecuteStreamingSql(
   ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Session> session,
                    GetSession(ctx, request->session()));
 
+  // Admit the request against the session and database limits.
+  ZETASQL_ASSIGN_OR_RETURN(backend::AdmissionTicket admission,
+                   session->AdmitRequest());
+
   // Get underlying transaction.
   bool is_dml_query = backend::IsDMLQuery(request->sql());
   ZETASQL_RETURN_IF_ERROR(ValidateTransactionSelectorForQuery(request->transaction(),
@@ -496,6 +548,10 @@ absl::Status ExecuteBatchDml(RequestContext* ctx,
   ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Session> session,
                    GetSession(ctx, request->session()));
 
+  // Admit the request against the session and database limits.
+  ZETASQL_ASSIGN_OR_RETURN(backend::AdmissionTicket admission,
+                   session->AdmitRequest());
+
   // Get underlying transaction.
   ZETASQL_RETURN_IF_ERROR(ValidateTransactionSelectorForQuery(request->transaction(),
                                                       /*is_dml=*/true));
@@ -545,7 +601,10 @@ absl::Status ExecuteBatchDml(RequestContext* ctx,
       return error::CannotReadOrQueryAfterCommitOrRollback();
     }
 
-    for (int index = 0; index < request->statements_size(); ++index) {
+    // Runs of consecutive statements with the same shape, as commonly sent by
+    // ORMs, are analyzed and prepared once and evaluated per statement.
+    int index = 0;
+    while (index < request->statements_size()) {
       const auto& statement = request->statements(index);
       if (!backend::IsDMLQuery(statement.sql())) {
         absl::Status error = error::ExecuteBatchDmlOnlySupportsDmlStatements(
@@ -555,31 +614,41 @@ absl::Status ExecuteBatchDml(RequestContext* ctx,
         return absl::OkStatus();
       }
 
-      const auto maybe_result = ExecuteQuery(statement, txn);
-      if (!maybe_result.ok() &&
-          maybe_result.status().code() != absl::StatusCode::kAborted) {
-        absl::Status error = maybe_result.status();
-        *response->mutable_status() = StatusToProto(error);
-        txn->SetDmlReplayOutcome(*response);
-        txn->MaybeInvalidate(error);
-        return absl::OkStatus();
-      } else if (maybe_result.status().code() == absl::StatusCode::kAborted) {
-        return maybe_result.status();
+      int end = index + 1;
+      while (end < request->statements_size() &&
+             HaveSameShape(statement, request->statements(end))) {
+        ++end;
       }
 
-      const auto& result = maybe_result.value();
-      spanner_api::ResultSet* result_set = response->add_result_sets();
-      result_set->mutable_stats()->set_row_count_exact(
-          result.modified_row_count);
+      std::vector<backend::QueryResult> results;
+      const absl::Status status =
+          ExecuteQueries(request, index, end, txn, &results);
+      if (status.code() == absl::StatusCode::kAborted) {
+        return status;
+      }
 
-      // Only populate metadata for first result set.
-      if (index == 0) {
-        result_set->mutable_metadata()->mutable_row_type();
-        if (ShouldReturnTransaction(request->transaction())) {
-          ZETASQL_ASSIGN_OR_RETURN(
-              *result_set->mutable_metadata()->mutable_transaction(),
-              txn->ToProto());
+      for (const backend::QueryResult& result : results) {
+        spanner_api::ResultSet* result_set = response->add_result_sets();
+        result_set->mutable_stats()->set_row_count_exact(
+            result.modified_row_count);
+
+        // Only populate metadata for first result set.
+        if (index == 0) {
+          result_set->mutable_metadata()->mutable_row_type();
+          if (ShouldReturnTransaction(request->transaction())) {
+            ZETASQL_ASSIGN_OR_RETURN(
+                *result_set->mutable_metadata()->mutable_transaction(),
+                txn->ToProto());
+          }
         }
+        ++index;
+      }
+
+      if (!status.ok()) {
+        *response->mutable_status() = StatusToProto(status);
+        txn->SetDmlReplayOutcome(*response);
+        txn->MaybeInvalidate(status);
+        return absl::OkStatus();
       }
     }
 
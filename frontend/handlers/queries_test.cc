@@ -158,6 +158,102 @@ TEST_F(QueryApiTest, ExecuteBatchDmlFailsOnInvalidDmlStatement) {
                             )")));
 }
 
+TEST_F(QueryApiTest, ExecuteBatchDmlWithRepeatedStatement) {
+  spanner_api::BeginTransactionRequest begin_request = PARSE_TEXT_PROTO(R"(
+    options { read_write {} }
+  )");
+  begin_request.set_session(test_session_uri_);
+
+  spanner_api::Transaction transaction_response;
+  ZETASQL_EXPECT_OK(BeginTransaction(begin_request, &transaction_response));
+
+  spanner_api::ExecuteBatchDmlRequest request = PARSE_TEXT_PROTO(
+      R"""(
+        statements {
+          sql: "insert into test_table(int64_col, string_col) "
+               "values (@key, @value)"
+          params {
+            fields {
+              key: "key"
+              value { string_value: "10" }
+            }
+            fields {
+              key: "value"
+              value { string_value: "row_10" }
+            }
+          }
+          param_types {
+            key: "key"
+            value { code: INT64 }
+          }
+          param_types {
+            key: "value"
+            value { code: STRING }
+          }
+        }
+        statements {
+          sql: "insert into test_table(int64_col, string_col) "
+               "values (@key, @value)"
+          params {
+            fields {
+              key: "key"
+              value { string_value: "11" }
+            }
+            fields {
+              key: "value"
+              value { string_value: "row_11" }
+            }
+          }
+          param_types {
+            key: "key"
+            value { code: INT64 }
+          }
+          param_types {
+            key: "value"
+            value { code: STRING }
+          }
+        }
+        statements {
+          sql: "insert into test_table(int64_col, string_col) "
+               "values (@key, @value)"
+          params {
+            fields {
+              key: "key"
+              value { string_value: "10" }
+            }
+            fields {
+              key: "value"
+              value { string_value: "row_10" }
+            }
+          }
+          param_types {
+            key: "key"
+            value { code: INT64 }
+          }
+          param_types {
+            key: "value"
+            value { code: STRING }
+          }
+        }
+      )""");
+  request.set_session(test_session_uri_);
+  request.mutable_transaction()->set_id(transaction_response.id());
+
+  // The third statement fails on the row inserted by the first one, and only
+  // the first two statements report row counts.
+  spanner_api::ExecuteBatchDmlResponse response;
+  ZETASQL_ASSERT_OK(ExecuteBatchDml(request, &response));
+  EXPECT_THAT(response, Partially(EqualsProto(
+                            R"(
+                              result_sets {
+                                metadata { row_type {} }
+                                stats { row_count_exact: 1 }
+                              }
+                              result_sets { stats { row_count_exact: 1 } }
+                              status { code: 6 }
+                            )")));
+}
+
 TEST_F(QueryApiTest, ExecuteSql) {
   spanner_api::ExecuteSqlRequest request = PARSE_TEXT_PROTO(
       R"(
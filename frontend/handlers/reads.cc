@@ -21,6 +21,7 @@
 #include "google/spanner/v1/result_set.pb.h"
 #include "google/spanner/v1/spanner.pb.h"
 #include "google/spanner/v1/transaction.pb.h"
+#include "backend/common/admission_controller.h"
 #include "backend/common/ids.h"
 #include "common/errors.h"
 #include "frontend/common/protos.h"
@@ -68,6 +69,10 @@ absl::Status Read(RequestContext* ctx, const spanner_api::ReadRequest* request,
   ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Session> session,
                    GetSession(ctx, request->session()));
 
+  // Admit the request against the session and database limits.
+  ZETASQL_ASSIGN_OR_RETURN(backend::AdmissionTicket admission,
+                   session->AdmitRequest());
+
   // Get underlying transaction.
   ZETASQL_RETURN_IF_ERROR(ValidateTransactionSelectorForRead(request->transaction()));
   ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Transaction> txn,
@@ -120,6 +125,10 @@ absl::Status StreamingRead(
   ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Session> session,
                    GetSession(ctx, request->session()));
 
+  // Admit the request against the session and database limits.
+  ZETASQL_ASSIGN_OR_RETURN(backend::AdmissionTicket admission,
+                   session->AdmitRequest());
+
   // Get underlying transaction.
   ZETASQL_RETURN_IF_ERROR(ValidateTransactionSelectorForRead(request->transaction()));
   ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Transaction> txn,
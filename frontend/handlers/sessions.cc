@@ -143,29 +143,24 @@ absl::Status ListSessions(RequestContext* ctx,
       std::shared_ptr<Database> database,
       ctx->env()->database_manager()->GetDatabase(request->database()));
 
-  // List all sessions for the given database.
-  ZETASQL_ASSIGN_OR_RETURN(
-      std::vector<std::shared_ptr<Session>> sessions,
-      ctx->env()->session_manager()->ListSessions(database->database_uri()));
-
   int32_t page_size = request->page_size();
   static const int32_t kMaxPageSize = 1000;
   if (page_size <= 0 || page_size > kMaxPageSize) {
     page_size = kMaxPageSize;
   }
 
-  // Sessions returned from session manager are sorted by session_uri and
-  // thus we use first session uri after requested page size as next_page_token.
+  // Sessions are listed in order of session_uri, so the first session uri after
+  // the requested page is used as next_page_token.
+  std::string next_page_token;
+  ZETASQL_ASSIGN_OR_RETURN(std::vector<std::shared_ptr<Session>> sessions,
+                   ctx->env()->session_manager()->ListSessions(
+                       database->database_uri(), request->page_token(),
+                       page_size, &next_page_token));
   for (const auto& session : sessions) {
-    if (response->sessions_size() >= page_size) {
-      response->set_next_page_token(session->session_uri());
-      break;
-    }
-    if (session->session_uri() >= request->page_token()) {
-      ZETASQL_RETURN_IF_ERROR(session->ToProto(response->add_sessions(),
-                                       /*include_labels=*/true));
-    }
+    ZETASQL_RETURN_IF_ERROR(
+        session->ToProto(response->add_sessions(), /*include_labels=*/true));
   }
+  response->set_next_page_token(next_page_token);
   return absl::OkStatus();
 }
 REGISTER_GRPC_HANDLER(Spanner, ListSessions);
@@ -19,6 +19,7 @@
 #include "google/spanner/v1/spanner.pb.h"
 #include "google/spanner/v1/transaction.pb.h"
 #include "zetasql/base/statusor.h"
+#include "backend/common/admission_controller.h"
 #include "backend/transaction/options.h"
 #include "backend/transaction/read_only_transaction.h"
 #include "backend/transaction/read_write_transaction.h"
@@ -49,6 +50,10 @@ absl::Status BeginTransaction(
   ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Session> session,
                    session_manager->GetSession(request->session()));
 
+  // Admit the request against the session and database limits.
+  ZETASQL_ASSIGN_OR_RETURN(backend::AdmissionTicket admission,
+                   session->AdmitRequest());
+
   // Create a new transaction.
   ZETASQL_ASSIGN_OR_RETURN(
       std::shared_ptr<Transaction> txn,
@@ -70,6 +75,10 @@ absl::Status Commit(RequestContext* ctx,
   ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Session> session,
                    GetSession(ctx, request->session()));
 
+  // Admit the request against the session and database limits.
+  ZETASQL_ASSIGN_OR_RETURN(backend::AdmissionTicket admission,
+                   session->AdmitRequest());
+
   // Get transaction object to commit.
   zetasql_base::StatusOr<std::shared_ptr<Transaction>> maybe_txn;
   switch (request->transaction_case()) {
@@ -36,8 +36,10 @@
 #include "common/errors.h"
 #include "common/limits.h"
 #include "frontend/common/status.h"
+#include "frontend/proto/change_feed.grpc.pb.h"
 #include "frontend/server/handler.h"
 #include "frontend/server/request_context.h"
+#include "frontend/server/snapshot.h"
 
 namespace google {
 namespace spanner {
@@ -278,8 +280,21 @@ class OperationsService : public operations_api::Operations::Service {
   ServerEnv* const env_;
 };
 
+// Implementation of the emulator-only ChangeFeed gRPC service.
+class ChangeFeedService : public ChangeFeed::Service {
+ public:
+  explicit ChangeFeedService(ServerEnv* env) : env_(env) {}
+
+  DEFINE_GRPC_METHOD(ChangeFeed, TailChanges, TailChangesRequest,
+                     grpc::ServerWriter<TailChangesResponse>);
+
+ private:
+  ServerEnv* const env_;
+};
+
 Server::Server(std::unique_ptr<ServerEnv> env)
     : env_(std::move(env)),
+      change_feed_service_(new ChangeFeedService(env_.get())),
       database_admin_service_(new DatabaseAdminService(env_.get())),
       instance_admin_service_(new InstanceAdminService(env_.get())),
       operations_service_(new OperationsService(env_.get())),
@@ -289,6 +304,18 @@ Server::Server(std::unique_ptr<ServerEnv> env)
 std::unique_ptr<Server> Server::Create(const Server::Options& options) {
   auto env = absl::make_unique<ServerEnv>();
   std::unique_ptr<Server> server = absl::WrapUnique(new Server(std::move(env)));
+
+  // Restore the snapshot before any request can observe a partial restore.
+  if (!options.load_snapshot_path.empty()) {
+    absl::Status status =
+        LoadSnapshot(options.load_snapshot_path, server->env());
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to load snapshot: " << status;
+      return nullptr;
+    }
+    LOG(INFO) << "Loaded snapshot from " << options.load_snapshot_path;
+  }
+
   ::grpc::ServerBuilder builder;
 
   // Configure server address.
@@ -307,7 +334,8 @@ std::unique_ptr<Server> Server::Create(const Server::Options& options) {
   builder.RegisterService(server->spanner_service_.get())
       .RegisterService(server->database_admin_service_.get())
       .RegisterService(server->instance_admin_service_.get())
-      .RegisterService(server->operations_service_.get());
+      .RegisterService(server->operations_service_.get())
+      .RegisterService(server->change_feed_service_.get());
 
   // Actually start the server.
   server->grpc_server_ = builder.BuildAndStart();
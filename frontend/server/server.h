@@ -54,6 +54,10 @@ class Server {
  public:
   struct Options {
     std::string server_address;
+
+    // If set, the snapshot file at this path is restored into the server's
+    // environment before the server starts accepting requests.
+    std::string load_snapshot_path;
   };
 
   // Returns an initialized Server, or nullptr if the initialization failed.
@@ -83,6 +87,7 @@ class Server {
   std::unique_ptr<ServerEnv> env_;
 
   // Services implemented by this gRPC server.
+  std::unique_ptr<grpc::Service> change_feed_service_;
   std::unique_ptr<grpc::Service> database_admin_service_;
   std::unique_ptr<grpc::Service> instance_admin_service_;
   std::unique_ptr<grpc::Service> operations_service_;
@@ -0,0 +1,214 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "frontend/server/snapshot.h"
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "google/protobuf/struct.pb.h"
+#include "zetasql/public/value.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "backend/database/database.h"
+#include "backend/datamodel/value.h"
+#include "backend/schema/catalog/column.h"
+#include "backend/schema/catalog/index.h"
+#include "backend/schema/catalog/schema.h"
+#include "backend/schema/catalog/table.h"
+#include "backend/storage/iterator.h"
+#include "common/errors.h"
+#include "frontend/converters/values.h"
+#include "frontend/entities/database.h"
+#include "frontend/entities/instance.h"
+#include "frontend/proto/snapshot.pb.h"
+#include "zetasql/base/status_macros.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+namespace {
+
+absl::Status ExportDatabase(const Database& database,
+                            Snapshot::Database* database_pb) {
+  backend::Database* backend = database.backend();
+  database_pb->set_database_uri(database.database_uri());
+  for (const std::string& statement : backend->GetSchema()) {
+    database_pb->add_ddl_statements(statement);
+  }
+  return backend->ExportTables(
+      [&](const backend::Table* table,
+          backend::StorageIterator* itr) -> absl::Status {
+        Snapshot::Table* table_pb = database_pb->add_tables();
+        if (table->owner_index() != nullptr) {
+          table_pb->set_name(table->owner_index()->Name());
+          table_pb->set_is_index(true);
+        } else {
+          table_pb->set_name(table->Name());
+        }
+        for (const backend::Column* column : table->columns()) {
+          table_pb->add_columns(column->Name());
+        }
+        while (itr->Next()) {
+          google::protobuf::ListValue* row_pb = table_pb->add_rows();
+          for (int i = 0; i < itr->NumColumns(); ++i) {
+            zetasql::Value value = itr->ColumnValue(i);
+            // Columns which were never written read back as invalid values.
+            if (!value.is_valid()) {
+              value = zetasql::Value::Null(table->columns()[i]->GetType());
+            }
+            ZETASQL_ASSIGN_OR_RETURN(*row_pb->add_values(), ValueToProto(value));
+          }
+        }
+        return itr->Status();
+      });
+}
+
+zetasql_base::StatusOr<const backend::Table*> FindSnapshotTable(
+    const backend::Schema* schema, const std::string& database_uri,
+    const Snapshot::Table& table_pb) {
+  if (table_pb.is_index()) {
+    const backend::Index* index = schema->FindIndex(table_pb.name());
+    if (index != nullptr) {
+      return index->index_data_table();
+    }
+  } else {
+    const backend::Table* table = schema->FindTable(table_pb.name());
+    if (table != nullptr) {
+      return table;
+    }
+  }
+  return error::InvalidSnapshot(
+      database_uri,
+      absl::StrCat(table_pb.is_index() ? "unknown index " : "unknown table ",
+                   table_pb.name()));
+}
+
+absl::Status ImportDatabase(const Snapshot::Database& database_pb,
+                            backend::Database* backend) {
+  const std::string& database_uri = database_pb.database_uri();
+  const backend::Schema* schema = backend->GetLatestSchema();
+  std::vector<std::pair<const backend::Table*, std::vector<backend::ValueList>>>
+      tables;
+  tables.reserve(database_pb.tables_size());
+  for (const Snapshot::Table& table_pb : database_pb.tables()) {
+    ZETASQL_ASSIGN_OR_RETURN(const backend::Table* table,
+                     FindSnapshotTable(schema, database_uri, table_pb));
+
+    // Columns are matched by name, since column ids are assigned afresh when
+    // the schema is recreated.
+    const auto& columns = table->columns();
+    std::vector<int> positions(columns.size(), -1);
+    for (int i = 0; i < table_pb.columns_size(); ++i) {
+      const backend::Column* column = table->FindColumn(table_pb.columns(i));
+      if (column == nullptr) {
+        return error::InvalidSnapshot(
+            database_uri, absl::StrCat("unknown column ", table_pb.columns(i),
+                                       " in table ", table_pb.name()));
+      }
+      for (int j = 0; j < columns.size(); ++j) {
+        if (columns[j] == column) positions[j] = i;
+      }
+    }
+
+    std::vector<backend::ValueList> rows;
+    rows.reserve(table_pb.rows_size());
+    for (const google::protobuf::ListValue& row_pb : table_pb.rows()) {
+      if (row_pb.values_size() != table_pb.columns_size()) {
+        return error::InvalidSnapshot(
+            database_uri,
+            absl::StrCat("row of table ", table_pb.name(), " has ",
+                         row_pb.values_size(), " values, expected ",
+                         table_pb.columns_size()));
+      }
+      backend::ValueList row;
+      row.reserve(columns.size());
+      for (int j = 0; j < columns.size(); ++j) {
+        const zetasql::Type* type = columns[j]->GetType();
+        if (positions[j] < 0) {
+          row.push_back(zetasql::Value::Null(type));
+          continue;
+        }
+        ZETASQL_ASSIGN_OR_RETURN(zetasql::Value value,
+                         ValueFromProto(row_pb.values(positions[j]), type));
+        row.push_back(std::move(value));
+      }
+      rows.push_back(std::move(row));
+    }
+    tables.emplace_back(table, std::move(rows));
+  }
+  return backend->ImportTables(std::move(tables));
+}
+
+}  // namespace
+
+absl::Status SaveSnapshot(ServerEnv* env, const std::string& path) {
+  Snapshot snapshot;
+  for (const std::shared_ptr<Instance>& instance :
+       env->instance_manager()->ListAllInstances()) {
+    instance->ToProto(snapshot.add_instances());
+    ZETASQL_ASSIGN_OR_RETURN(
+        std::vector<std::shared_ptr<Database>> databases,
+        env->database_manager()->ListDatabases(instance->instance_uri()));
+    for (const std::shared_ptr<Database>& database : databases) {
+      ZETASQL_RETURN_IF_ERROR(ExportDatabase(*database, snapshot.add_databases()));
+    }
+  }
+
+  std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!out || !snapshot.SerializeToOstream(&out)) {
+    return error::CannotWriteSnapshot(path);
+  }
+  out.close();
+  if (!out) {
+    return error::CannotWriteSnapshot(path);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status LoadSnapshot(const std::string& path, ServerEnv* env) {
+  Snapshot snapshot;
+  std::ifstream in(path, std::ios::in | std::ios::binary);
+  if (!in || !snapshot.ParseFromIstream(&in)) {
+    return error::CannotReadSnapshot(path);
+  }
+
+  for (const admin::instance::v1::Instance& instance_pb :
+       snapshot.instances()) {
+    ZETASQL_RETURN_IF_ERROR(env->instance_manager()
+                        ->CreateInstance(instance_pb.name(), instance_pb)
+                        .status());
+  }
+  for (const Snapshot::Database& database_pb : snapshot.databases()) {
+    std::vector<std::string> statements(database_pb.ddl_statements().begin(),
+                                        database_pb.ddl_statements().end());
+    ZETASQL_ASSIGN_OR_RETURN(std::shared_ptr<Database> database,
+                     env->database_manager()->CreateDatabase(
+                         database_pb.database_uri(), statements));
+    ZETASQL_RETURN_IF_ERROR(ImportDatabase(database_pb, database->backend()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
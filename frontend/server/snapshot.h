@@ -0,0 +1,46 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_SNAPSHOT_H_
+#define THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_SNAPSHOT_H_
+
+#include <string>
+
+#include "frontend/server/environment.h"
+#include "absl/status/status.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+
+// Writes the instances, databases, latest schemas and data held by `env` to a
+// snapshot file at `path`. Data is read at a single strong timestamp per
+// database.
+absl::Status SaveSnapshot(ServerEnv* env, const std::string& path);
+
+// Restores the snapshot file at `path` into `env`, which is expected to hold
+// none of the snapshot's instances or databases. Databases are recreated from
+// their schema and their tables are bulk loaded rather than replayed as
+// mutations.
+absl::Status LoadSnapshot(const std::string& path, ServerEnv* env);
+
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google
+
+#endif  // THIRD_PARTY_CLOUD_SPANNER_EMULATOR_FRONTEND_SERVER_SNAPSHOT_H_
@@ -0,0 +1,129 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "frontend/server/snapshot.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "google/spanner/admin/instance/v1/spanner_instance_admin.pb.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "zetasql/base/testing/status_matchers.h"
+#include "absl/status/status.h"
+#include "backend/access/read.h"
+#include "backend/access/write.h"
+#include "backend/datamodel/key_set.h"
+#include "backend/transaction/options.h"
+#include "backend/transaction/read_only_transaction.h"
+#include "backend/transaction/read_write_transaction.h"
+#include "frontend/entities/database.h"
+#include "frontend/entities/instance.h"
+#include "frontend/server/environment.h"
+
+namespace google {
+namespace spanner {
+namespace emulator {
+namespace frontend {
+namespace {
+
+using zetasql::values::Int64;
+using zetasql::values::NullString;
+using zetasql::values::String;
+using zetasql_base::testing::StatusIs;
+
+constexpr char kInstanceUri[] = "projects/test-project/instances/test-instance";
+constexpr char kDatabaseUri[] =
+    "projects/test-project/instances/test-instance/databases/test-database";
+
+std::string SnapshotPath() {
+  return ::testing::TempDir() + "/snapshot.pb";
+}
+
+TEST(SnapshotTest, RestoresInstancesSchemasAndData) {
+  ServerEnv source;
+  admin::instance::v1::Instance instance_pb;
+  instance_pb.set_config("projects/test-project/instanceConfigs/emulator");
+  instance_pb.set_display_name("Test Instance");
+  instance_pb.set_node_count(1);
+  ZETASQL_ASSERT_OK(
+      source.instance_manager()->CreateInstance(kInstanceUri, instance_pb));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Database> database,
+                       source.database_manager()->CreateDatabase(
+                           kDatabaseUri, {R"(
+                             CREATE TABLE T(
+                               k INT64,
+                               v STRING(MAX),
+                             ) PRIMARY KEY(k))",
+                                          "CREATE INDEX I ON T(v)"}));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<backend::ReadWriteTransaction> txn,
+      database->backend()->CreateReadWriteTransaction(
+          backend::ReadWriteOptions(), backend::RetryState()));
+  backend::Mutation m;
+  m.AddWriteOp(backend::MutationOpType::kInsert, "T", {"k", "v"},
+               {{Int64(1), String("b")}, {Int64(2), String("a")}});
+  m.AddWriteOp(backend::MutationOpType::kInsert, "T", {"k"}, {{Int64(3)}});
+  ZETASQL_ASSERT_OK(txn->Write(m));
+  ZETASQL_ASSERT_OK(txn->Commit());
+  ZETASQL_ASSERT_OK(SaveSnapshot(&source, SnapshotPath()));
+
+  ServerEnv target;
+  ZETASQL_ASSERT_OK(LoadSnapshot(SnapshotPath(), &target));
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Instance> instance,
+                       target.instance_manager()->GetInstance(kInstanceUri));
+  admin::instance::v1::Instance restored_instance_pb;
+  instance->ToProto(&restored_instance_pb);
+  EXPECT_EQ(restored_instance_pb.display_name(), "Test Instance");
+  ZETASQL_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Database> restored,
+                       target.database_manager()->GetDatabase(kDatabaseUri));
+  EXPECT_EQ(restored->backend()->GetSchema(),
+            database->backend()->GetSchema());
+
+  // Read the restored rows through the index.
+  ZETASQL_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<backend::ReadOnlyTransaction> read_txn,
+      restored->backend()->CreateReadOnlyTransaction(
+          backend::ReadOnlyOptions()));
+  backend::ReadArg read_arg;
+  read_arg.table = "T";
+  read_arg.index = "I";
+  read_arg.key_set = backend::KeySet::All();
+  read_arg.columns = {"k", "v"};
+  std::unique_ptr<backend::RowCursor> cursor;
+  ZETASQL_ASSERT_OK(read_txn->Read(read_arg, &cursor));
+  ASSERT_TRUE(cursor->Next());
+  EXPECT_EQ(cursor->ColumnValue(0), Int64(3));
+  EXPECT_EQ(cursor->ColumnValue(1), NullString());
+  ASSERT_TRUE(cursor->Next());
+  EXPECT_EQ(cursor->ColumnValue(0), Int64(2));
+  ASSERT_TRUE(cursor->Next());
+  EXPECT_EQ(cursor->ColumnValue(0), Int64(1));
+  EXPECT_FALSE(cursor->Next());
+}
+
+TEST(SnapshotTest, MissingSnapshotFails) {
+  ServerEnv env;
+  EXPECT_THAT(LoadSnapshot(SnapshotPath() + ".missing", &env),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace frontend
+}  // namespace emulator
+}  // namespace spanner
+}  // namespace google